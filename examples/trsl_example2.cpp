@@ -8,6 +8,7 @@
 
 #include <trsl/sort_iterator.hpp>
 #include <trsl/is_picked_systematic.hpp>
+#include <trsl/population_weight.hpp>
 #include <trsl/random_permutation_iterator.hpp>
 #include <trsl/ppfilter_iterator.hpp>
 
@@ -16,7 +17,6 @@
 #include <boost/random/mersenne_twister.hpp>
 #include <vector>
 #include <iostream>
-#include <numeric> // accumulate
 
 // In this example, population elements are floats, and an element's
 // weight is the element itself. The weight accessor is:
@@ -89,11 +89,11 @@ int main()
     typedef trsl::persistent_filter_iterator
       <is_picked, population_iterator> sample_iterator;
   
-    is_picked predicate(SAMPLE_SIZE,
-                        std::accumulate(populationIteratorBegin,
-                                        populationIteratorEnd,
-                                        float(0)),
-                        wac());
+    // The population weight is computed by the factory.
+    is_picked predicate =
+      trsl::make_is_picked_systematic(populationIteratorBegin,
+                                      populationIteratorEnd,
+                                      SAMPLE_SIZE, wac());
   
     sample_iterator sampleIteratorBegin(predicate,
                                         populationIteratorBegin,
@@ -123,11 +123,11 @@ int main()
     typedef trsl::ppfilter_iterator
     <is_picked, population_iterator> sample_iterator;
     
-    is_picked predicate(SAMPLE_SIZE,
-                        std::accumulate(populationIteratorBegin,
-                                        populationIteratorEnd,
-                                        float(0)),
-                        wac());
+    // The population weight is computed by the factory.
+    is_picked predicate =
+      trsl::make_is_picked_systematic(populationIteratorBegin,
+                                      populationIteratorEnd,
+                                      SAMPLE_SIZE, wac());
     
     sample_iterator sampleIteratorBegin(predicate,
                                         populationIteratorBegin,
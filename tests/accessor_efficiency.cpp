@@ -3,6 +3,7 @@
 // accompanying file LICENSE_1_0.txt or copy at
 // http://www.boost.org/LICENSE_1_0.txt)
 
+#include <trsl/systematic_sample.hpp>
 #include <tests/common.hpp>
 using namespace trsl::test;
 #include <string>
@@ -54,6 +55,43 @@ void trsl_loop(WeightAccessor acc,
   }
 }
 
+template<typename WeightAccessor>
+void batch_loop(WeightAccessor acc,
+                const std::string msg)
+{
+  //-----------------------//
+  // Generate a population //
+  //-----------------------//
+    
+  std::vector<PickCountParticle> population;
+  generatePopulation(POPULATION_SIZE, population);
+  std::vector<PickCountParticle> const& const_pop = population;
+    
+  //------------------------------//
+  // Benchmark it --------------- //
+  //------------------------------//
+  {
+    // Same sampling parameters as trsl_loop, the random number is
+    // drawn once like in trsl_loop.
+    double uniform01 = trsl::rand_gen::uniform_01<double>();
+    std::vector<size_t> indices(2*SAMPLE_SIZE);
+
+    size_t sum = 0;
+    clock_t clock_start = clock();
+    for (size_t count = 0; count < NB_ROUNDS; count++)
+    {
+      std::vector<size_t>::iterator end =
+        trsl::systematic_sample(const_pop.begin(), const_pop.end(),
+                                SAMPLE_SIZE, 1.0, uniform01,
+                                acc, indices.begin());
+      sum += end - indices.begin();
+    }
+    std::cout << "Bench for " << msg << ": " << clock() - clock_start << std::endl;
+    // avoid nop-ing the loop:
+    assert(sum > 0);
+  }
+}
+
 template<typename WeightAccessor>
 void stl_loop(WeightAccessor acc,
               const std::string msg)
@@ -124,6 +162,111 @@ void drop_in_call()
   TRSL_TEST_DROP_BODY(wac_pointer_to_unary_function ptr = std::ptr_fun(wac_function_no_inline),
                       sum += ptr(*i), "wac_pointer_to_unary_function_no_inline");
 }
+// Element with a public weight, for member_weight_accessor.
+struct PublicWeightParticle
+{
+  double weight;
+  double x;
+  double y;
+};
+
+struct public_weight_functor
+{
+  double operator()(const PublicWeightParticle& p) const
+    {
+      return p.weight;
+    }
+};
+
+void copyPopulation(std::vector<PickCountParticle> const& particles,
+                    std::vector<PublicWeightParticle>& population)
+{
+  population.resize(particles.size());
+  for (size_t i = 0; i < particles.size(); ++i)
+  {
+    population[i].weight = particles[i].getWeight();
+    population[i].x = particles[i].getX();
+    population[i].y = particles[i].getY();
+  }
+}
+
+template<typename WeightAccessor>
+void member_loop(WeightAccessor acc,
+                 const std::string msg)
+{
+  typedef trsl::is_picked_systematic<
+    PublicWeightParticle,
+    double,
+    WeightAccessor
+    > is_picked;
+
+  typedef trsl::persistent_filter_iterator
+    <is_picked, std::vector<PublicWeightParticle>::const_iterator> sample_iterator;
+
+  //-----------------------//
+  // Generate a population //
+  //-----------------------//
+
+  std::vector<PickCountParticle> particles;
+  generatePopulation(POPULATION_SIZE, particles);
+  std::vector<PublicWeightParticle> population;
+  copyPopulation(particles, population);
+  std::vector<PublicWeightParticle> const& const_pop = population;
+
+  //------------------------------//
+  // Benchmark it --------------- //
+  //------------------------------//
+  {
+    is_picked predicate(SAMPLE_SIZE, 1.0, acc);
+
+    sample_iterator sb = sample_iterator(predicate, const_pop.begin(), const_pop.end());
+    sample_iterator se = sample_iterator(predicate, const_pop.end(),   const_pop.end());
+    sample_iterator si = sb;
+    clock_t clock_start = clock();
+    for (size_t count = 0; count < NB_ROUNDS; count++)
+      for (si = sb; si != se; ++si)
+      {
+      }
+    std::cout << "Bench for " << msg << ": " << clock() - clock_start << std::endl;
+  }
+}
+
+typedef trsl::const_method_weight_accessor<
+  double, trsl::example::Particle, &trsl::example::Particle::getWeight
+  > compile_time_method_accessor;
+
+typedef trsl::member_weight_accessor<
+  double, PublicWeightParticle, &PublicWeightParticle::weight
+  > compile_time_member_accessor;
+
+// Checks that the compile-time accessors return the same weights as
+// mp_weight_accessor.
+void accessor_check()
+{
+  std::vector<PickCountParticle> particles;
+  generatePopulation(POPULATION_SIZE, particles);
+  std::vector<PublicWeightParticle> population;
+  copyPopulation(particles, population);
+
+  trsl::mp_weight_accessor<double, PickCountParticle>
+    mpAccessor(&PickCountParticle::getWeight);
+  compile_time_method_accessor methodAccessor;
+  compile_time_member_accessor memberAccessor;
+
+  double mpSum = 0, methodSum = 0, memberSum = 0;
+  for (size_t i = 0; i < POPULATION_SIZE; ++i)
+  {
+    mpSum += mpAccessor(particles[i]);
+    methodSum += methodAccessor(particles[i]);
+    memberSum += memberAccessor(population[i]);
+  }
+  // Same weights, summed in the same order.
+  if (!(methodSum == mpSum && memberSum == mpSum))
+    TRSL_TEST_FAILURE;
+  if (fabs(mpSum-1) > 1e-6)
+    TRSL_TEST_FAILURE;
+}
+
 int main()
 {
   // BSD has two different random generators
@@ -131,6 +274,8 @@ int main()
   srand(random_seed);
   
     
+  accessor_check();
+
   std::cout << "trsl_loop:" << std::endl;
   
   trsl_loop
@@ -153,6 +298,36 @@ int main()
     <trsl::mp_weight_accessor<double, PickCountParticle> >
     (&PickCountParticle::getWeight, "mp_weight_accessor");
 
+  trsl_loop
+    <compile_time_method_accessor>
+    (compile_time_method_accessor(), "const_method_weight_accessor");
+
+  std::cout << "batch_loop:" << std::endl;
+
+  batch_loop
+    <std::pointer_to_unary_function<const PickCountParticle&, double> >
+    (std::ptr_fun(wac_function), "wac_function");
+
+  batch_loop
+    <std::pointer_to_unary_function<const PickCountParticle&, double> >
+    (std::ptr_fun(wac_function_no_inline), "wac_function_no_inline");
+
+  batch_loop
+    <wac_functor>
+    (wac_functor(), "wac_functor");
+
+  batch_loop
+    <wac_functor_no_inline>
+    (wac_functor_no_inline(), "wac_functor_no_inline");
+
+  batch_loop
+    <trsl::mp_weight_accessor<double, PickCountParticle> >
+    (&PickCountParticle::getWeight, "mp_weight_accessor");
+
+  batch_loop
+    <compile_time_method_accessor>
+    (compile_time_method_accessor(), "const_method_weight_accessor");
+
   std::cout << "stl_loop:" << std::endl;
 
   stl_loop
@@ -175,6 +350,20 @@ int main()
     <trsl::mp_weight_accessor<double, PickCountParticle> >
     (&PickCountParticle::getWeight, "mp_weight_accessor");
 
+  stl_loop
+    <compile_time_method_accessor>
+    (compile_time_method_accessor(), "const_method_weight_accessor");
+
+  std::cout << "member_loop:" << std::endl;
+
+  member_loop
+    <public_weight_functor>
+    (public_weight_functor(), "public_weight_functor");
+
+  member_loop
+    <compile_time_member_accessor>
+    (compile_time_member_accessor(), "member_weight_accessor");
+
   std::cout << "drop_in_call" << std::endl;
     
   drop_in_call();
@@ -0,0 +1,93 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <trsl/alias_table.hpp>
+#include <trsl/systematic_sample.hpp>
+#include <tests/common.hpp>
+using namespace trsl::test;
+
+// Compares, for a growing number of draws from a fixed population:
+//
+// - systematic: one systematic sample of size 1 per draw, i.e. one
+//   pass over the population per draw (the persistent_filter_iterator
+//   way of drawing single elements);
+// - systematic batch: a single systematic sample containing all the
+//   draws (only possible when all draws are known in advance);
+// - alias: building an alias table, then drawing from it.
+//
+// Times are in clock ticks.
+
+static const size_t POPULATION_SIZE = 10000;
+
+unsigned long random_seed = time(NULL)*getpid();
+
+int main()
+{
+  // BSD has two different random generators
+  srandom(random_seed);
+  srand(random_seed);
+
+  typedef std::vector<PickCountParticle> ParticleArray;
+  typedef trsl::is_picked_systematic<PickCountParticle, double, wac_functor> is_picked;
+  typedef trsl::persistent_filter_iterator
+    <is_picked, ParticleArray::const_iterator> sample_iterator;
+
+  ParticleArray population;
+  generatePopulation(POPULATION_SIZE, population);
+  ParticleArray const& const_pop = population;
+
+  std::cout << "population size: " << POPULATION_SIZE << std::endl;
+  std::cout << "draws\tsystematic\tsystematic batch\talias (build+draw)" << std::endl;
+
+  size_t checksum = 0;
+  for (size_t nDraws = 1; nDraws <= 10000000; nDraws *= 10)
+  {
+    std::vector<size_t> indices(nDraws + nDraws/2 + 1);
+
+    clock_t systematic = 0;
+    // Beyond 10^5 draws, this takes minutes; don't bother.
+    if (nDraws <= 100000)
+    {
+      clock_t clock_start = clock();
+      for (size_t d = 0; d < nDraws; ++d)
+      {
+        is_picked predicate(1, 1.0);
+        sample_iterator si(predicate, const_pop.begin(), const_pop.end());
+        checksum += std::distance(const_pop.begin(), si.base());
+      }
+      systematic = clock() - clock_start;
+    }
+
+    clock_t batch;
+    {
+      clock_t clock_start = clock();
+      std::vector<size_t>::iterator end =
+        trsl::systematic_sample(const_pop.begin(), const_pop.end(),
+                                nDraws, 1.0, wac_functor(),
+                                indices.begin());
+      checksum += end - indices.begin();
+      batch = clock() - clock_start;
+    }
+
+    clock_t alias;
+    {
+      clock_t clock_start = clock();
+      trsl::alias_table<> table(const_pop.begin(), const_pop.end(),
+                                wac_functor());
+      table.draw(nDraws, indices.begin());
+      checksum += indices.front();
+      alias = clock() - clock_start;
+    }
+
+    std::cout << nDraws << "\t";
+    if (nDraws <= 100000)
+      std::cout << systematic;
+    else
+      std::cout << "-";
+    std::cout << "\t" << batch << "\t" << alias << std::endl;
+  }
+  // avoid nop-ing the loops:
+  return checksum == 0;
+}
@@ -0,0 +1,135 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+// Compares the time (clock ticks) taken to sample a histogram
+// (integer weights) with floating-point systematic sampling and with
+// exact integer systematic sampling, through persistent_filter_iterator
+// and through the batch offspring functions, and reports how often
+// the floating-point sample size differs from the requested one.
+// Elements are picked about 20 times each on average: the integer
+// batch function computes each count with one division, while the
+// other functions iterate once per pick.
+
+#include <trsl/is_picked_systematic.hpp>
+#include <trsl/is_picked_systematic_integer.hpp>
+#include <trsl/persistent_filter_iterator.hpp>
+#include <trsl/systematic_sample.hpp>
+#include <tests/common.hpp>
+using namespace trsl::test;
+
+static const size_t NB_ROUNDS = 20;
+static const size_t POPULATION_SIZE = 1000000;
+static const size_t SAMPLE_SIZE = 10000000;
+
+unsigned long random_seed = time(NULL)*getpid();
+
+struct Bin
+{
+  boost::uint64_t count;
+  double real_count;
+};
+
+typedef trsl::member_weight_accessor<
+  boost::uint64_t, Bin, &Bin::count> integer_accessor;
+typedef trsl::member_weight_accessor<
+  double, Bin, &Bin::real_count> real_accessor;
+
+int main()
+{
+  srandom(random_seed);
+  srand(random_seed);
+
+  std::vector<Bin> population(POPULATION_SIZE);
+  boost::uint64_t totalWeight = 0;
+  for (size_t i = 0; i < POPULATION_SIZE; ++i)
+  {
+    population[i].count = rand() % 1000;
+    population[i].real_count = double(population[i].count);
+    totalWeight += population[i].count;
+  }
+  std::vector<Bin> const& const_pop = population;
+  std::vector<double> uniforms(NB_ROUNDS);
+  for (size_t r = 0; r < NB_ROUNDS; ++r)
+    uniforms[r] = trsl::rand_gen::uniform_01<double>();
+
+  //------------------------------//
+  // persistent_filter_iterator   //
+  //------------------------------//
+  {
+    typedef trsl::is_picked_systematic<
+      Bin, double, real_accessor> is_picked;
+    typedef trsl::persistent_filter_iterator<
+      is_picked, std::vector<Bin>::const_iterator> sample_iterator;
+    size_t wrongSize = 0;
+    clock_t clock_start = clock();
+    for (size_t r = 0; r < NB_ROUNDS; ++r)
+    {
+      is_picked predicate(SAMPLE_SIZE, double(totalWeight), uniforms[r]);
+      size_t size = 0;
+      for (sample_iterator
+             si = sample_iterator(predicate, const_pop.begin(), const_pop.end()),
+             se = sample_iterator(predicate, const_pop.end(), const_pop.end());
+           si != se; ++si)
+        ++size;
+      if (size != SAMPLE_SIZE) ++wrongSize;
+    }
+    std::cout << "Bench for is_picked_systematic: " << clock() - clock_start
+              << " (" << wrongSize << " wrong sample sizes)" << std::endl;
+  }
+  {
+    typedef trsl::is_picked_systematic_integer<
+      Bin, boost::uint64_t, integer_accessor> is_picked;
+    typedef trsl::persistent_filter_iterator<
+      is_picked, std::vector<Bin>::const_iterator> sample_iterator;
+    size_t wrongSize = 0;
+    clock_t clock_start = clock();
+    for (size_t r = 0; r < NB_ROUNDS; ++r)
+    {
+      is_picked predicate(SAMPLE_SIZE, totalWeight, uniforms[r]);
+      size_t size = 0;
+      for (sample_iterator
+             si = sample_iterator(predicate, const_pop.begin(), const_pop.end()),
+             se = sample_iterator(predicate, const_pop.end(), const_pop.end());
+           si != se; ++si)
+        ++size;
+      if (size != SAMPLE_SIZE) ++wrongSize;
+    }
+    std::cout << "Bench for is_picked_systematic_integer: " << clock() - clock_start
+              << " (" << wrongSize << " wrong sample sizes)" << std::endl;
+  }
+
+  //------------------------------//
+  // Batch offspring              //
+  //------------------------------//
+  {
+    std::vector<size_t> counts(POPULATION_SIZE);
+    size_t sum = 0;
+    clock_t clock_start = clock();
+    for (size_t r = 0; r < NB_ROUNDS; ++r)
+    {
+      trsl::systematic_offspring(const_pop.begin(), const_pop.end(),
+                                 SAMPLE_SIZE, double(totalWeight), uniforms[r],
+                                 real_accessor(), counts.begin());
+      sum += counts[r];
+    }
+    std::cout << "Bench for systematic_offspring: " << clock() - clock_start
+              << std::endl;
+
+    clock_start = clock();
+    for (size_t r = 0; r < NB_ROUNDS; ++r)
+    {
+      trsl::systematic_offspring_integer(const_pop.begin(), const_pop.end(),
+                                         SAMPLE_SIZE, totalWeight, uniforms[r],
+                                         integer_accessor(), counts.begin());
+      sum += counts[r];
+    }
+    std::cout << "Bench for systematic_offspring_integer: " << clock() - clock_start
+              << std::endl;
+    // avoid nop-ing the loops:
+    if (sum == size_t(-1)) std::cout << sum << std::endl;
+  }
+
+  return 0;
+}
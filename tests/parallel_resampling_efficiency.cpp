@@ -0,0 +1,131 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+// Compares, for 1, 4, 16 and 64 threads, the wall-clock time
+// (seconds per sample) of:
+//
+// - systematic: computing the population weight, then
+//   trsl::systematic_sample (serial);
+// - parallel systematic: computing the population weight, then
+//   trsl::parallel_systematic_sample;
+// - metropolis: trsl::metropolis_resample with METROPOLIS_STEPS steps;
+// - rejection: trsl::rejection_resample, with the largest weight as
+//   bound (computed once, outside of the timings).
+//
+// Thread counts larger than the number of cores show the overhead of
+// oversubscription rather than a speedup.
+
+#include <trsl/parallel_systematic_sample.hpp>
+#include <trsl/metropolis_resample.hpp>
+#include <trsl/rejection_resample.hpp>
+#include <tests/common.hpp>
+using namespace trsl::test;
+
+#include <sys/time.h>
+
+static const size_t POPULATION_SIZE = 1000000;
+static const size_t SAMPLE_SIZE = 1000000;
+static const unsigned METROPOLIS_STEPS = 32;
+static const size_t NB_ROUNDS = 5;
+
+unsigned long random_seed = time(NULL)*getpid();
+
+double wall_time()
+{
+  timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+int main()
+{
+  // BSD has two different random generators
+  srandom(random_seed);
+  srand(random_seed);
+
+  typedef std::vector<PickCountParticle> ParticleArray;
+  ParticleArray population;
+  generatePopulation(POPULATION_SIZE, population);
+  ParticleArray const& const_pop = population;
+
+  double maxWeight = 0;
+  for (ParticleArray::const_iterator e = const_pop.begin();
+       e != const_pop.end(); ++e)
+    maxWeight = std::max(maxWeight, e->getWeight());
+
+  std::vector<size_t> indices(SAMPLE_SIZE);
+  size_t checksum = 0;
+
+#ifdef _OPENMP
+  std::cout << "cores: " << omp_get_num_procs() << std::endl;
+#else
+  std::cout << "(compiled without OpenMP, all runs are serial)" << std::endl;
+#endif
+  std::cout << "threads\tsystematic\tparallel systematic\tmetropolis\trejection" << std::endl;
+
+  const int THREADS[] = { 1, 4, 16, 64 };
+  for (unsigned t = 0; t < sizeof(THREADS)/sizeof(int); ++t)
+  {
+#ifdef _OPENMP
+    omp_set_num_threads(THREADS[t]);
+#endif
+    double systematic, parallelSystematic, metropolis, rejection;
+    double start;
+
+    start = wall_time();
+    for (size_t round = 0; round < NB_ROUNDS; ++round)
+    {
+      double totalWeight = 0;
+      for (ParticleArray::const_iterator e = const_pop.begin();
+           e != const_pop.end(); ++e)
+        totalWeight += e->getWeight();
+      checksum += trsl::systematic_sample(const_pop.begin(), const_pop.end(),
+                                          SAMPLE_SIZE, totalWeight,
+                                          wac_functor(),
+                                          indices.begin()) - indices.begin();
+    }
+    systematic = (wall_time() - start) / NB_ROUNDS;
+
+    start = wall_time();
+    for (size_t round = 0; round < NB_ROUNDS; ++round)
+    {
+      double totalWeight = 0;
+      for (ParticleArray::const_iterator e = const_pop.begin();
+           e != const_pop.end(); ++e)
+        totalWeight += e->getWeight();
+      checksum += trsl::parallel_systematic_sample(const_pop.begin(), const_pop.end(),
+                                                   SAMPLE_SIZE, totalWeight,
+                                                   wac_functor(),
+                                                   indices.begin()) - indices.begin();
+    }
+    parallelSystematic = (wall_time() - start) / NB_ROUNDS;
+
+    start = wall_time();
+    for (size_t round = 0; round < NB_ROUNDS; ++round)
+    {
+      trsl::metropolis_resample(const_pop.begin(), const_pop.end(),
+                                SAMPLE_SIZE, METROPOLIS_STEPS,
+                                wac_functor(), indices.begin());
+      checksum += indices[round];
+    }
+    metropolis = (wall_time() - start) / NB_ROUNDS;
+
+    start = wall_time();
+    for (size_t round = 0; round < NB_ROUNDS; ++round)
+    {
+      trsl::rejection_resample(const_pop.begin(), const_pop.end(),
+                               SAMPLE_SIZE, maxWeight,
+                               wac_functor(), indices.begin());
+      checksum += indices[round];
+    }
+    rejection = (wall_time() - start) / NB_ROUNDS;
+
+    std::cout << THREADS[t] << "\t" << systematic << "\t"
+              << parallelSystematic << "\t" << metropolis << "\t"
+              << rejection << std::endl;
+  }
+  // avoid nop-ing the loops:
+  return checksum == 0;
+}
@@ -0,0 +1,77 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+// Compares trsl::systematic_offspring with
+// trsl::parallel_systematic_offspring on a large population, for an
+// increasing number of threads. Times are wall-clock seconds (clock()
+// would add up the time of all threads).
+
+#include <trsl/parallel_systematic_sample.hpp>
+#include <tests/common.hpp>
+using namespace trsl::test;
+
+#include <sys/time.h>
+
+static const size_t POPULATION_SIZE = 10000000;
+static const size_t SAMPLE_SIZE = 10000000;
+static const size_t NB_ROUNDS = 10;
+
+unsigned long random_seed = time(NULL)*getpid();
+
+double wall_time()
+{
+  timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+int main()
+{
+  // BSD has two different random generators
+  srandom(random_seed);
+  srand(random_seed);
+
+  typedef std::vector<PickCountParticle> ParticleArray;
+  ParticleArray population;
+  generatePopulation(POPULATION_SIZE, population);
+  ParticleArray const& const_pop = population;
+
+  std::vector<size_t> counts(POPULATION_SIZE);
+  size_t checksum = 0;
+
+  std::cout << "threads\tseconds per sample" << std::endl;
+  {
+    double start = wall_time();
+    for (size_t round = 0; round < NB_ROUNDS; ++round)
+    {
+      trsl::systematic_offspring(const_pop.begin(), const_pop.end(),
+                                 SAMPLE_SIZE, 1.0, wac_functor(),
+                                 counts.begin());
+      checksum += counts[round];
+    }
+    std::cout << "serial\t" << (wall_time() - start) / NB_ROUNDS << std::endl;
+  }
+
+#ifdef _OPENMP
+  const int maxThreads = omp_get_num_procs();
+  for (int nThreads = 1; nThreads <= maxThreads; nThreads *= 2)
+  {
+    omp_set_num_threads(nThreads);
+    double start = wall_time();
+    for (size_t round = 0; round < NB_ROUNDS; ++round)
+    {
+      trsl::parallel_systematic_offspring(const_pop.begin(), const_pop.end(),
+                                          SAMPLE_SIZE, 1.0, wac_functor(),
+                                          counts.begin());
+      checksum += counts[round];
+    }
+    std::cout << nThreads << "\t" << (wall_time() - start) / NB_ROUNDS << std::endl;
+  }
+#else
+  std::cout << "(compiled without OpenMP)" << std::endl;
+#endif
+  // avoid nop-ing the loops:
+  return checksum == 0;
+}
@@ -0,0 +1,187 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+// Compares the time (clock ticks) taken to randomly permute the
+// indices of a large population with std::random_shuffle and
+// std::rand() % n (the former implementation of
+// random_permutation_iterator), with random_permutation_iterator
+// (multiply-shift bounded integers drawn from std::rand()), and with
+// random_permutation_iterator and a xoshiro256 generator, and
+// compares a full traversal of random_permutation_iterator with one
+// of feistel_permutation_iterator, which stores no index array. It
+// times repeated permutations with and without an index_workspace,
+// then compares random_permutation_iterator and
+// lazy_random_permutation_iterator in a search that stops after a
+// few elements. The population size can be given as first argument;
+// the default is 10^8 elements, which needs about 1GB of memory for
+// the permutation indices.
+
+#include <trsl/random_permutation_iterator.hpp>
+#include <trsl/lazy_random_permutation_iterator.hpp>
+#include <trsl/feistel_permutation_iterator.hpp>
+#include <trsl/xoshiro256.hpp>
+#include <tests/common.hpp>
+using namespace trsl::test;
+
+static const size_t NB_EARLY_EXITS = 1000;
+static const size_t NB_REPEATS = 100;
+
+unsigned long random_seed = time(NULL)*getpid();
+
+struct modulo_rand
+{
+  std::ptrdiff_t operator()(std::ptrdiff_t n)
+    {
+      return std::rand() % n;
+    }
+};
+
+int main(int argc, char** argv)
+{
+  srandom(random_seed);
+  srand(random_seed);
+
+  size_t populationSize = 100000000;
+  if (argc > 1)
+    populationSize = size_t(std::atof(argv[1]));
+
+  std::vector<unsigned char> population(populationSize);
+
+  //------------------------------//
+  // std::random_shuffle, modulo  //
+  //------------------------------//
+  {
+    clock_t clock_start = clock();
+    std::vector<size_t> indices(populationSize);
+    for (size_t i = 0; i < populationSize; ++i)
+      indices[i] = i;
+    modulo_rand rng;
+    std::random_shuffle(indices.begin(), indices.end(), rng);
+    std::cout << "Bench for std::random_shuffle and rand() % n: "
+              << clock() - clock_start << std::endl;
+  }
+
+  //------------------------------//
+  // random_permutation_iterator  //
+  //------------------------------//
+  {
+    clock_t clock_start = clock();
+    trsl::reorder_iterator<std::vector<unsigned char>::const_iterator> pi =
+      trsl::random_permutation_iterator(population.begin(), population.end());
+    std::cout << "Bench for random_permutation_iterator: "
+              << clock() - clock_start << std::endl;
+  }
+
+  //------------------------------//
+  // with xoshiro256              //
+  //------------------------------//
+  {
+    trsl::xoshiro256 g(random_seed);
+    clock_t clock_start = clock();
+    trsl::reorder_iterator<std::vector<unsigned char>::const_iterator> pi =
+      trsl::random_permutation_iterator(population.begin(), population.end(), g);
+    std::cout << "Bench for random_permutation_iterator with xoshiro256: "
+              << clock() - clock_start << std::endl;
+  }
+
+  //------------------------------//
+  // full traversal               //
+  //------------------------------//
+  {
+    typedef std::vector<unsigned char>::const_iterator element_iterator;
+    std::vector<unsigned char> const& const_pop = population;
+    size_t sum = 0;
+    clock_t clock_start = clock();
+    {
+      trsl::reorder_iterator<element_iterator> pi =
+        trsl::random_permutation_iterator(const_pop.begin(), const_pop.end());
+      for (trsl::reorder_iterator<element_iterator> pe = pi.end(); pi != pe; ++pi)
+        sum += *pi;
+    }
+    std::cout << "Bench for a traversal of random_permutation_iterator: "
+              << clock() - clock_start << std::endl;
+
+    clock_start = clock();
+    trsl::feistel_reorder_iterator<element_iterator> fi =
+      trsl::feistel_permutation_iterator(const_pop.begin(), const_pop.end());
+    for (trsl::feistel_reorder_iterator<element_iterator> fe = fi.end(); fi != fe; ++fi)
+      sum += *fi;
+    std::cout << "Bench for a traversal of feistel_permutation_iterator: "
+              << clock() - clock_start << " (" << sum << ")" << std::endl;
+  }
+
+  //------------------------------//
+  // repeated permutations        //
+  //------------------------------//
+  {
+    // Creates a permutation per round, with a new index array each
+    // time, then with an index_workspace. Times are per permutation.
+    typedef std::vector<unsigned char>::const_iterator element_iterator;
+    std::vector<unsigned char> const& const_pop = population;
+    size_t nbRounds = populationSize >= 10000000 ? 3 : NB_REPEATS;
+    trsl::xoshiro256 g(random_seed);
+    clock_t clock_start = clock();
+    for (size_t round = 0; round < nbRounds; ++round)
+    {
+      trsl::reorder_iterator<element_iterator> pi =
+        trsl::random_permutation_iterator(const_pop.begin(), const_pop.end(), g);
+    }
+    std::cout << "Bench for repeated random_permutation_iterator: "
+              << (clock() - clock_start) / nbRounds << std::endl;
+
+    trsl::index_workspace<> workspace;
+    clock_start = clock();
+    for (size_t round = 0; round < nbRounds; ++round)
+    {
+      trsl::reorder_iterator<element_iterator> pi =
+        trsl::random_permutation_iterator(const_pop.begin(), const_pop.end(),
+                                          g, workspace);
+    }
+    std::cout << "Bench for repeated random_permutation_iterator "
+              << "with an index_workspace: "
+              << (clock() - clock_start) / nbRounds << std::endl;
+  }
+
+  //------------------------------//
+  // early exit                   //
+  //------------------------------//
+  {
+    // Reads elements in random order until one of the 1000 marked
+    // elements is found. Times are per search; the eager iterator is
+    // timed on a single search for large populations.
+    size_t step = std::max(populationSize / 1000, size_t(1));
+    for (size_t i = 0; i < populationSize; i += step)
+      population[i] = 1;
+    std::vector<unsigned char> const& const_pop = population;
+
+    typedef std::vector<unsigned char>::const_iterator element_iterator;
+    size_t nbEager = populationSize >= 10000000 ? 1 : NB_EARLY_EXITS;
+    size_t read = 0;
+    clock_t clock_start = clock();
+    for (size_t round = 0; round < nbEager; ++round)
+    {
+      trsl::reorder_iterator<element_iterator> pi =
+        trsl::random_permutation_iterator(const_pop.begin(), const_pop.end());
+      for (; *pi == 0; ++pi) ++read;
+    }
+    std::cout << "Bench for an early exit with random_permutation_iterator: "
+              << (clock() - clock_start) / nbEager
+              << " (" << read / nbEager << " reads)" << std::endl;
+
+    read = 0;
+    clock_start = clock();
+    for (size_t round = 0; round < NB_EARLY_EXITS; ++round)
+    {
+      trsl::lazy_reorder_iterator<element_iterator> pi =
+        trsl::lazy_random_permutation_iterator(const_pop.begin(), const_pop.end());
+      for (; *pi == 0; ++pi) ++read;
+    }
+    std::cout << "Bench for an early exit with lazy_random_permutation_iterator: "
+              << (clock() - clock_start) / NB_EARLY_EXITS
+              << " (" << read / NB_EARLY_EXITS << " reads)" << std::endl;
+  }
+
+  return 0;
+}
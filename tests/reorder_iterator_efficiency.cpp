@@ -4,6 +4,7 @@
 // http://www.boost.org/LICENSE_1_0.txt)
 
 #include <trsl/random_permutation_iterator.hpp>
+#include <trsl/prefetch_for_each.hpp>
 #include <tests/common.hpp>
 using namespace trsl::test;
 
@@ -18,6 +19,17 @@ private:
   //double payload[0];
 };
 
+struct LargeElement
+{
+  LargeElement() { std::fill(payload, payload + 16, 0.0); }
+  void touch() { payload[0] += 1; payload[15] += 1; }
+  double payload[16];
+};
+
+struct touch_element
+{
+  void operator()(LargeElement& e) const { e.touch(); }
+};
 
 int main()
 {
@@ -109,5 +121,88 @@ int main()
       clock_t end = clock(); std::cerr << end-start << std::endl;
     }
   }
+
+  // ---------------------------------------------------- //
+  // Test 2: index type, large population --------------- //
+  // ---------------------------------------------------- //
+  {
+    // Traversal of a permutation of small elements is bound by the
+    // bandwidth of the index array. Traversal time is printed for
+    // size_t, then boost::uint32_t indices.
+    typedef std::vector<float> FloatArray;
+    const size_t LARGE_POPULATION_SIZE = 10000000;
+    const unsigned N_TRAVERSALS = 10;
+
+    FloatArray population(LARGE_POPULATION_SIZE, 1.0f);
+
+    {
+      typedef trsl::reorder_iterator
+        <FloatArray::const_iterator> permutation_iterator;
+      permutation_iterator sb =
+        trsl::random_permutation_iterator(population.begin(),
+                                          population.end());
+      permutation_iterator se = sb.end();
+      float sum = 0;
+      clock_t start = clock();
+      for (unsigned round = 0; round < N_TRAVERSALS; round++)
+        for (permutation_iterator si = sb; si != se; ++si)
+          sum += *si;
+      clock_t end = clock(); std::cerr << end-start << std::endl;
+      if (sum == 0) TRSL_TEST_FAILURE;
+    }
+    {
+      typedef trsl::reorder_iterator
+        <FloatArray::const_iterator, boost::uint32_t> permutation_iterator;
+      permutation_iterator sb =
+        trsl::random_permutation_iterator<boost::uint32_t>(population.begin(),
+                                                           population.end());
+      permutation_iterator se = sb.end();
+      float sum = 0;
+      clock_t start = clock();
+      for (unsigned round = 0; round < N_TRAVERSALS; round++)
+        for (permutation_iterator si = sb; si != se; ++si)
+          sum += *si;
+      clock_t end = clock(); std::cerr << end-start << std::endl;
+      if (sum == 0) TRSL_TEST_FAILURE;
+    }
+  }
+
+  // ---------------------------------------------------- //
+  // Test 3: prefetching, large elements ---------------- //
+  // ---------------------------------------------------- //
+  {
+    // Elements span two cache lines, and the population does not fit
+    // in the caches. Traversal time is printed for a plain loop, then
+    // for prefetch_for_each.
+    typedef std::vector<LargeElement> LargeArray;
+    typedef trsl::reorder_iterator
+      <LargeArray::iterator> permutation_iterator;
+    const size_t LARGE_POPULATION_SIZE = 2000000;
+
+    LargeArray population(LARGE_POPULATION_SIZE);
+    permutation_iterator sb =
+      trsl::random_permutation_iterator(population.begin(),
+                                        population.end());
+    permutation_iterator se = sb.end();
+
+    {
+      clock_t start = clock();
+      for (permutation_iterator si = sb; si != se; ++si)
+        si->touch();
+      clock_t end = clock(); std::cerr << end-start << std::endl;
+    }
+    {
+      clock_t start = clock();
+      trsl::prefetch_for_each(sb, se, touch_element());
+      clock_t end = clock(); std::cerr << end-start << std::endl;
+    }
+    for (LargeArray::const_iterator i = population.begin();
+         i != population.end(); ++i)
+      if (i->payload[0] != 2 || i->payload[15] != 2)
+      {
+        TRSL_TEST_FAILURE;
+        break;
+      }
+  }
   return 0;
 }
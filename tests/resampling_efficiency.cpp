@@ -0,0 +1,91 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+// Compares the sampling predicates by throughput (clock ticks for
+// NB_ROUNDS samples) and by variance: the mean, over the population,
+// of the variance of an element's number of picks. For all schemes,
+// the expected number of picks of an element is SAMPLE_SIZE*weight;
+// the lower the variance, the closer each sample is to the
+// population.
+
+#include <trsl/is_picked_systematic.hpp>
+#include <trsl/is_picked_stratified.hpp>
+#include <trsl/is_picked_residual.hpp>
+#include <trsl/is_picked_multinomial.hpp>
+#include <tests/common.hpp>
+using namespace trsl::test;
+#include <string>
+
+static const size_t NB_ROUNDS = 10000;
+static const size_t POPULATION_SIZE = 1000;
+static const size_t SAMPLE_SIZE = 1000;
+
+unsigned long random_seed = time(NULL)*getpid();
+
+template<class is_picked>
+void bench(std::vector<PickCountParticle> const& population,
+           const std::string msg)
+{
+  typedef trsl::persistent_filter_iterator
+    <is_picked, std::vector<PickCountParticle>::const_iterator> sample_iterator;
+
+  std::vector<size_t> counts(population.size());
+  std::vector<double> sum(population.size(), 0);
+  std::vector<double> sumOfSquares(population.size(), 0);
+
+  clock_t duration = 0;
+  for (size_t round = 0; round < NB_ROUNDS; round++)
+  {
+    std::fill(counts.begin(), counts.end(), 0);
+
+    clock_t clock_start = clock();
+    is_picked predicate(SAMPLE_SIZE, 1.0, wac_functor());
+    for (sample_iterator
+           si = sample_iterator(predicate, population.begin(), population.end()),
+           se = sample_iterator(predicate, population.end(), population.end());
+         si != se; ++si)
+      counts[si.base() - population.begin()]++;
+    duration += clock() - clock_start;
+
+    for (size_t i = 0; i < counts.size(); ++i)
+    {
+      sum[i] += counts[i];
+      sumOfSquares[i] += double(counts[i]) * counts[i];
+    }
+  }
+
+  double variance = 0;
+  for (size_t i = 0; i < population.size(); ++i)
+  {
+    double mean = sum[i] / NB_ROUNDS;
+    variance += sumOfSquares[i] / NB_ROUNDS - mean * mean;
+  }
+  variance /= population.size();
+
+  std::cout << msg << "\t" << duration << "\t" << variance << std::endl;
+}
+
+int main()
+{
+  // BSD has two different random generators
+  srandom(random_seed);
+  srand(random_seed);
+
+  std::vector<PickCountParticle> population;
+  generatePopulation(POPULATION_SIZE, population);
+
+  std::cout << "scheme\tclock\tmean offspring variance" << std::endl;
+
+  bench< trsl::is_picked_systematic<PickCountParticle, double, wac_functor> >
+    (population, "systematic");
+  bench< trsl::is_picked_stratified<PickCountParticle, double, wac_functor> >
+    (population, "stratified");
+  bench< trsl::is_picked_residual<PickCountParticle, double, wac_functor> >
+    (population, "residual");
+  bench< trsl::is_picked_multinomial<PickCountParticle, double, wac_functor> >
+    (population, "multinomial");
+
+  return 0;
+}
@@ -0,0 +1,148 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+// Compares the time (clock ticks) taken to sample a population of
+// large elements (about 200 bytes) stored
+//
+// - as an array of structures (AoS), as in examples/Particle.hpp:
+//   the weight is read through an mp_weight_accessor;
+// - as a structure of arrays (SoA), with trsl::soa_population: only
+//   the weight column is read, and records are gathered at the picked
+//   indices.
+//
+// Both the batch path (trsl::systematic_sample) and the
+// ppfilter_iterator path are measured; the latter also pays for a
+// random permutation of the population. The sample is small with
+// respect to the population, so that the sampling pass dominates.
+
+#include <trsl/soa_population.hpp>
+#include <trsl/systematic_sample.hpp>
+#include <trsl/ppfilter_iterator.hpp>
+#include <tests/common.hpp>
+using namespace trsl::test;
+
+static const size_t NB_ROUNDS = 20;
+static const size_t POPULATION_SIZE = 1000000;
+static const size_t SAMPLE_SIZE = 1000;
+
+unsigned long random_seed = time(NULL)*getpid();
+
+struct Record
+{
+  double x[24];
+};
+
+// AoS element, with the weight next to the record.
+class BigParticle
+{
+public:
+  BigParticle(double weight) : weight_(weight) {}
+  double getWeight() const { return weight_; }
+  Record record;
+private:
+  double weight_;
+};
+
+int main()
+{
+  srandom(random_seed);
+  srand(random_seed);
+
+  std::vector<BigParticle> aos;
+  trsl::soa_population<Record> soa;
+  aos.reserve(POPULATION_SIZE);
+  soa.reserve(POPULATION_SIZE);
+  double totalWeight = 0;
+  for (size_t i = 0; i < POPULATION_SIZE; ++i)
+  {
+    const double w = double(rand())/RAND_MAX;
+    BigParticle p(w);
+    for (size_t k = 0; k < 24; ++k) p.record.x[k] = k;
+    aos.push_back(p);
+    soa.add(p.record, w);
+    totalWeight += w;
+  }
+  std::vector<BigParticle> const& const_aos = aos;
+
+  typedef trsl::mp_weight_accessor<double, BigParticle> aos_accessor;
+  aos_accessor aos_wac(&BigParticle::getWeight);
+
+  std::cout << "Element size: " << sizeof(BigParticle) << " bytes" << std::endl;
+
+  //------------------------------//
+  // systematic_sample            //
+  //------------------------------//
+  {
+    std::vector<size_t> indices(2*SAMPLE_SIZE);
+    double sum = 0;
+    clock_t clock_start = clock();
+    for (size_t count = 0; count < NB_ROUNDS; count++)
+    {
+      std::vector<size_t>::iterator end =
+        trsl::systematic_sample(const_aos.begin(), const_aos.end(),
+                                SAMPLE_SIZE, totalWeight, aos_wac,
+                                indices.begin());
+      for (std::vector<size_t>::iterator i = indices.begin(); i != end; ++i)
+        sum += const_aos[*i].record.x[1];
+    }
+    std::cout << "Bench for AoS systematic_sample: "
+              << clock() - clock_start << std::endl;
+
+    clock_start = clock();
+    for (size_t count = 0; count < NB_ROUNDS; count++)
+    {
+      std::vector<size_t>::iterator end =
+        trsl::systematic_sample(soa.weight_begin(), soa.weight_end(),
+                                SAMPLE_SIZE, totalWeight,
+                                trsl::identity_weight_accessor<double>(),
+                                indices.begin());
+      for (std::vector<size_t>::iterator i = indices.begin(); i != end; ++i)
+        sum += soa.record(*i).x[1];
+    }
+    std::cout << "Bench for SoA systematic_sample: "
+              << clock() - clock_start << std::endl;
+    // avoid nop-ing the loops:
+    if (! (sum > 0)) std::cout << sum << std::endl;
+  }
+
+  //------------------------------//
+  // ppfilter_iterator            //
+  //------------------------------//
+  {
+    typedef trsl::is_picked_systematic<
+      BigParticle, double, aos_accessor> is_picked;
+    typedef trsl::ppfilter_iterator<
+      is_picked, std::vector<BigParticle>::const_iterator> sample_iterator;
+
+    double sum = 0;
+    clock_t clock_start = clock();
+    for (size_t count = 0; count < NB_ROUNDS; count++)
+    {
+      sample_iterator sb(is_picked(SAMPLE_SIZE, totalWeight, aos_wac),
+                         const_aos.begin(), const_aos.end());
+      for (sample_iterator si = sb, se = sb.end(); si != se; ++si)
+        sum += si->record.x[1];
+    }
+    std::cout << "Bench for AoS ppfilter_iterator: "
+              << clock() - clock_start << std::endl;
+
+    typedef trsl::soa_population<Record> soa_type;
+    typedef trsl::ppfilter_iterator<
+      soa_type::is_picked, soa_type::weight_iterator> soa_iterator;
+    clock_start = clock();
+    for (size_t count = 0; count < NB_ROUNDS; count++)
+    {
+      soa_iterator sb(soa_type::is_picked(SAMPLE_SIZE, totalWeight),
+                      soa.weight_begin(), soa.weight_end());
+      for (soa_iterator si = sb, se = sb.end(); si != se; ++si)
+        sum += soa.record(si.index()).x[1];
+    }
+    std::cout << "Bench for SoA ppfilter_iterator: "
+              << clock() - clock_start << std::endl;
+    if (! (sum > 0)) std::cout << sum << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,150 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <trsl/adaptive_resampler.hpp>
+#include <tests/common.hpp>
+using namespace trsl::test;
+
+int main()
+{
+  // BSD has two different random generators
+  unsigned long random_seed = time(NULL)*getpid();
+  srandom(random_seed);
+  srand(random_seed);
+
+  typedef std::vector<PickCountParticle> ParticleArray;
+  typedef trsl::mp_weight_accessor<double, PickCountParticle> accessor;
+  typedef trsl::is_picked_systematic<PickCountParticle> is_picked;
+  typedef trsl::adaptive_resampler<
+    is_picked, ParticleArray::const_iterator> resampler;
+
+  accessor wac(&PickCountParticle::getWeight);
+
+  // ---------------------------------------------------- //
+  // Test 1: weight statistics -------------------------- //
+  // ---------------------------------------------------- //
+  {
+    const size_t POPULATION_SIZE = 1000;
+
+    //---------------------------//
+    // Test 1a: uniform weights  //
+    //---------------------------//
+    ParticleArray population;
+    for (size_t i = 0; i < POPULATION_SIZE; ++i)
+      population.push_back(PickCountParticle(2, 0, 0));
+    trsl::weight_statistics<> stats =
+      trsl::compute_weight_statistics<double>(population.begin(),
+                                              population.end(), wac);
+    if (stats.populationSize != POPULATION_SIZE ||
+        ! (std::fabs(stats.populationWeight - 2 * POPULATION_SIZE) <= 1e-9) ||
+        ! (std::fabs(stats.effectiveSampleSize - POPULATION_SIZE) <= 1e-9) ||
+        ! (std::fabs(stats.entropy - std::log(double(POPULATION_SIZE))) <= 1e-9))
+    {
+      TRSL_TEST_FAILURE;
+      std::cout << TRSL_NVP(stats.effectiveSampleSize) << "\n"
+                << TRSL_NVP(stats.entropy) << std::endl;
+    }
+
+    //---------------------------//
+    // Test 1b: a single weight  //
+    //---------------------------//
+    for (size_t i = 0; i < POPULATION_SIZE; ++i)
+      population[i].setWeight(0);
+    population[42].setWeight(.3);
+    stats = trsl::compute_weight_statistics<double>(population.begin(),
+                                                    population.end(), wac);
+    if (! (std::fabs(stats.effectiveSampleSize - 1) <= 1e-12) ||
+        ! (std::fabs(stats.entropy) <= 1e-12) )
+      TRSL_TEST_FAILURE;
+
+    //---------------------------//
+    // Test 1c: random weights   //
+    //---------------------------//
+    population.clear();
+    generatePopulation(POPULATION_SIZE, population, false);
+    double sum = 0, sumOfSquares = 0;
+    for (size_t i = 0; i < POPULATION_SIZE; ++i)
+    {
+      sum += population[i].getWeight();
+      sumOfSquares += population[i].getWeight() * population[i].getWeight();
+    }
+    double entropy = 0;
+    for (size_t i = 0; i < POPULATION_SIZE; ++i)
+    {
+      double p = population[i].getWeight() / sum;
+      if (p > 0)
+        entropy -= p * std::log(p);
+    }
+    stats = trsl::compute_weight_statistics<double>(population.begin(),
+                                                    population.end(), wac);
+    if (! (std::fabs(stats.effectiveSampleSize - sum * sum / sumOfSquares) <= 1e-9) ||
+        ! (std::fabs(stats.entropy - entropy) <= 1e-9) )
+      TRSL_TEST_FAILURE;
+  }
+
+  // ---------------------------------------------------- //
+  // Test 2: resampling decision ------------------------ //
+  // ---------------------------------------------------- //
+  {
+    const size_t POPULATION_SIZE = 1000;
+    const size_t SAMPLE_SIZE = 100;
+
+    //-------------------------------//
+    // Test 2a: balanced weights     //
+    //-------------------------------//
+    ParticleArray population;
+    generatePopulation(POPULATION_SIZE, population);
+    ParticleArray const& const_pop = population;
+    {
+      // Uniform random weights have an ESS of 3/4 of the population.
+      resampler r(const_pop.begin(), const_pop.end(), SAMPLE_SIZE, .5, wac);
+      if (r.resampled() || r.begin() != r.end())
+        TRSL_TEST_FAILURE;
+    }
+
+    //-------------------------------//
+    // Test 2b: degenerate weights   //
+    //-------------------------------//
+    for (size_t i = 0; i < POPULATION_SIZE; ++i)
+      if (i % 10 != 0)
+        population[i].setWeight(0);
+    {
+      resampler r(const_pop.begin(), const_pop.end(), SAMPLE_SIZE, .5, wac);
+      if (!r.resampled() ||
+          ! (r.statistics().effectiveSampleSize < .5 * POPULATION_SIZE) )
+        TRSL_TEST_FAILURE;
+      size_t size = 0;
+      for (resampler::sample_iterator si = r.begin(); si != r.end(); ++si)
+      {
+        if (si->getWeight() == 0)
+          TRSL_TEST_FAILURE;
+        ++size;
+      }
+      if (size != SAMPLE_SIZE)
+      {
+        TRSL_TEST_FAILURE;
+        std::cout << TRSL_NVP(size) << "\n" << TRSL_NVP(SAMPLE_SIZE) << std::endl;
+      }
+    }
+  }
+
+  // ---------------------------------------------------- //
+  // Test 3: bad parameters ----------------------------- //
+  // ---------------------------------------------------- //
+  {
+    ParticleArray population;
+    generatePopulation(10, population);
+    bool thrown = false;
+    try {
+      resampler r(population.begin(), population.end(), 10, 2, wac);
+    } catch (trsl::bad_parameter_value &e) {
+      thrown = true;
+    }
+    if (!thrown)
+      TRSL_TEST_FAILURE;
+  }
+
+  return 0;
+}
@@ -0,0 +1,220 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <trsl/alias_table.hpp>
+#include <trsl/xoshiro256.hpp>
+#include <tests/common.hpp>
+using namespace trsl::test;
+
+int main()
+{
+  // BSD has two different random generators
+  unsigned long random_seed = time(NULL)*getpid();
+  srandom(random_seed);
+  srand(random_seed);
+
+  typedef std::vector<PickCountParticle> ParticleArray;
+  typedef trsl::mp_weight_accessor<double, PickCountParticle> accessor;
+
+  // ---------------------------------------------------- //
+  // Test 1: small population --------------------------- //
+  // ---------------------------------------------------- //
+  {
+    const size_t POPULATION_SIZE = 100;
+
+    //-----------------------//
+    // Generate a population //
+    //-----------------------//
+
+    ParticleArray population;
+    generatePopulation(POPULATION_SIZE, population);
+    // Elements with a null weight should never be drawn.
+    population[7].setWeight(0);
+    population[42].setWeight(0);
+
+    trsl::alias_table<> table(population.begin(), population.end(),
+                              accessor(&PickCountParticle::getWeight));
+    if (table.size() != POPULATION_SIZE)
+      TRSL_TEST_FAILURE;
+
+    //------------------------------------------------//
+    // Test 1a: sampling coherency with probabilities //
+    //------------------------------------------------//
+    {
+      const unsigned N_DRAWS = 10000000;
+
+      boost::mt19937 rng((unsigned)random_seed);
+      boost::uniform_01<boost::mt19937> uni_dist(rng);
+
+      std::vector<size_t> indices;
+      indices.reserve(N_DRAWS);
+      table.draw(N_DRAWS, std::back_inserter(indices), uni_dist);
+      if (indices.size() != N_DRAWS)
+        TRSL_TEST_FAILURE;
+
+      for (std::vector<size_t>::const_iterator i = indices.begin();
+           i != indices.end(); ++i)
+        population.at(*i).pick();
+
+      // The population weight is no longer 1 after setting two
+      // weights to 0.
+      double totalWeight = 0;
+      for (ParticleArray::iterator e = population.begin();
+           e != population.end(); e++)
+        totalWeight += e->getWeight();
+
+      for (ParticleArray::iterator e = population.begin();
+           e != population.end(); e++)
+      {
+        double weight = e->getWeight() / totalWeight;
+        double pickProp = double(e->getPickCount()) / N_DRAWS;
+        if (! ( std::fabs(POPULATION_SIZE * weight -
+                          POPULATION_SIZE * pickProp) <= 1e-1) ||
+            (weight == 0 && e->getPickCount() != 0))
+        {
+          TRSL_TEST_FAILURE;
+          std::cout << "Element " << std::distance(population.begin(), e)
+                    << ": weight = " << int(100 * POPULATION_SIZE *
+                                            weight) << "%"
+                    << ", pickp = " << int(100 * POPULATION_SIZE *
+                                           pickProp) << "%"
+                    << std::endl;
+        }
+      }
+    }
+
+    //-------------------------------//
+    // Test 1b: deteministic drawing //
+    //-------------------------------//
+    {
+      for (double u = 0; u < 1; u += 1e-3)
+      {
+        size_t i = table.draw(u);
+        if (i >= POPULATION_SIZE || i != table.draw(u))
+          TRSL_TEST_FAILURE;
+      }
+      if (table.draw(1 - 1e-16) >= POPULATION_SIZE)
+        TRSL_TEST_FAILURE;
+      // One number is split into a bucket and an alias decision.
+      for (double u = 0; u < 1; u += 1e-3)
+      {
+        const double x = u * POPULATION_SIZE;
+        const size_t i = size_t(x);
+        if (table.draw(u) != table.draw_bucket(i, x - i))
+          TRSL_TEST_FAILURE;
+      }
+    }
+
+    //------------------------------------------------//
+    // Test 1c: system-provided random numbers        //
+    //------------------------------------------------//
+    {
+      const unsigned N_DRAWS = 10000000;
+      std::vector<size_t> counts(POPULATION_SIZE, 0);
+      for (unsigned k = 0; k < N_DRAWS; ++k)
+        counts.at(table.draw())++;
+      double totalWeight = 0;
+      for (ParticleArray::iterator e = population.begin();
+           e != population.end(); e++)
+        totalWeight += e->getWeight();
+      for (size_t i = 0; i < POPULATION_SIZE; ++i)
+      {
+        double weight = population[i].getWeight() / totalWeight;
+        double pickProp = double(counts[i]) / N_DRAWS;
+        if (! ( std::fabs(POPULATION_SIZE * weight -
+                          POPULATION_SIZE * pickProp) <= 1e-1) ||
+            (weight == 0 && counts[i] != 0))
+        {
+          TRSL_TEST_FAILURE;
+          std::cout << TRSL_NVP(i) << " " << TRSL_NVP(counts[i]) << std::endl;
+        }
+      }
+    }
+
+    //------------------------------------------------//
+    // Test 1d: user-provided integer generator       //
+    //------------------------------------------------//
+    {
+      const unsigned N_DRAWS = 10000000;
+      trsl::xoshiro256 rng(random_seed);
+      std::vector<size_t> indices;
+      indices.reserve(N_DRAWS);
+      table.draw(N_DRAWS, std::back_inserter(indices), rng);
+      if (indices.size() != N_DRAWS)
+        TRSL_TEST_FAILURE;
+      std::vector<size_t> counts(POPULATION_SIZE, 0);
+      for (std::vector<size_t>::const_iterator i = indices.begin();
+           i != indices.end(); ++i)
+        counts.at(*i)++;
+      double totalWeight = 0;
+      for (ParticleArray::iterator e = population.begin();
+           e != population.end(); e++)
+        totalWeight += e->getWeight();
+      for (size_t i = 0; i < POPULATION_SIZE; ++i)
+      {
+        double weight = population[i].getWeight() / totalWeight;
+        double pickProp = double(counts[i]) / N_DRAWS;
+        if (! ( std::fabs(POPULATION_SIZE * weight -
+                          POPULATION_SIZE * pickProp) <= 1e-1) ||
+            (weight == 0 && counts[i] != 0))
+        {
+          TRSL_TEST_FAILURE;
+          std::cout << TRSL_NVP(i) << " " << TRSL_NVP(counts[i]) << std::endl;
+        }
+      }
+    }
+  }
+
+  // ---------------------------------------------------- //
+  // Test 2: uniform weights, forward-only population --- //
+  // ---------------------------------------------------- //
+  {
+    const size_t POPULATION_SIZE = 1000;
+    const unsigned N_DRAWS = 1000;
+
+    std::list<PickCountParticle> population;
+    generatePopulation(POPULATION_SIZE, population);
+
+    trsl::alias_table<> table(population.begin(), population.end(),
+                              trsl::weight_accessor<double, PickCountParticle>());
+    // With uniform weights, bucket i can only return i.
+    for (unsigned k = 0; k < N_DRAWS; ++k)
+    {
+      double u = (k + .5) / N_DRAWS;
+      if (table.draw(u) != size_t(u * POPULATION_SIZE))
+        TRSL_TEST_FAILURE;
+    }
+
+    std::vector<size_t> indices;
+    table.draw(N_DRAWS, std::back_inserter(indices));
+    if (indices.size() != N_DRAWS)
+      TRSL_TEST_FAILURE;
+  }
+
+  // ---------------------------------------------------- //
+  // Test 3: bad parameters ----------------------------- //
+  // ---------------------------------------------------- //
+  {
+    ParticleArray population;
+    try
+    {
+      trsl::alias_table<> table(population.begin(), population.end(),
+                                accessor(&PickCountParticle::getWeight));
+      TRSL_TEST_FAILURE;
+    }
+    catch (trsl::bad_parameter_value &e) {}
+
+    population.push_back(PickCountParticle(0, 0, 0));
+    try
+    {
+      trsl::alias_table<> table(population.begin(), population.end(),
+                                accessor(&PickCountParticle::getWeight));
+      TRSL_TEST_FAILURE;
+    }
+    catch (trsl::bad_parameter_value &e) {}
+  }
+
+  return 0;
+}
@@ -0,0 +1,96 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <trsl/double_buffered_population.hpp>
+#include <tests/common.hpp>
+using namespace trsl::test;
+
+int main()
+{
+  // BSD has two different random generators
+  unsigned long random_seed = time(NULL)*getpid();
+  srandom(random_seed);
+  srand(random_seed);
+
+  typedef trsl::mp_weight_accessor<double, PickCountParticle> accessor;
+  typedef trsl::double_buffered_population<PickCountParticle> population_type;
+
+  const size_t POPULATION_SIZE = 1000;
+  const unsigned N_GENERATIONS = 20;
+
+  population_type population(POPULATION_SIZE,
+                             accessor(&PickCountParticle::getWeight));
+  std::vector<PickCountParticle> initial;
+  generatePopulation(POPULATION_SIZE, initial, false);
+  double totalWeight = 0;
+  for (size_t i = 0; i < POPULATION_SIZE; ++i)
+  {
+    population.add(initial[i]);
+    totalWeight += initial[i].getWeight();
+  }
+
+  // ---------------------------------------------------- //
+  // Test 1: total weight ------------------------------- //
+  // ---------------------------------------------------- //
+  if (population.size() != POPULATION_SIZE ||
+      ! (std::fabs(population.total_weight() - totalWeight) <= 1e-9) )
+  {
+    TRSL_TEST_FAILURE;
+    std::cout << TRSL_NVP(population.total_weight()) << "\n"
+              << TRSL_NVP(totalWeight) << std::endl;
+  }
+
+  // ---------------------------------------------------- //
+  // Test 2: generations alternate between two buffers -- //
+  // ---------------------------------------------------- //
+  const PickCountParticle* buffers[2] = { &population[0], 0 };
+  for (unsigned g = 0; g < N_GENERATIONS; ++g)
+  {
+    population.resample(POPULATION_SIZE);
+    if (population.next_size() != POPULATION_SIZE)
+    {
+      TRSL_TEST_FAILURE;
+      std::cout << TRSL_NVP(population.next_size()) << std::endl;
+    }
+    double nextWeight = 0;
+    for (population_type::const_sample_iterator si =
+           population.sample_begin(0); si != population.sample_end(); ++si)
+      TRSL_TEST_FAILURE;
+    population.swap_generation();
+    if (population.next_size() != 0)
+      TRSL_TEST_FAILURE;
+
+    for (population_type::const_iterator i = population.begin();
+         i != population.end(); ++i)
+      nextWeight += i->getWeight();
+    if (! (std::fabs(population.total_weight() - nextWeight) <= 1e-9) )
+      TRSL_TEST_FAILURE;
+
+    if (g == 0)
+      buffers[1] = &population[0];
+    else if (&population[0] != buffers[(g+1) % 2])
+      TRSL_TEST_FAILURE;
+
+    // Reweight a few elements.
+    for (size_t i = 0; i < POPULATION_SIZE; i += 10)
+    {
+      PickCountParticle p = population[i];
+      p.setWeight(double(rand())/RAND_MAX);
+      population.replace(i, p);
+    }
+  }
+  if (population.capacity() < POPULATION_SIZE)
+    TRSL_TEST_FAILURE;
+
+  // ---------------------------------------------------- //
+  // Test 3: clear -------------------------------------- //
+  // ---------------------------------------------------- //
+  population.clear();
+  if (population.size() != 0 || population.total_weight() != 0 ||
+      population.capacity() < POPULATION_SIZE)
+    TRSL_TEST_FAILURE;
+
+  return 0;
+}
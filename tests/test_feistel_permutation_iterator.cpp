@@ -0,0 +1,231 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <trsl/feistel_permutation_iterator.hpp>
+#include <trsl/is_picked_systematic.hpp>
+#include <trsl/xoshiro256.hpp>
+#include <tests/common.hpp>
+#include <set>
+#include <boost/iterator/counting_iterator.hpp>
+using namespace trsl::test;
+
+// Returns the largest integer of [0,n[.
+struct largest_int
+{
+  std::ptrdiff_t operator()(std::ptrdiff_t n) { return n - 1; }
+};
+
+int main()
+{
+  // BSD has two different random generators
+  unsigned long random_seed = time(NULL)*getpid();
+  srandom(random_seed);
+  srand(random_seed);
+
+  typedef std::vector<PickCountParticle> ParticleArray;
+
+  // ---------------------------------------------------- //
+  // Test 1: permutation -------------------------------- //
+  // ---------------------------------------------------- //
+  {
+    typedef std::vector<size_t> IndexArray;
+    typedef trsl::feistel_reorder_iterator<
+      IndexArray::const_iterator> permutation_iterator;
+
+    //------------------------------------------------//
+    // Test 1a: bijection                             //
+    //------------------------------------------------//
+    {
+      const size_t SIZES[] = { 0, 1, 2, 3, 5, 16, 17, 1000, 4097 };
+      for (size_t s = 0; s < sizeof(SIZES) / sizeof(SIZES[0]); ++s)
+      {
+        IndexArray identity(SIZES[s]);
+        for (size_t i = 0; i < SIZES[s]; ++i)
+          identity[i] = i;
+        IndexArray const& const_identity = identity;
+        permutation_iterator sb = trsl::feistel_permutation_iterator
+          (const_identity.begin(), const_identity.end());
+        std::vector<bool> seen(SIZES[s], false);
+        size_t count = 0;
+        for (permutation_iterator si = sb, se = sb.end(); si != se; ++si)
+        {
+          if (seen.at(*si) || *si != si.index())
+            TRSL_TEST_FAILURE;
+          seen.at(*si) = true;
+          count++;
+        }
+        if (! (count == SIZES[s]) )
+        {
+          TRSL_TEST_FAILURE;
+          std::cout << TRSL_NVP(count) << " " << TRSL_NVP(SIZES[s]) << std::endl;
+        }
+      }
+    }
+
+    //------------------------------------------------//
+    // Test 1b: keys, copies and random access        //
+    //------------------------------------------------//
+    {
+      const size_t POPULATION_SIZE = 1000;
+      const size_t SAMPLE_SIZE = 100;
+      IndexArray identity(POPULATION_SIZE);
+      for (size_t i = 0; i < POPULATION_SIZE; ++i)
+        identity[i] = i;
+      IndexArray const& const_identity = identity;
+
+      trsl::xoshiro256 g(random_seed), h(random_seed);
+      permutation_iterator p = trsl::feistel_permutation_iterator
+        (const_identity.begin(), const_identity.end(), SAMPLE_SIZE, g);
+      permutation_iterator q = trsl::feistel_permutation_iterator
+        (const_identity.begin(), const_identity.end(), SAMPLE_SIZE, h);
+      permutation_iterator r = trsl::feistel_permutation_iterator
+        (const_identity.begin(), const_identity.end(), SAMPLE_SIZE, h);
+      if (! (std::distance(p, p.end()) == std::ptrdiff_t(SAMPLE_SIZE)) )
+        TRSL_TEST_FAILURE;
+      size_t sameAsNextKey = 0;
+      permutation_iterator copy = p;
+      for (size_t i = 0; i < SAMPLE_SIZE; ++i, ++p)
+      {
+        if (! (p.index() == q[i] && p.index() == copy[i] &&
+               p.index() == (copy.end() - (SAMPLE_SIZE - i)).index()) )
+          TRSL_TEST_FAILURE;
+        if (p.index() == r[i])
+          sameAsNextKey++;
+      }
+      if (! (sameAsNextKey < SAMPLE_SIZE / 2) )
+        TRSL_TEST_FAILURE;
+    }
+
+    //------------------------------------------------//
+    // Test 1c: position distribution                 //
+    //------------------------------------------------//
+    {
+      // Over many keys, each element should appear at each position
+      // with probability 1/n.
+      const size_t POPULATION_SIZE = 10;
+      const unsigned N_ROUNDS = 200000;
+      IndexArray identity(POPULATION_SIZE);
+      for (size_t i = 0; i < POPULATION_SIZE; ++i)
+        identity[i] = i;
+      IndexArray const& const_identity = identity;
+      std::vector<unsigned> counts(POPULATION_SIZE * POPULATION_SIZE, 0);
+      for (unsigned round = 0; round < N_ROUNDS; ++round)
+      {
+        permutation_iterator sb = trsl::feistel_permutation_iterator
+          (const_identity.begin(), const_identity.end());
+        for (size_t i = 0; i < POPULATION_SIZE; ++i)
+          counts[i * POPULATION_SIZE + sb[i]]++;
+      }
+      for (size_t c = 0; c < counts.size(); ++c)
+        if (! (std::fabs(double(counts[c]) * POPULATION_SIZE / N_ROUNDS - 1) < 5e-2) )
+        {
+          TRSL_TEST_FAILURE;
+          std::cout << "Position " << c / POPULATION_SIZE
+                    << ", element " << c % POPULATION_SIZE
+                    << ": " << counts[c] << std::endl;
+        }
+    }
+
+    //------------------------------------------------//
+    // Test 1d: huge population                       //
+    //------------------------------------------------//
+    {
+      // Neither the population nor the permutation is stored.
+      typedef boost::counting_iterator<size_t> counting_iterator;
+      const size_t HUGE_SIZE = size_t(2000000000);
+      const size_t SAMPLE_SIZE = 1000;
+      trsl::feistel_reorder_iterator<counting_iterator> sb =
+        trsl::feistel_permutation_iterator
+        (counting_iterator(0), counting_iterator(HUGE_SIZE));
+      std::set<size_t> sample;
+      for (size_t i = 0; i < SAMPLE_SIZE; ++i)
+      {
+        size_t index = (sb + i).index();
+        if (! (index < HUGE_SIZE) )
+          TRSL_TEST_FAILURE;
+        sample.insert(index);
+      }
+      if (! (sample.size() == SAMPLE_SIZE) )
+        TRSL_TEST_FAILURE;
+      if (! (sb.end() - sb == std::ptrdiff_t(HUGE_SIZE)) )
+        TRSL_TEST_FAILURE;
+    }
+
+    //------------------------------------------------//
+    // Test 1e: keys span 64 bits                     //
+    //------------------------------------------------//
+    {
+      largest_int rng;
+      if (! (trsl::detail::random_uint64(rng) == ~boost::uint64_t(0)) )
+        TRSL_TEST_FAILURE;
+    }
+  }
+
+  // ---------------------------------------------------- //
+  // Test 2: ppfilter_iterator -------------------------- //
+  // ---------------------------------------------------- //
+  {
+    const size_t POPULATION_SIZE = 100;
+    const size_t SAMPLE_SIZE = 5;
+
+    typedef trsl::is_picked_systematic<PickCountParticle> is_picked;
+    typedef trsl::feistel_ppfilter_iterator<
+      is_picked, ParticleArray::iterator>::type sample_iterator;
+    typedef trsl::feistel_ppfilter_iterator<
+      is_picked, ParticleArray::const_iterator>::type const_sample_iterator;
+
+    ParticleArray population;
+    generatePopulation(POPULATION_SIZE, population);
+
+    //------------------------------------------------//
+    // Test 2a: begin() copy, const conversion        //
+    //------------------------------------------------//
+    {
+      is_picked predicate(SAMPLE_SIZE, 1.0, &PickCountParticle::getWeight);
+      sample_iterator sb(predicate, population.begin(), population.end());
+      const_sample_iterator csb = sb;
+      std::vector<size_t> first, second;
+      for (sample_iterator si = sb, se = sb.end(); si != se; ++si)
+        first.push_back(si.index());
+      for (const_sample_iterator si = csb.begin(), se = csb.end(); si != se; ++si)
+        second.push_back(si.index());
+      if (first.size() != SAMPLE_SIZE || first != second)
+      {
+        TRSL_TEST_FAILURE;
+        std::cout << TRSL_NVP(first.size()) << "\n" << TRSL_NVP(second.size()) << std::endl;
+      }
+    }
+
+    //------------------------------------------------//
+    // Test 2b: sampling coherency with probabilities //
+    //------------------------------------------------//
+    {
+      const unsigned N_ROUNDS = 200000;
+      for (unsigned round = 0; round < N_ROUNDS; round++)
+      {
+        is_picked predicate(SAMPLE_SIZE, 1.0, &PickCountParticle::getWeight);
+        for (sample_iterator
+               si = sample_iterator(predicate, population.begin(), population.end()),
+               se = si.end(); si != se; ++si)
+          si->pick();
+      }
+      for (ParticleArray::iterator e = population.begin();
+           e != population.end(); e++)
+      {
+        double pickProp = double(e->getPickCount()) / (N_ROUNDS * SAMPLE_SIZE);
+        if (! ( std::fabs(POPULATION_SIZE * e->getWeight() -
+                          POPULATION_SIZE * pickProp) <= 1e-1) )
+        {
+          TRSL_TEST_FAILURE;
+          std::cout << "Element " << std::distance(population.begin(), e)
+                    << ": weight = " << e->getWeight()
+                    << ", pickp = " << pickProp << std::endl;
+        }
+      }
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,157 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <trsl/importance_sample_iterator.hpp>
+#include <tests/common.hpp>
+using namespace trsl::test;
+
+// The population is assumed to be drawn from a density stored as the
+// particle weight, and resampled to follow a density proportional to
+// x.
+struct target_accessor
+{
+  double operator()(const PickCountParticle& p) const
+    {
+      return p.getX();
+    }
+};
+
+typedef trsl::mp_weight_accessor<double, PickCountParticle> proposal_accessor;
+
+int main()
+{
+  // BSD has two different random generators
+  unsigned long random_seed = time(NULL)*getpid();
+  srandom(random_seed);
+  srand(random_seed);
+
+  typedef std::list<PickCountParticle> ParticleArray;
+
+  typedef trsl::importance_sample_iterator<
+    ParticleArray::const_iterator,
+    target_accessor, proposal_accessor
+  > sample_iterator;
+
+  const proposal_accessor proposal(&PickCountParticle::getWeight);
+
+  // ---------------------------------------------------- //
+  // Test 1: sample size, restart ----------------------- //
+  // ---------------------------------------------------- //
+  {
+    const size_t POPULATION_SIZE = 100000;
+    const size_t SAMPLE_SIZE = 1000;
+
+    ParticleArray population;
+    generatePopulation(POPULATION_SIZE, population);
+    ParticleArray const& const_pop = population;
+
+    sample_iterator sb(const_pop.begin(), const_pop.end(), SAMPLE_SIZE,
+                       target_accessor(), proposal);
+    std::vector<PickCountParticle> sample;
+    for (sample_iterator si = sb; si != sb.end(); ++si)
+      sample.push_back(*si);
+    if (sample.size() != SAMPLE_SIZE)
+    {
+      TRSL_TEST_FAILURE;
+      std::cout << TRSL_NVP(sample.size()) << "\n" << TRSL_NVP(SAMPLE_SIZE) << std::endl;
+    }
+
+    // begin() goes through the same sample again.
+    size_t i = 0;
+    for (sample_iterator si = sb.begin(); si != sb.end(); ++si, ++i)
+      if (i >= sample.size() || si->getX() != sample[i].getX())
+        TRSL_TEST_FAILURE;
+    if (i != SAMPLE_SIZE)
+      TRSL_TEST_FAILURE;
+  }
+
+  // ---------------------------------------------------- //
+  // Test 2: sampling coherency with importance weights - //
+  // ---------------------------------------------------- //
+  {
+    const size_t POPULATION_SIZE = 100;
+    const size_t SAMPLE_SIZE = 1000;
+    const size_t N_ROUNDS = 200;
+
+    ParticleArray population;
+    generatePopulation(POPULATION_SIZE, population);
+    // Elements with a null proposal density should never be picked.
+    population.front().setWeight(0);
+
+    double totalWeight = 0;
+    for (ParticleArray::const_iterator e = population.begin();
+         e != population.end(); ++e)
+      if (e->getWeight() > 0)
+        totalWeight += e->getX() / e->getWeight();
+
+    for (size_t round = 0; round < N_ROUNDS; ++round)
+    {
+      // Alternate between known and computed population weights.
+      sample_iterator si = (round % 2 == 0) ?
+        sample_iterator(population.begin(), population.end(), SAMPLE_SIZE,
+                        totalWeight, target_accessor(), proposal) :
+        sample_iterator(population.begin(), population.end(), SAMPLE_SIZE,
+                        target_accessor(), proposal);
+      size_t size = 0;
+      for (; si != si.end(); ++si, ++size)
+      {
+        // Elements are picked through a const iterator; find them back.
+        for (ParticleArray::iterator e = population.begin();
+             e != population.end(); ++e)
+          if (&*e == &*si)
+          {
+            e->pick();
+            break;
+          }
+      }
+      if (size != SAMPLE_SIZE)
+        TRSL_TEST_FAILURE;
+    }
+
+    size_t i = 0;
+    for (ParticleArray::const_iterator e = population.begin();
+         e != population.end(); ++e, ++i)
+    {
+      double weight = (e->getWeight() > 0) ?
+        e->getX() / e->getWeight() / totalWeight : 0;
+      double pickProp = double(e->getPickCount()) / (N_ROUNDS * SAMPLE_SIZE);
+      if (! ( std::fabs(POPULATION_SIZE * weight -
+                        POPULATION_SIZE * pickProp) <= 1e-1) ||
+          (weight == 0 && e->getPickCount() != 0))
+      {
+        TRSL_TEST_FAILURE;
+        std::cout << "Element " << i
+                  << ": weight = " << int(100 * POPULATION_SIZE *
+                                          weight) << "%"
+                  << ", pickp = " << int(100 * POPULATION_SIZE *
+                                         pickProp) << "%"
+                  << std::endl;
+      }
+    }
+  }
+
+  // ---------------------------------------------------- //
+  // Test 3: bad parameters ----------------------------- //
+  // ---------------------------------------------------- //
+  {
+    ParticleArray population;
+    generatePopulation(10, population);
+    for (ParticleArray::iterator e = population.begin();
+         e != population.end(); ++e)
+      e->setWeight(0);
+
+    bool thrown = false;
+    try {
+      sample_iterator si(population.begin(), population.end(), 10,
+                         target_accessor(), proposal);
+    } catch (trsl::bad_parameter_value &e) {
+      thrown = true;
+    }
+    if (!thrown)
+      TRSL_TEST_FAILURE;
+  }
+
+  return 0;
+}
@@ -0,0 +1,150 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <trsl/index_workspace.hpp>
+#include <trsl/random_permutation_iterator.hpp>
+#include <trsl/sort_iterator.hpp>
+#include <trsl/xoshiro256.hpp>
+#include <tests/common.hpp>
+using namespace trsl::test;
+
+class ParticleXComparator
+{
+public:
+  bool operator() (const PickCountParticle& p1, const PickCountParticle& p2) const
+    {
+      return p1.getX() < p2.getX();
+    }
+};
+
+int main()
+{
+  // BSD has two different random generators
+  unsigned long random_seed = time(NULL)*getpid();
+  srandom(random_seed);
+  srand(random_seed);
+
+  typedef std::vector<PickCountParticle> ParticleArray;
+  typedef trsl::reorder_iterator
+    <ParticleArray::const_iterator> permutation_iterator;
+
+  const size_t POPULATION_SIZE = 10000;
+  const size_t SAMPLE_SIZE = 100;
+  const unsigned N_ROUNDS = 100;
+
+  ParticleArray population;
+  generatePopulation(POPULATION_SIZE, population);
+  ParticleArray const& const_pop = population;
+
+  // ---------------------------------------------------- //
+  // Test 1: random_permutation_iterator ---------------- //
+  // ---------------------------------------------------- //
+  {
+    //------------------------------------------------//
+    // Test 1a: arrays are recycled                   //
+    //------------------------------------------------//
+    trsl::index_workspace<> workspace;
+    const size_t* data = 0;
+    for (unsigned round = 0; round < N_ROUNDS; round++)
+    {
+      permutation_iterator sb = trsl::random_permutation_iterator
+        (const_pop.begin(), const_pop.end(), workspace);
+      if (round == 0)
+        data = &*sb.base();
+      else if (! (&*sb.base() == data) )
+      {
+        TRSL_TEST_FAILURE;
+        break;
+      }
+      std::vector<bool> seen(POPULATION_SIZE, false);
+      size_t count = 0;
+      for (permutation_iterator si = sb, se = sb.end(); si != se; ++si, ++count)
+      {
+        if (seen[si.index()])
+          TRSL_TEST_FAILURE;
+        seen[si.index()] = true;
+      }
+      if (! (count == POPULATION_SIZE) )
+        TRSL_TEST_FAILURE;
+    }
+    if (! (workspace.size() == 1) )
+      TRSL_TEST_FAILURE;
+
+    //------------------------------------------------//
+    // Test 1b: arrays in use are not recycled        //
+    //------------------------------------------------//
+    permutation_iterator p = trsl::random_permutation_iterator
+      (const_pop.begin(), const_pop.end(), SAMPLE_SIZE, workspace);
+    std::vector<size_t> indices;
+    for (permutation_iterator pi = p; pi != p.end(); ++pi)
+      indices.push_back(pi.index());
+    permutation_iterator q = trsl::random_permutation_iterator
+      (const_pop.begin(), const_pop.end(), workspace);
+    if (! (workspace.size() == 2) )
+      TRSL_TEST_FAILURE;
+    if (! (std::distance(p, p.end()) == std::ptrdiff_t(SAMPLE_SIZE)) ||
+        ! (std::distance(q, q.end()) == std::ptrdiff_t(POPULATION_SIZE)) )
+      TRSL_TEST_FAILURE;
+    for (size_t i = 0; i < SAMPLE_SIZE; ++i)
+      if (! ((p + i).index() == indices.at(i)) )
+        TRSL_TEST_FAILURE;
+
+    // The arrays outlive the workspace.
+    workspace.clear();
+    for (size_t i = 0; i < SAMPLE_SIZE; ++i)
+      if (! ((p + i).index() == indices.at(i)) )
+        TRSL_TEST_FAILURE;
+
+    //------------------------------------------------//
+    // Test 1c: user generator, 32-bit index type     //
+    //------------------------------------------------//
+    typedef trsl::reorder_iterator
+      <ParticleArray::const_iterator, boost::uint32_t> compact_iterator;
+    trsl::index_workspace<boost::uint32_t> compact_workspace;
+    trsl::xoshiro256 g(random_seed), h(random_seed);
+    compact_iterator c = trsl::random_permutation_iterator
+      (const_pop.begin(), const_pop.end(), g, compact_workspace);
+    permutation_iterator d = trsl::random_permutation_iterator
+      (const_pop.begin(), const_pop.end(), h);
+    for (; c != c.end(); ++c, ++d)
+      if (! (c.index() == d.index()) )
+      {
+        TRSL_TEST_FAILURE;
+        break;
+      }
+  }
+
+  // ---------------------------------------------------- //
+  // Test 2: sort_iterator ------------------------------ //
+  // ---------------------------------------------------- //
+  {
+    trsl::index_workspace<> workspace;
+    for (unsigned round = 0; round < 3; round++)
+    {
+      permutation_iterator sb = trsl::sort_iterator
+        (const_pop.begin(), const_pop.end(), ParticleXComparator(),
+         SAMPLE_SIZE, workspace);
+      permutation_iterator rb = trsl::sort_iterator
+        (const_pop.begin(), const_pop.end(), ParticleXComparator(),
+         SAMPLE_SIZE);
+      if (! (std::distance(sb, sb.end()) == std::ptrdiff_t(SAMPLE_SIZE)) )
+        TRSL_TEST_FAILURE;
+      for (; sb != sb.end(); ++sb, ++rb)
+        if (! (sb->getX() == rb->getX()) )
+        {
+          TRSL_TEST_FAILURE;
+          break;
+        }
+    }
+    permutation_iterator sb = trsl::sort_iterator
+      (const_pop.begin(), const_pop.end(), workspace);
+    if (! (std::distance(sb, sb.end()) == std::ptrdiff_t(POPULATION_SIZE)) )
+      TRSL_TEST_FAILURE;
+    if (! (workspace.size() == 1) )
+      TRSL_TEST_FAILURE;
+  }
+
+  return 0;
+}
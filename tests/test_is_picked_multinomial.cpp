@@ -0,0 +1,230 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <trsl/is_picked_multinomial.hpp>
+#include <trsl/ppfilter_iterator.hpp>
+#include <tests/common.hpp>
+using namespace trsl::test;
+
+int main()
+{
+  // BSD has two different random generators
+  unsigned long random_seed = time(NULL)*getpid();
+  srandom(random_seed);
+  srand(random_seed);
+
+  typedef std::list<PickCountParticle> ParticleArray;
+
+  // ---------------------------------------------------- //
+  // Test 1: large population --------------------------- //
+  // ---------------------------------------------------- //
+  {
+    const size_t POPULATION_SIZE = 1000000;
+    const size_t SAMPLE_SIZE = 1000;
+
+    // Type definitions, once and for all.
+
+    typedef trsl::is_picked_multinomial<PickCountParticle> is_picked;
+
+    typedef trsl::persistent_filter_iterator
+      <is_picked, ParticleArray::const_iterator> sample_iterator;
+
+    //-----------------------//
+    // Generate a population //
+    //-----------------------//
+
+    ParticleArray population;
+    generatePopulation(POPULATION_SIZE, population);
+    ParticleArray const& const_pop = population;
+
+    //------------------------------//
+    // Test 1a: correct sample size //
+    //------------------------------//
+    {
+      ParticleArray sample;
+      // Create the multinomial sampling functor.
+      is_picked predicate(SAMPLE_SIZE, 1.0, &PickCountParticle::getWeight);
+
+      sample_iterator sb = sample_iterator(predicate, const_pop.begin(), const_pop.end());
+      sample_iterator se = sample_iterator(predicate, const_pop.end(),   const_pop.end());
+      for (sample_iterator si = sb; si != se; ++si)
+      {
+        sample.push_back(*si);
+      }
+      if (! (sample.size() == SAMPLE_SIZE) )
+      {
+        TRSL_TEST_FAILURE;
+        std::cout << TRSL_NVP(sample.size()) << "\n" << TRSL_NVP(SAMPLE_SIZE) << std::endl;
+      }
+    }
+
+    //--------------------------------//
+    // Test 1b: deterministic picking //
+    //--------------------------------//
+    {
+      is_picked predicate1(SAMPLE_SIZE, 1.0, 42, &PickCountParticle::getWeight);
+      is_picked predicate2(SAMPLE_SIZE, 1.0, 42, &PickCountParticle::getWeight);
+
+      sample_iterator
+        s1 = sample_iterator(predicate1, const_pop.begin(), const_pop.end()),
+        s2 = sample_iterator(predicate2, const_pop.begin(), const_pop.end()),
+        se = sample_iterator(predicate1, const_pop.end(),   const_pop.end());
+      for (; s1 != se; ++s1, ++s2)
+      {
+        if (s2 == se || s1 != s2)
+        {
+          TRSL_TEST_FAILURE;
+          break;
+        }
+      }
+    }
+  }
+
+  // ---------------------------------------------------- //
+  // Test 2: small population --------------------------- //
+  // ---------------------------------------------------- //
+  {
+    const size_t POPULATION_SIZE = 100;
+    const size_t SAMPLE_SIZE = 5;
+
+    // Type definitions, once and for all.
+
+    typedef trsl::is_picked_multinomial<PickCountParticle> is_picked;
+
+    typedef trsl::persistent_filter_iterator
+      <is_picked, std::vector<PickCountParticle>::iterator> sample_iterator;
+
+    //-----------------------//
+    // Generate a population //
+    //-----------------------//
+
+    std::vector<PickCountParticle> population;
+    generatePopulation(POPULATION_SIZE, population);
+
+    //------------------------------------------------//
+    // Test 2a: sampling coherency with probabilities //
+    //------------------------------------------------//
+    {
+      // Test 2a checks that, after repeating sampling many times,
+      // element pick proportions correspond to element weights.
+      const unsigned N_ROUNDS = 1000000;
+      unsigned pickCount = 0;
+
+      for (unsigned round = 0; round < N_ROUNDS; round++)
+      {
+        // Create the multinomial sampling functor.
+        is_picked predicate(SAMPLE_SIZE, 1.0, round, &PickCountParticle::getWeight);
+
+        sample_iterator sb = sample_iterator(predicate,
+                                             population.begin(),
+                                             population.end());
+        sample_iterator se = sample_iterator(predicate,
+                                             population.end(),
+                                             population.end());
+        for (sample_iterator si = sb; si != se; ++si)
+        {
+          si->pick();
+          pickCount++;
+        }
+      }
+      if (! (pickCount == N_ROUNDS * SAMPLE_SIZE) )
+      {
+        TRSL_TEST_FAILURE;
+        std::cout << TRSL_NVP(N_ROUNDS) << std::endl
+                  << TRSL_NVP(SAMPLE_SIZE) << std::endl
+                  << TRSL_NVP(pickCount) << std::endl;
+      }
+      for (std::vector<PickCountParticle>::iterator e = population.begin();
+           e != population.end(); e++)
+      {
+        double pickProp = double(e->getPickCount()) / (N_ROUNDS * SAMPLE_SIZE);
+        if (! ( std::fabs(POPULATION_SIZE * e->getWeight() -
+                          POPULATION_SIZE * pickProp) <= 1e-1) ||
+            TEST_VERBOSE > 0)
+        {
+          if (! ( std::fabs(POPULATION_SIZE * e->getWeight() -
+                            POPULATION_SIZE * pickProp) <= 1e-1) )
+            TRSL_TEST_FAILURE;
+          std::cout << "Element " << std::distance(population.begin(), e)
+                    << ": weight = " << int(100 * POPULATION_SIZE *
+                                            e->getWeight()) << "%"
+                    << ", pickp = " << int(100 * POPULATION_SIZE *
+                                           pickProp) << "%"
+                    << std::endl;
+        }
+      }
+    }
+  }
+
+  // ---------------------------------------------------- //
+  // Test 3: sample larger than population -------------- //
+  // ---------------------------------------------------- //
+  {
+    const size_t POPULATION_SIZE = 800;
+    const size_t SAMPLE_SIZE = 1000;
+
+    // Type definitions, once and for all.
+
+    typedef trsl::is_picked_multinomial<PickCountParticle> is_picked;
+
+    typedef trsl::ppfilter_iterator
+      <is_picked, std::vector<PickCountParticle>::const_iterator> sample_iterator;
+
+    //-----------------------//
+    // Generate a population //
+    //-----------------------//
+
+    std::vector<PickCountParticle> population;
+    generatePopulation(POPULATION_SIZE, population);
+    std::vector<PickCountParticle> const& const_pop = population;
+
+    //------------------------------------------//
+    // Test 3a: ppfilter_iterator, begin() copy //
+    //------------------------------------------//
+    {
+      is_picked predicate(SAMPLE_SIZE, 1.0, &PickCountParticle::getWeight);
+
+      sample_iterator sb = sample_iterator(predicate, const_pop.begin(), const_pop.end());
+      sample_iterator se = sb.end();
+
+      std::vector<size_t> first, second;
+      for (sample_iterator si = sb; si != se; ++si)
+        first.push_back(si.index());
+      for (sample_iterator si = sb.begin(); si != se; ++si)
+        second.push_back(si.index());
+
+      if (first.size() != SAMPLE_SIZE || first != second)
+      {
+        TRSL_TEST_FAILURE;
+        std::cout << TRSL_NVP(first.size()) << "\n" << TRSL_NVP(second.size()) << std::endl;
+      }
+    }
+
+    //------------------------//
+    // Test 3b: is_first_pick //
+    //------------------------//
+    {
+      is_picked predicate(SAMPLE_SIZE, 1.0, &PickCountParticle::getWeight);
+
+      sample_iterator sb = sample_iterator(predicate, const_pop.begin(), const_pop.end());
+      sample_iterator se = sb.end();
+      int duplicates = 0;
+      for (sample_iterator
+             si = sb,
+             previous = sb; si != se; previous = si++)
+      {
+        bool repeated = si != previous && si.index() == previous.index();
+        if (repeated)
+          duplicates++;
+        if (repeated == is_first_pick(si))
+          TRSL_TEST_FAILURE;
+      }
+      if (duplicates == 0)
+        TRSL_TEST_FAILURE;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,209 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <trsl/is_picked_systematic_integer.hpp>
+#include <trsl/persistent_filter_iterator.hpp>
+#include <trsl/systematic_sample.hpp>
+#include <tests/common.hpp>
+using namespace trsl::test;
+
+namespace {
+
+  struct Bin
+  {
+    boost::uint64_t count;
+    double getCount() const { return double(count); }
+  };
+
+}
+
+int main()
+{
+  // BSD has two different random generators
+  unsigned long random_seed = time(NULL)*getpid();
+  srandom(random_seed);
+  srand(random_seed);
+
+  boost::mt19937 rng((unsigned)random_seed);
+  boost::uniform_01<boost::mt19937> uni_dist(rng);
+
+  // ---------------------------------------------------- //
+  // Test 1: histogram ---------------------------------- //
+  // ---------------------------------------------------- //
+  {
+    typedef trsl::member_weight_accessor<
+      boost::uint64_t, Bin, &Bin::count> accessor;
+    typedef trsl::is_picked_systematic_integer<
+      Bin, boost::uint64_t, accessor> is_picked;
+    typedef trsl::persistent_filter_iterator<
+      is_picked, std::vector<Bin>::const_iterator> sample_iterator;
+
+    const size_t POPULATION_SIZE = 10000;
+    const size_t SAMPLE_SIZES[] = { 0, 1, 17, 5000, 100000 };
+    const unsigned N_ROUNDS = 20;
+
+    std::vector<Bin> population(POPULATION_SIZE);
+    boost::uint64_t totalWeight = 0;
+    for (size_t i = 0; i < POPULATION_SIZE; ++i)
+    {
+      population[i].count = (rand() % 3 == 0) ? 0 : rand() % 100;
+      totalWeight += population[i].count;
+    }
+    std::vector<Bin> const& const_pop = population;
+
+    size_t mismatches = 0;
+    for (size_t s = 0; s < sizeof(SAMPLE_SIZES)/sizeof(SAMPLE_SIZES[0]); ++s)
+      for (unsigned round = 0; round < N_ROUNDS; ++round)
+      {
+        const size_t sampleSize = SAMPLE_SIZES[s];
+        const double u = uni_dist();
+
+        std::vector<size_t> counts(POPULATION_SIZE, 0);
+        is_picked predicate(sampleSize, totalWeight, u);
+        sample_iterator sb(predicate, const_pop.begin(), const_pop.end());
+        sample_iterator se(predicate, const_pop.end(), const_pop.end());
+        size_t size = 0;
+        for (sample_iterator si = sb; si != se; ++si)
+        {
+          counts[si.base() - const_pop.begin()]++;
+          ++size;
+        }
+
+        //------------------------------------------------//
+        // Test 1a: exact sample size                     //
+        //------------------------------------------------//
+        if (size != sampleSize)
+        {
+          TRSL_TEST_FAILURE;
+          std::cout << TRSL_NVP(size) << "\n" << TRSL_NVP(sampleSize) << std::endl;
+        }
+
+        //------------------------------------------------//
+        // Test 1b: batch counts match the predicate      //
+        //------------------------------------------------//
+        std::vector<size_t> batch;
+        trsl::systematic_offspring_integer(const_pop.begin(), const_pop.end(),
+                                           sampleSize, totalWeight, u,
+                                           accessor(),
+                                           std::back_inserter(batch));
+        if (batch != counts)
+          TRSL_TEST_FAILURE;
+
+        //------------------------------------------------//
+        // Test 1c: floating-point path, up to rounding   //
+        //------------------------------------------------//
+        std::vector<size_t> real;
+        trsl::systematic_offspring(const_pop.begin(), const_pop.end(),
+                                   sampleSize, double(totalWeight), u,
+                                   trsl::const_method_weight_accessor<
+                                     double, Bin, &Bin::getCount>(),
+                                   std::back_inserter(real));
+        for (size_t i = 0; i < POPULATION_SIZE; ++i)
+          if (real[i] != counts[i])
+            mismatches++;
+      }
+    // A rounding error moves one pick between two elements.
+    if (mismatches > 2 * N_ROUNDS)
+    {
+      TRSL_TEST_FAILURE;
+      std::cout << TRSL_NVP(mismatches) << std::endl;
+    }
+  }
+
+  // ---------------------------------------------------- //
+  // Test 2: fixed-point weights ------------------------ //
+  // ---------------------------------------------------- //
+  {
+    typedef std::vector<PickCountParticle> ParticleArray;
+    typedef trsl::fixed_point_weight_accessor<
+      boost::uint64_t, PickCountParticle,
+      trsl::mp_weight_accessor<double, PickCountParticle> > accessor;
+    typedef trsl::is_picked_systematic_integer<
+      PickCountParticle, boost::uint64_t, accessor> is_picked;
+    typedef trsl::persistent_filter_iterator<
+      is_picked, ParticleArray::const_iterator> sample_iterator;
+
+    const size_t POPULATION_SIZE = 100000;
+    const size_t SAMPLE_SIZE = 33333;
+
+    ParticleArray population;
+    generatePopulation(POPULATION_SIZE, population);
+    ParticleArray const& const_pop = population;
+
+    accessor wac(4294967296.0, &PickCountParticle::getWeight);
+    boost::uint64_t totalWeight = 0;
+    for (size_t i = 0; i < POPULATION_SIZE; ++i)
+      totalWeight += wac(population[i]);
+
+    is_picked predicate(SAMPLE_SIZE, totalWeight, wac);
+    sample_iterator sb(predicate, const_pop.begin(), const_pop.end());
+    sample_iterator se(predicate, const_pop.end(), const_pop.end());
+    size_t size = 0;
+    for (sample_iterator si = sb; si != se; ++si)
+      ++size;
+    if (size != SAMPLE_SIZE)
+    {
+      TRSL_TEST_FAILURE;
+      std::cout << TRSL_NVP(size) << std::endl;
+    }
+  }
+
+  // ---------------------------------------------------- //
+  // Test 3: bad parameters ----------------------------- //
+  // ---------------------------------------------------- //
+  {
+    typedef trsl::is_picked_systematic_integer<Bin> is_picked;
+    bool thrown = false;
+    try {
+      is_picked p(10, std::numeric_limits<boost::uint64_t>::max() / 4);
+    } catch (trsl::bad_parameter_value &e) {
+      thrown = true;
+    }
+    if (!thrown)
+      TRSL_TEST_FAILURE;
+    thrown = false;
+    try {
+      is_picked p(10, 0);
+    } catch (trsl::bad_parameter_value &e) {
+      thrown = true;
+    }
+    if (!thrown)
+      TRSL_TEST_FAILURE;
+  }
+
+  // ---------------------------------------------------- //
+  // Test 4: offsets above 2^53 ------------------------- //
+  // ---------------------------------------------------- //
+  {
+    const boost::uint64_t W = std::numeric_limits<boost::uint64_t>::max() / 2;
+
+    // floor(uniform01 * W) is computed without rounding.
+    const double u = 1 - std::ldexp(1.0, -53);
+    if (! (trsl::detail::exact_floor_product(u, W) ==
+           W - (boost::uint64_t(1) << 10)) )
+      TRSL_TEST_FAILURE;
+    if (! (trsl::detail::exact_floor_product(.5, W) == W / 2 &&
+           trsl::detail::exact_floor_product(std::ldexp(1.0, -70), W) == 0 &&
+           trsl::detail::exact_floor_product(0, W) == 0) )
+      TRSL_TEST_FAILURE;
+
+    // System-provided offsets reach all positions, including those
+    // between two multiples of W / 2^53.
+    const unsigned N_DRAWS = 100;
+    boost::uint64_t lowBits = 0;
+    for (unsigned i = 0; i < N_DRAWS; ++i)
+    {
+      const boost::uint64_t offset = trsl::detail::systematic_integer_offset(
+        1, W, "test_is_picked_systematic_integer");
+      if (! (offset < W) )
+        TRSL_TEST_FAILURE;
+      lowBits |= ~offset & ((boost::uint64_t(1) << 10) - 1);
+    }
+    if (! (lowBits == (boost::uint64_t(1) << 10) - 1) )
+      TRSL_TEST_FAILURE;
+  }
+
+  return 0;
+}
@@ -0,0 +1,134 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <trsl/is_picked_systematic_log.hpp>
+#include <tests/common.hpp>
+using namespace trsl::test;
+
+// Log-weights that underflow double when exponentiated.
+static const double LOG_OFFSET = -2000;
+
+struct log_wac_functor
+{
+  double operator()(const PickCountParticle& p) const
+    {
+      if (p.getWeight() == 0)
+        return -std::numeric_limits<double>::infinity();
+      return std::log(p.getWeight()) + LOG_OFFSET;
+    }
+};
+
+int main()
+{
+  // BSD has two different random generators
+  unsigned long random_seed = time(NULL)*getpid();
+  srandom(random_seed);
+  srand(random_seed);
+
+  typedef std::vector<PickCountParticle> ParticleArray;
+  typedef trsl::is_picked_systematic_log<
+    PickCountParticle, double, log_wac_functor> is_picked;
+  typedef trsl::persistent_filter_iterator
+    <is_picked, ParticleArray::iterator> sample_iterator;
+
+  // ---------------------------------------------------- //
+  // Test 1: log_sum_exp -------------------------------- //
+  // ---------------------------------------------------- //
+  {
+    const size_t POPULATION_SIZE = 1000;
+
+    ParticleArray population;
+    generatePopulation(POPULATION_SIZE, population, false);
+    population[10].setWeight(0);
+
+    double totalWeight = 0;
+    for (size_t i = 0; i < POPULATION_SIZE; ++i)
+      totalWeight += population[i].getWeight();
+
+    double lse = trsl::log_sum_exp<double>(population.begin(),
+                                           population.end(),
+                                           log_wac_functor());
+    double expected = std::log(totalWeight) + LOG_OFFSET;
+    if (! (std::fabs(lse - expected) <= 1e-12 * std::fabs(expected)) )
+    {
+      TRSL_TEST_FAILURE;
+      std::cout << TRSL_NVP(lse) << "\n" << TRSL_NVP(expected) << std::endl;
+    }
+
+    ParticleArray empty;
+    if (trsl::log_sum_exp<double>(empty.begin(), empty.end(),
+                                  log_wac_functor()) !=
+        -std::numeric_limits<double>::infinity())
+      TRSL_TEST_FAILURE;
+  }
+
+  // ---------------------------------------------------- //
+  // Test 2: sampling coherency with probabilities ------ //
+  // ---------------------------------------------------- //
+  {
+    const size_t POPULATION_SIZE = 100;
+    const size_t SAMPLE_SIZE = 5;
+    const unsigned N_ROUNDS = 1000000;
+
+    ParticleArray population;
+    generatePopulation(POPULATION_SIZE, population);
+    // Elements with a null weight should never be picked.
+    population[7].setWeight(0);
+
+    double totalWeight = 0;
+    for (size_t i = 0; i < POPULATION_SIZE; ++i)
+      totalWeight += population[i].getWeight();
+
+    double logPopulationWeight =
+      trsl::log_sum_exp<double>(population.begin(), population.end(),
+                                log_wac_functor());
+
+    boost::mt19937 rng((unsigned)random_seed);
+    boost::uniform_01<boost::mt19937> uni_dist(rng);
+
+    unsigned pickCount = 0;
+    for (unsigned round = 0; round < N_ROUNDS; round++)
+    {
+      is_picked predicate(SAMPLE_SIZE, logPopulationWeight, uni_dist());
+      sample_iterator sb = sample_iterator(predicate,
+                                           population.begin(),
+                                           population.end());
+      sample_iterator se = sample_iterator(predicate,
+                                           population.end(),
+                                           population.end());
+      for (sample_iterator si = sb; si != se; ++si)
+      {
+        si->pick();
+        pickCount++;
+      }
+    }
+    if (! (pickCount == N_ROUNDS * SAMPLE_SIZE) )
+    {
+      TRSL_TEST_FAILURE;
+      std::cout << TRSL_NVP(pickCount) << std::endl;
+    }
+
+    for (size_t i = 0; i < POPULATION_SIZE; ++i)
+    {
+      double weight = population[i].getWeight() / totalWeight;
+      double pickProp = double(population[i].getPickCount()) /
+        (N_ROUNDS * SAMPLE_SIZE);
+      if (! ( std::fabs(POPULATION_SIZE * weight -
+                        POPULATION_SIZE * pickProp) <= 1e-1) ||
+          (weight == 0 && population[i].getPickCount() != 0))
+      {
+        TRSL_TEST_FAILURE;
+        std::cout << "Element " << i
+                  << ": weight = " << int(100 * POPULATION_SIZE *
+                                          weight) << "%"
+                  << ", pickp = " << int(100 * POPULATION_SIZE *
+                                         pickProp) << "%"
+                  << std::endl;
+      }
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,228 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <trsl/lazy_random_permutation_iterator.hpp>
+#include <trsl/xoshiro256.hpp>
+#include <tests/common.hpp>
+#include <set>
+#include <boost/iterator/counting_iterator.hpp>
+using namespace trsl::test;
+
+int main()
+{
+  // BSD has two different random generators
+  unsigned long random_seed = time(NULL)*getpid();
+  srandom(random_seed);
+  srand(random_seed);
+
+  typedef std::vector<PickCountParticle> ParticleArray;
+
+  // ---------------------------------------------------- //
+  // Test 1: permutation -------------------------------- //
+  // ---------------------------------------------------- //
+  {
+    const size_t POPULATION_SIZE = 10000;
+    const size_t SAMPLE_SIZE = 100;
+
+    typedef std::vector<size_t> IndexArray;
+    typedef trsl::lazy_reorder_iterator<
+      IndexArray::const_iterator> permutation_iterator;
+
+    IndexArray identity(POPULATION_SIZE);
+    for (size_t i = 0; i < POPULATION_SIZE; ++i)
+      identity[i] = i;
+    IndexArray const& const_identity = identity;
+
+    //------------------------------------------------//
+    // Test 1a: full permutation                      //
+    //------------------------------------------------//
+    {
+      permutation_iterator sb = trsl::lazy_random_permutation_iterator
+        (const_identity.begin(), const_identity.end());
+      std::vector<bool> seen(POPULATION_SIZE, false);
+      size_t count = 0;
+      for (permutation_iterator si = sb, se = sb.end(); si != se; ++si)
+      {
+        if (seen.at(*si))
+          TRSL_TEST_FAILURE;
+        seen.at(*si) = true;
+        if (! (*si == si.index()) )
+          TRSL_TEST_FAILURE;
+        count++;
+      }
+      if (! (count == POPULATION_SIZE && sb.end() - sb == std::ptrdiff_t(count)) )
+      {
+        TRSL_TEST_FAILURE;
+        std::cout << TRSL_NVP(count) << std::endl;
+      }
+    }
+
+    //------------------------------------------------//
+    // Test 1b: partial permutation, shared state     //
+    //------------------------------------------------//
+    {
+      permutation_iterator sb = trsl::lazy_random_permutation_iterator
+        (const_identity.begin(), const_identity.end(),
+         SAMPLE_SIZE);
+      // Read from the middle first, then from the beginning, with a
+      // copy: both must go through the same permutation.
+      permutation_iterator copy = sb;
+      size_t middle = *(copy + SAMPLE_SIZE / 2);
+      std::vector<size_t> sample(sb, sb.end());
+      if (! (sample.size() == SAMPLE_SIZE) )
+        TRSL_TEST_FAILURE;
+      if (! (sample.at(SAMPLE_SIZE / 2) == middle) )
+        TRSL_TEST_FAILURE;
+      if (! (std::set<size_t>(sample.begin(), sample.end()).size() == SAMPLE_SIZE) )
+        TRSL_TEST_FAILURE;
+      for (size_t i = 0; i < SAMPLE_SIZE; ++i)
+        if (! (copy[i] == sample[i]) )
+          TRSL_TEST_FAILURE;
+    }
+
+    //------------------------------------------------//
+    // Test 1c: bad permutation size                  //
+    //------------------------------------------------//
+    {
+      bool thrown = false;
+      try {
+        trsl::lazy_random_permutation_iterator
+          (const_identity.begin(), const_identity.end(),
+           POPULATION_SIZE + 1);
+      } catch (trsl::bad_parameter_value &e) {
+        thrown = true;
+      }
+      if (!thrown)
+        TRSL_TEST_FAILURE;
+    }
+
+    //------------------------------------------------//
+    // Test 1d: huge population                       //
+    //------------------------------------------------//
+    {
+      // The population is never stored: reading a few indices of a
+      // permutation of 10^12 elements costs a few steps.
+      typedef boost::counting_iterator<size_t> counting_iterator;
+      const size_t HUGE_SIZE = size_t(1000000) * 1000000;
+      trsl::xoshiro256 g(random_seed);
+      trsl::lazy_reorder_iterator<
+        counting_iterator, trsl::rand_gen::xoshiro256_uniform_int> sb =
+        trsl::lazy_random_permutation_iterator
+        (counting_iterator(0), counting_iterator(HUGE_SIZE), g);
+      std::set<size_t> sample;
+      for (size_t i = 0; i < SAMPLE_SIZE; ++i)
+      {
+        size_t index = (sb + i).index();
+        if (! (index < HUGE_SIZE) )
+          TRSL_TEST_FAILURE;
+        sample.insert(index);
+      }
+      if (! (sample.size() == SAMPLE_SIZE) )
+        TRSL_TEST_FAILURE;
+      if (! (*sample.rbegin() > HUGE_SIZE / 2) )
+        TRSL_TEST_FAILURE;
+    }
+
+    //------------------------------------------------//
+    // Test 1e: the generator is only used at         //
+    //          construction                          //
+    //------------------------------------------------//
+    {
+      typedef trsl::lazy_reorder_iterator<
+        IndexArray::const_iterator,
+        trsl::rand_gen::xoshiro256_uniform_int> generator_iterator;
+      trsl::xoshiro256 h(random_seed);
+      generator_iterator a;
+      {
+        trsl::xoshiro256 g(random_seed);
+        a = trsl::lazy_random_permutation_iterator
+          (const_identity.begin(), const_identity.end(), g);
+        // Neither using nor destroying g changes the permutation.
+        for (int i = 0; i < 1000; ++i) g();
+      }
+      generator_iterator b = trsl::lazy_random_permutation_iterator
+        (const_identity.begin(), const_identity.end(), h);
+      generator_iterator c = trsl::lazy_random_permutation_iterator
+        (const_identity.begin(), const_identity.end(), h);
+      size_t equal = 0;
+      for (; a != a.end(); ++a, ++b, ++c)
+      {
+        if (! (*a == *b) )
+        {
+          TRSL_TEST_FAILURE;
+          break;
+        }
+        if (*a == *c) ++equal;
+      }
+      // Successive iterators draw different permutations.
+      if (! (equal < 10) )
+        TRSL_TEST_FAILURE;
+    }
+
+    //------------------------------------------------//
+    // Test 1f: the permutation depends on the seed   //
+    //          of the generator                      //
+    //------------------------------------------------//
+    {
+      typedef trsl::lazy_reorder_iterator<
+        IndexArray::const_iterator,
+        trsl::rand_gen::xoshiro256_uniform_int> generator_iterator;
+      trsl::xoshiro256 g(random_seed), h(random_seed + 1);
+      generator_iterator a = trsl::lazy_random_permutation_iterator
+        (const_identity.begin(), const_identity.end(), g);
+      generator_iterator b = trsl::lazy_random_permutation_iterator
+        (const_identity.begin(), const_identity.end(), h);
+      size_t equal = 0;
+      for (; a != a.end(); ++a, ++b)
+        if (*a == *b) ++equal;
+      if (! (equal < 10) )
+        TRSL_TEST_FAILURE;
+    }
+  }
+
+  // ---------------------------------------------------- //
+  // Test 2: small population --------------------------- //
+  // ---------------------------------------------------- //
+  {
+    const size_t POPULATION_SIZE = 100;
+    const size_t SAMPLE_SIZE = 5;
+
+    typedef trsl::lazy_reorder_iterator
+      <ParticleArray::iterator> permutation_iterator;
+
+    ParticleArray population;
+    generatePopulation(POPULATION_SIZE, population);
+
+    //------------------------------------------------//
+    // Test 2a: sampling coherency with probabilities //
+    //------------------------------------------------//
+    {
+      const unsigned N_ROUNDS = 200000;
+      for (unsigned round = 0; round < N_ROUNDS; round++)
+      {
+        permutation_iterator sb =
+          trsl::lazy_random_permutation_iterator(population.begin(),
+                                                 population.end(),
+                                                 SAMPLE_SIZE);
+        for (permutation_iterator si = sb, se = sb.end(); si != se; ++si)
+          si->pick();
+      }
+      for (ParticleArray::iterator e = population.begin();
+           e != population.end(); e++)
+      {
+        double pickProp = double(e->getPickCount()) / (N_ROUNDS * SAMPLE_SIZE);
+        if (! ( std::fabs(1 - POPULATION_SIZE * pickProp) <= 1e-1) )
+        {
+          TRSL_TEST_FAILURE;
+          std::cout << "Element " << std::distance(population.begin(), e)
+                    << ", pickp = " << int(100 * POPULATION_SIZE * pickProp)
+                    << "%" << std::endl;
+        }
+      }
+    }
+  }
+
+  return 0;
+}
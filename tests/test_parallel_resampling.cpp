@@ -0,0 +1,226 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+// Tests metropolis_resample and rejection_resample.
+
+#include <trsl/metropolis_resample.hpp>
+#include <trsl/rejection_resample.hpp>
+#include <tests/common.hpp>
+using namespace trsl::test;
+
+#include <string>
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+unsigned long random_seed = time(NULL)*getpid();
+
+typedef std::vector<PickCountParticle> ParticleArray;
+typedef trsl::mp_weight_accessor<double, PickCountParticle> accessor;
+
+static const unsigned METROPOLIS_STEPS = 50;
+
+// Calls metropolis_resample or rejection_resample, depending on
+// scheme.
+void resample(const std::string& scheme,
+              ParticleArray const& population,
+              size_t sampleSize,
+              boost::uint32_t seed,
+              std::vector<size_t>& indices)
+{
+  indices.resize(sampleSize);
+  accessor wac(&PickCountParticle::getWeight);
+  if (scheme == "metropolis")
+    trsl::metropolis_resample(population.begin(), population.end(),
+                              sampleSize, METROPOLIS_STEPS, seed, wac,
+                              indices.begin());
+  else
+  {
+    double maxWeight = 0;
+    for (ParticleArray::const_iterator e = population.begin();
+         e != population.end(); ++e)
+      maxWeight = std::max(maxWeight, e->getWeight());
+    trsl::rejection_resample(population.begin(), population.end(),
+                             sampleSize, maxWeight, seed, wac,
+                             indices.begin());
+  }
+}
+
+void test_scheme(const std::string& scheme)
+{
+  // ---------------------------------------------------- //
+  // Test 1: sampling coherency with probabilities ------ //
+  // ---------------------------------------------------- //
+  {
+    const size_t POPULATION_SIZE = 100;
+    const size_t SAMPLE_SIZE = 2000000;
+
+    ParticleArray population;
+    generatePopulation(POPULATION_SIZE, population);
+    // Elements with a null weight should never be picked.
+    population[7].setWeight(0);
+
+    std::vector<size_t> indices;
+    resample(scheme, population, SAMPLE_SIZE, rand(), indices);
+
+    std::vector<size_t> counts(POPULATION_SIZE, 0);
+    for (size_t i = 0; i < indices.size(); ++i)
+      counts.at(indices[i])++;
+
+    double totalWeight = 0;
+    for (size_t i = 0; i < POPULATION_SIZE; ++i)
+      totalWeight += population[i].getWeight();
+
+    for (size_t i = 0; i < POPULATION_SIZE; ++i)
+    {
+      double weight = population[i].getWeight() / totalWeight;
+      double pickProp = double(counts[i]) / SAMPLE_SIZE;
+      if (! ( std::fabs(POPULATION_SIZE * weight -
+                        POPULATION_SIZE * pickProp) <= 1e-1) ||
+          (weight == 0 && counts[i] != 0))
+      {
+        TRSL_TEST_FAILURE;
+        std::cout << scheme << " element " << i
+                  << ": weight = " << int(100 * POPULATION_SIZE *
+                                          weight) << "%"
+                  << ", pickp = " << int(100 * POPULATION_SIZE *
+                                         pickProp) << "%"
+                  << std::endl;
+      }
+    }
+  }
+
+  // ---------------------------------------------------- //
+  // Test 2: reproducibility ---------------------------- //
+  // ---------------------------------------------------- //
+  {
+    const size_t POPULATION_SIZE = 1000;
+    const size_t SAMPLE_SIZE = 10000;
+
+    ParticleArray population;
+    generatePopulation(POPULATION_SIZE, population);
+    boost::uint32_t seed = rand();
+
+    //--------------------------------------------//
+    // Test 2a: same seed, same number of threads //
+    //--------------------------------------------//
+    std::vector<size_t> first, second;
+    resample(scheme, population, SAMPLE_SIZE, seed, first);
+    resample(scheme, population, SAMPLE_SIZE, seed, second);
+    if (first != second)
+      TRSL_TEST_FAILURE;
+
+#ifdef _OPENMP
+    //--------------------------------//
+    // Test 2b: any number of threads //
+    //--------------------------------//
+    const int maxThreads = omp_get_max_threads();
+    omp_set_num_threads(5);
+    resample(scheme, population, SAMPLE_SIZE, seed, second);
+    omp_set_num_threads(maxThreads);
+    if (first != second)
+      TRSL_TEST_FAILURE;
+#endif
+
+    //--------------------------//
+    // Test 2c: different seeds //
+    //--------------------------//
+    resample(scheme, population, SAMPLE_SIZE, seed + 1, second);
+    if (first == second)
+      TRSL_TEST_FAILURE;
+  }
+
+  // ---------------------------------------------------- //
+  // Test 3: bad parameters ----------------------------- //
+  // ---------------------------------------------------- //
+  {
+    ParticleArray population;
+    std::vector<size_t> indices;
+    bool thrown = false;
+    try {
+      resample(scheme, population, 10, 0, indices);
+    } catch (trsl::bad_parameter_value &e) {
+      thrown = true;
+    }
+    if (!thrown)
+      TRSL_TEST_FAILURE;
+
+    // No element can be accepted when all weights are zero.
+    if (scheme == "rejection")
+    {
+      generatePopulation(10, population);
+      for (ParticleArray::iterator e = population.begin();
+           e != population.end(); ++e)
+        e->setWeight(0);
+      indices.resize(10);
+      thrown = false;
+      try {
+        trsl::rejection_resample(population.begin(), population.end(),
+                                 10, 1.0, 0,
+                                 accessor(&PickCountParticle::getWeight),
+                                 indices.begin());
+      } catch (trsl::bad_parameter_value &e) {
+        thrown = true;
+      }
+      if (!thrown)
+        TRSL_TEST_FAILURE;
+    }
+  }
+
+  // ---------------------------------------------------- //
+  // Test 4: sample smaller than the population --------- //
+  // ---------------------------------------------------- //
+  if (scheme == "rejection")
+  {
+    // With equal weights, every element should be picked equally
+    // often, whatever its position in the population.
+    const size_t POPULATION_SIZE = 1000;
+    const size_t SAMPLE_SIZE = 10;
+    const unsigned N_SEEDS = 20000;
+
+    ParticleArray population;
+    generatePopulation(POPULATION_SIZE, population);
+    for (ParticleArray::iterator e = population.begin();
+         e != population.end(); ++e)
+      e->setWeight(1);
+
+    std::vector<size_t> counts(POPULATION_SIZE, 0);
+    std::vector<size_t> indices(SAMPLE_SIZE);
+    boost::uint32_t seed = rand();
+    for (unsigned s = 0; s < N_SEEDS; ++s)
+    {
+      trsl::rejection_resample(population.begin(), population.end(),
+                               SAMPLE_SIZE, 2.0, seed + s,
+                               accessor(&PickCountParticle::getWeight),
+                               indices.begin());
+      for (size_t i = 0; i < SAMPLE_SIZE; ++i)
+        counts.at(indices[i])++;
+    }
+
+    // 200 picks expected per element, with a standard deviation of
+    // about 14.
+    const double expected = double(SAMPLE_SIZE) * N_SEEDS / POPULATION_SIZE;
+    for (size_t i = 0; i < POPULATION_SIZE; ++i)
+      if (! (std::fabs(counts[i] - expected) <= 100) )
+      {
+        TRSL_TEST_FAILURE;
+        std::cout << TRSL_NVP(i) << " " << TRSL_NVP(counts[i]) << std::endl;
+        break;
+      }
+  }
+}
+
+int main()
+{
+  // BSD has two different random generators
+  srandom(random_seed);
+  srand(random_seed);
+
+  test_scheme("metropolis");
+  test_scheme("rejection");
+
+  return 0;
+}
@@ -0,0 +1,170 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <trsl/population_weight.hpp>
+#include <tests/common.hpp>
+using namespace trsl::test;
+
+#include <sstream>
+#include <iterator>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+struct identity_wac
+{
+  double operator()(double x) const { return x; }
+};
+
+int main()
+{
+  // BSD has two different random generators
+  unsigned long random_seed = time(NULL)*getpid();
+  srandom(random_seed);
+  srand(random_seed);
+
+  // ---------------------------------------------------- //
+  // Test 1: accuracy, all iterator categories ---------- //
+  // ---------------------------------------------------- //
+  {
+    // Weights of very different magnitudes, on which a naive sum
+    // loses most of the small ones.
+    const size_t POPULATION_SIZE = 100000;
+    std::vector<double> weights;
+    long double exact = 0;
+    for (size_t i = 0; i < POPULATION_SIZE; ++i)
+    {
+      double w = double(rand()) / RAND_MAX;
+      if (i % 1000 == 0) w *= 1e16;
+      weights.push_back(w);
+      exact += w;
+    }
+    const double tolerance = 4 * std::numeric_limits<double>::epsilon() *
+      double(exact);
+
+    //---------------------------//
+    // Test 1a: random access    //
+    //---------------------------//
+    double sum = trsl::population_weight<double>(weights.begin(),
+                                                 weights.end(),
+                                                 identity_wac());
+    if (! (std::fabs(sum - double(exact)) <= tolerance) )
+    {
+      TRSL_TEST_FAILURE;
+      std::cout << TRSL_NVP(sum) << "\n" << TRSL_NVP(double(exact)) << std::endl;
+    }
+
+    //---------------------------//
+    // Test 1b: bidirectional    //
+    //---------------------------//
+    std::list<double> list(weights.begin(), weights.end());
+    double listSum = trsl::population_weight<double>(list.begin(), list.end(),
+                                                     identity_wac());
+    if (! (std::fabs(listSum - double(exact)) <= tolerance) )
+      TRSL_TEST_FAILURE;
+
+    //---------------------------//
+    // Test 1c: input            //
+    //---------------------------//
+    std::stringstream stream;
+    stream.precision(17);
+    std::copy(weights.begin(), weights.end(),
+              std::ostream_iterator<double>(stream, " "));
+    double streamSum =
+      trsl::population_weight<double>(std::istream_iterator<double>(stream),
+                                      std::istream_iterator<double>(),
+                                      identity_wac());
+    if (! (std::fabs(streamSum - double(exact)) <= tolerance) )
+      TRSL_TEST_FAILURE;
+
+#ifdef _OPENMP
+    //--------------------------------//
+    // Test 1d: any number of threads //
+    //--------------------------------//
+    const int maxThreads = omp_get_max_threads();
+    omp_set_num_threads(3);
+    double threadSum = trsl::population_weight<double>(weights.begin(),
+                                                       weights.end(),
+                                                       identity_wac());
+    omp_set_num_threads(maxThreads);
+    if (threadSum != sum)
+      TRSL_TEST_FAILURE;
+#endif
+
+    std::vector<double> empty;
+    if (trsl::population_weight<double>(empty.begin(), empty.end(),
+                                        identity_wac()) != 0)
+      TRSL_TEST_FAILURE;
+  }
+
+  // ---------------------------------------------------- //
+  // Test 2: make_is_picked_systematic ------------------ //
+  // ---------------------------------------------------- //
+  {
+    const size_t POPULATION_SIZE = 100000;
+    const size_t SAMPLE_SIZE = 1000;
+
+    typedef std::vector<PickCountParticle> ParticleArray;
+    typedef trsl::mp_weight_accessor<double, PickCountParticle> accessor;
+    typedef trsl::is_picked_systematic<
+      PickCountParticle, double, accessor> is_picked;
+    typedef trsl::persistent_filter_iterator
+      <is_picked, ParticleArray::const_iterator> sample_iterator;
+
+    ParticleArray population;
+    // Weights are not normalized.
+    generatePopulation(POPULATION_SIZE, population, false);
+    ParticleArray const& const_pop = population;
+
+    accessor wac(&PickCountParticle::getWeight);
+    is_picked predicate =
+      trsl::make_is_picked_systematic(const_pop.begin(), const_pop.end(),
+                                      SAMPLE_SIZE, .5, wac);
+    is_picked reference(SAMPLE_SIZE,
+                        trsl::population_weight<double>(const_pop.begin(),
+                                                        const_pop.end(),
+                                                        wac),
+                        .5, wac);
+    if (! (predicate == reference) )
+      TRSL_TEST_FAILURE;
+
+    size_t size = 0;
+    for (sample_iterator
+           si = sample_iterator(predicate, const_pop.begin(), const_pop.end()),
+           se = sample_iterator(predicate, const_pop.end(), const_pop.end());
+         si != se; ++si)
+      ++size;
+    if (size != SAMPLE_SIZE)
+    {
+      TRSL_TEST_FAILURE;
+      std::cout << TRSL_NVP(size) << "\n" << TRSL_NVP(SAMPLE_SIZE) << std::endl;
+    }
+
+    // Other weight types.
+    typedef trsl::is_picked_systematic<
+      PickCountParticle, float, accessor> float_is_picked;
+    float_is_picked fpredicate =
+      trsl::make_is_picked_systematic<float>(const_pop.begin(), const_pop.end(),
+                                             SAMPLE_SIZE, .5f, wac);
+    float_is_picked freference(SAMPLE_SIZE,
+                               trsl::population_weight<float>(const_pop.begin(),
+                                                              const_pop.end(),
+                                                              wac),
+                               .5f, wac);
+    if (! (fpredicate == freference) )
+      TRSL_TEST_FAILURE;
+    trsl::is_picked_systematic<PickCountParticle, long double, accessor> lpredicate =
+      trsl::make_is_picked_systematic<long double>(const_pop.begin(),
+                                                   const_pop.end(),
+                                                   SAMPLE_SIZE, wac);
+    size = 0;
+    while (lpredicate(const_pop.front()))
+      ++size;
+    if (size > SAMPLE_SIZE)
+      TRSL_TEST_FAILURE;
+  }
+
+  return 0;
+}
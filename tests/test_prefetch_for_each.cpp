@@ -0,0 +1,114 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <trsl/prefetch_for_each.hpp>
+#include <trsl/random_permutation_iterator.hpp>
+#include <tests/common.hpp>
+using namespace trsl::test;
+
+struct collect_x
+{
+  collect_x(std::vector<double>& xs) : xs_(&xs) {}
+  void operator()(const PickCountParticle& p) { xs_->push_back(p.getX()); }
+  std::vector<double>* xs_;
+};
+
+struct pick
+{
+  void operator()(PickCountParticle& p) { p.pick(); }
+};
+
+struct count_true
+{
+  count_true() : n(0) {}
+  void operator()(bool b) { if (b) ++n; }
+  size_t n;
+};
+
+int main()
+{
+  // BSD has two different random generators
+  unsigned long random_seed = time(NULL)*getpid();
+  srandom(random_seed);
+  srand(random_seed);
+
+  typedef std::vector<PickCountParticle> ParticleArray;
+
+  const size_t POPULATION_SIZE = 1000;
+
+  ParticleArray population;
+  generatePopulation(POPULATION_SIZE, population);
+  ParticleArray const& const_pop = population;
+
+  // ---------------------------------------------------- //
+  // Test 1: same elements, same order ------------------ //
+  // ---------------------------------------------------- //
+  {
+    typedef trsl::reorder_iterator
+      <ParticleArray::const_iterator> permutation_iterator;
+
+    permutation_iterator sb = trsl::random_permutation_iterator
+      (const_pop.begin(), const_pop.end());
+    std::vector<double> expected;
+    for (permutation_iterator si = sb; si != sb.end(); ++si)
+      expected.push_back(si->getX());
+
+    const size_t distances[] = { 0, 1, 7, 16, POPULATION_SIZE,
+                                 2 * POPULATION_SIZE };
+    for (size_t d = 0; d < sizeof(distances)/sizeof(distances[0]); ++d)
+    {
+      std::vector<double> xs;
+      trsl::prefetch_for_each(sb, sb.end(), collect_x(xs), distances[d]);
+      if (! (xs == expected) )
+      {
+        TRSL_TEST_FAILURE;
+        std::cout << TRSL_NVP(distances[d]) << std::endl;
+      }
+    }
+
+    // Empty range and partial range.
+    std::vector<double> xs;
+    trsl::prefetch_for_each(sb, sb, collect_x(xs));
+    if (! xs.empty() )
+      TRSL_TEST_FAILURE;
+    trsl::prefetch_for_each(sb + 10, sb + 20, collect_x(xs));
+    if (! (xs.size() == 10 && xs.front() == expected.at(10)) )
+      TRSL_TEST_FAILURE;
+  }
+
+  // ---------------------------------------------------- //
+  // Test 2: mutable elements --------------------------- //
+  // ---------------------------------------------------- //
+  {
+    typedef trsl::reorder_iterator
+      <ParticleArray::iterator> permutation_iterator;
+
+    permutation_iterator sb = trsl::random_permutation_iterator
+      (population.begin(), population.end());
+    trsl::prefetch_for_each(sb, sb.end(), pick());
+    for (ParticleArray::const_iterator i = population.begin();
+         i != population.end(); ++i)
+      if (! (i->getPickCount() == 1) )
+      {
+        TRSL_TEST_FAILURE;
+        break;
+      }
+  }
+
+  // ---------------------------------------------------- //
+  // Test 3: proxy references --------------------------- //
+  // ---------------------------------------------------- //
+  {
+    std::vector<bool> flags(POPULATION_SIZE, false);
+    for (size_t i = 0; i < POPULATION_SIZE; i += 3)
+      flags[i] = true;
+    count_true c = trsl::prefetch_for_each(flags.begin(), flags.end(),
+                                           count_true());
+    if (! (c.n == (POPULATION_SIZE + 2) / 3) )
+      TRSL_TEST_FAILURE;
+  }
+
+  return 0;
+}
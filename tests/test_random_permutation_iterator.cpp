@@ -4,6 +4,7 @@
 // http://www.boost.org/LICENSE_1_0.txt)
 
 #include <trsl/random_permutation_iterator.hpp>
+#include <trsl/xoshiro256.hpp>
 #include <tests/common.hpp>
 using namespace trsl::test;
 
@@ -100,6 +101,40 @@ int main()
         }
       }
     }
+    //-----------------------------//
+    // Test 1d: 32-bit index type //
+    //-----------------------------//
+    {
+      typedef trsl::reorder_iterator
+        <ParticleArray::const_iterator, boost::uint32_t> compact_iterator;
+
+      compact_iterator sb = trsl::random_permutation_iterator<boost::uint32_t>
+        (const_pop.begin(), const_pop.end());
+      std::vector<bool> seen(POPULATION_SIZE, false);
+      size_t count = 0;
+      for (compact_iterator si = sb, se = sb.end(); si != se; ++si, ++count)
+      {
+        if (seen[si.index()])
+          TRSL_TEST_FAILURE;
+        seen[si.index()] = true;
+      }
+      if (! (count == POPULATION_SIZE) )
+        TRSL_TEST_FAILURE;
+      sb = trsl::random_permutation_iterator<boost::uint32_t>
+        (const_pop.begin(), const_pop.end(), SAMPLE_SIZE);
+      if (! (std::distance(sb, sb.end()) == std::ptrdiff_t(SAMPLE_SIZE)) )
+        TRSL_TEST_FAILURE;
+
+      bool thrown = false;
+      try {
+        trsl::random_permutation_iterator<boost::uint16_t>
+          (const_pop.begin(), const_pop.end());
+      } catch (trsl::bad_parameter_value &e) {
+        thrown = true;
+      }
+      if (!thrown)
+        TRSL_TEST_FAILURE;
+    }
     
   }
   
@@ -179,5 +214,143 @@ int main()
     }
   }
 
+  // ---------------------------------------------------- //
+  // Test 3: bounded random integers -------------------- //
+  // ---------------------------------------------------- //
+  {
+    const unsigned N_DRAWS = 300000;
+
+    //------------------------------------------------//
+    // Test 3a: bounds larger than RAND_MAX           //
+    //------------------------------------------------//
+    {
+      // std::rand() % n never exceeds RAND_MAX.
+      const boost::uint64_t n = 3 * (boost::uint64_t(RAND_MAX) + 1);
+      unsigned thirds[3] = { 0, 0, 0 };
+      unsigned aboveRandMax = 0;
+      for (unsigned i = 0; i < N_DRAWS; ++i)
+      {
+        boost::uint64_t r = trsl::detail::system_uniform_int(n);
+        if (! (r < n) )
+        {
+          TRSL_TEST_FAILURE;
+          break;
+        }
+        if (r > boost::uint64_t(RAND_MAX)) aboveRandMax++;
+        thirds[r / (n / 3)]++;
+      }
+      for (int i = 0; i < 3; ++i)
+        if (! (std::fabs(3.0 * thirds[i] / N_DRAWS - 1) < 2e-2) )
+        {
+          TRSL_TEST_FAILURE;
+          std::cout << TRSL_NVP(i) << " " << TRSL_NVP(thirds[i]) << std::endl;
+        }
+      if (aboveRandMax == 0)
+        TRSL_TEST_FAILURE;
+    }
+
+    //------------------------------------------------//
+    // Test 3b: uniformity for small bounds           //
+    //------------------------------------------------//
+    {
+      const unsigned n = 7;
+      unsigned counts[n] = { 0 };
+      for (unsigned i = 0; i < N_DRAWS; ++i)
+      {
+        unsigned r = trsl::rand_gen::uniform_int(n);
+        if (! (r < n) )
+        {
+          TRSL_TEST_FAILURE;
+          break;
+        }
+        counts[r]++;
+      }
+      for (unsigned i = 0; i < n; ++i)
+        if (! (std::fabs(double(n) * counts[i] / N_DRAWS - 1) < 3e-2) )
+        {
+          TRSL_TEST_FAILURE;
+          std::cout << TRSL_NVP(i) << " " << TRSL_NVP(counts[i]) << std::endl;
+        }
+    }
+
+    //------------------------------------------------//
+    // Test 3c: user generator, 64-bit bounds         //
+    //------------------------------------------------//
+    {
+      trsl::xoshiro256 g(random_seed);
+      trsl::rand_gen::uniform_int_adaptor<trsl::xoshiro256> rng(g);
+      const std::ptrdiff_t n =
+        std::ptrdiff_t(3) * (std::ptrdiff_t(1) << 60);
+      unsigned thirds[3] = { 0, 0, 0 };
+      for (unsigned i = 0; i < N_DRAWS; ++i)
+      {
+        std::ptrdiff_t r = rng(n);
+        if (! (r >= 0 && r < n) )
+        {
+          TRSL_TEST_FAILURE;
+          break;
+        }
+        thirds[r / (n / 3)]++;
+      }
+      for (int i = 0; i < 3; ++i)
+        if (! (std::fabs(3.0 * thirds[i] / N_DRAWS - 1) < 2e-2) )
+        {
+          TRSL_TEST_FAILURE;
+          std::cout << TRSL_NVP(i) << " " << TRSL_NVP(thirds[i]) << std::endl;
+        }
+    }
+
+    //------------------------------------------------//
+    // Test 3d: bounds beyond the generator range     //
+    //------------------------------------------------//
+    {
+      // boost::mt19937 has 32 bits, boost::minstd_rand a range that is
+      // not a power of two. Scaling a single output to n = 3 * 2^40
+      // would only return multiples of 2^8.
+      boost::mt19937 mt((unsigned)random_seed);
+      boost::minstd_rand minstd((unsigned)random_seed);
+      trsl::rand_gen::uniform_int_adaptor<boost::mt19937> mt_rng(mt);
+      trsl::rand_gen::uniform_int_adaptor<boost::minstd_rand> minstd_rng(minstd);
+      const std::ptrdiff_t n =
+        std::ptrdiff_t(3) * (std::ptrdiff_t(1) << 40);
+      for (int k = 0; k < 2; ++k)
+      {
+        unsigned thirds[3] = { 0, 0, 0 };
+        unsigned odd = 0;
+        for (unsigned i = 0; i < N_DRAWS; ++i)
+        {
+          std::ptrdiff_t r = (k == 0) ? mt_rng(n) : minstd_rng(n);
+          if (! (r >= 0 && r < n) )
+          {
+            TRSL_TEST_FAILURE;
+            break;
+          }
+          thirds[r / (n / 3)]++;
+          odd += unsigned(r & 1);
+        }
+        for (int i = 0; i < 3; ++i)
+          if (! (std::fabs(3.0 * thirds[i] / N_DRAWS - 1) < 2e-2) )
+          {
+            TRSL_TEST_FAILURE;
+            std::cout << TRSL_NVP(k) << " " << TRSL_NVP(thirds[i]) << std::endl;
+          }
+        if (! (std::fabs(2.0 * odd / N_DRAWS - 1) < 2e-2) )
+        {
+          TRSL_TEST_FAILURE;
+          std::cout << TRSL_NVP(k) << " " << TRSL_NVP(odd) << std::endl;
+        }
+      }
+
+      // Small bounds with a range that is not a power of two.
+      const unsigned m = 7;
+      unsigned counts[m] = { 0 };
+      for (unsigned i = 0; i < N_DRAWS; ++i)
+        counts[minstd_rng(m)]++;
+      for (unsigned i = 0; i < m; ++i)
+        if (! (std::fabs(double(m) * counts[i] / N_DRAWS - 1) < 3e-2) )
+          TRSL_TEST_FAILURE;
+    }
+  }
+
   return 0;
 }
@@ -0,0 +1,153 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <trsl/resample_in_place.hpp>
+#include <trsl/is_picked_systematic.hpp>
+#include <trsl/persistent_filter_iterator.hpp>
+#include <tests/common.hpp>
+using namespace trsl::test;
+
+namespace {
+
+  // Counts the copies made by resample_in_place.
+  class CopyCountParticle : public PickCountParticle
+  {
+  public:
+    CopyCountParticle(double weight, double x, double y) :
+      PickCountParticle(weight, x, y) {}
+    CopyCountParticle(const CopyCountParticle& p) :
+      PickCountParticle(p) { nCopies++; }
+    CopyCountParticle& operator=(const CopyCountParticle& p)
+      {
+        PickCountParticle::operator=(p);
+        nCopies++;
+        return *this;
+      }
+    static size_t nCopies;
+  };
+
+  size_t CopyCountParticle::nCopies = 0;
+
+  typedef std::vector<CopyCountParticle> ParticleArray;
+  typedef trsl::mp_weight_accessor<double, CopyCountParticle> accessor;
+  typedef trsl::is_picked_systematic<
+    CopyCountParticle, double, accessor> is_picked;
+  typedef trsl::persistent_filter_iterator<
+    is_picked, ParticleArray::const_iterator> sample_iterator;
+
+  // Particles are identified by their x coordinate.
+  bool check_sample(ParticleArray const& population,
+                    ParticleArray const& resampled,
+                    is_picked const& predicate)
+  {
+    std::vector<double> expected, actual;
+    sample_iterator sb(predicate, population.begin(), population.end());
+    sample_iterator se(predicate, population.end(), population.end());
+    for (sample_iterator si = sb; si != se; ++si)
+      expected.push_back(si->getX());
+    for (ParticleArray::const_iterator i = resampled.begin();
+         i != resampled.end(); ++i)
+      actual.push_back(i->getX());
+    std::sort(expected.begin(), expected.end());
+    std::sort(actual.begin(), actual.end());
+    return expected == actual;
+  }
+
+}
+
+int main()
+{
+  // BSD has two different random generators
+  unsigned long random_seed = time(NULL)*getpid();
+  srandom(random_seed);
+  srand(random_seed);
+
+  const size_t POPULATION_SIZE = 1000;
+
+  ParticleArray population;
+  population.reserve(POPULATION_SIZE);
+  for (size_t i = 0; i < POPULATION_SIZE; ++i)
+    population.push_back(CopyCountParticle(double(rand())/RAND_MAX, i, 0));
+  // A few heavy elements, picked many times.
+  for (size_t i = 0; i < POPULATION_SIZE; i += 50)
+    population[i].setWeight(population[i].getWeight() * 20);
+  double totalWeight = 0;
+  for (size_t i = 0; i < POPULATION_SIZE; ++i)
+    totalWeight += population[i].getWeight();
+
+  accessor wac(&CopyCountParticle::getWeight);
+
+  // ---------------------------------------------------- //
+  // Test 1: sample as large as the population ---------- //
+  // ---------------------------------------------------- //
+  {
+    is_picked predicate(POPULATION_SIZE, totalWeight, wac);
+
+    // Number of extra copies.
+    size_t nExtra = 0;
+    {
+      is_picked p = predicate;
+      for (size_t i = 0; i < POPULATION_SIZE; ++i)
+      {
+        size_t count = 0;
+        while (p(population[i])) count++;
+        if (count > 1) nExtra += count - 1;
+      }
+    }
+
+    ParticleArray resampled = population;
+    const CopyCountParticle* data = &resampled[0];
+    CopyCountParticle::nCopies = 0;
+    size_t size = trsl::resample_in_place(resampled, predicate);
+
+    //------------------------------------------------//
+    // Test 1a: size, no reallocation                 //
+    //------------------------------------------------//
+    if (size != POPULATION_SIZE || resampled.size() != POPULATION_SIZE ||
+        &resampled[0] != data)
+    {
+      TRSL_TEST_FAILURE;
+      std::cout << TRSL_NVP(size) << std::endl;
+    }
+
+    //------------------------------------------------//
+    // Test 1b: one copy per extra copy               //
+    //------------------------------------------------//
+    if (CopyCountParticle::nCopies != nExtra)
+    {
+      TRSL_TEST_FAILURE;
+      std::cout << TRSL_NVP(CopyCountParticle::nCopies) << "\n"
+                << TRSL_NVP(nExtra) << std::endl;
+    }
+
+    //------------------------------------------------//
+    // Test 1c: same sample as persistent_filter_it.  //
+    //------------------------------------------------//
+    if (!check_sample(population, resampled, predicate))
+      TRSL_TEST_FAILURE;
+  }
+
+  // ---------------------------------------------------- //
+  // Test 2: smaller and larger samples ----------------- //
+  // ---------------------------------------------------- //
+  {
+    const size_t sizes[] = { 0, 1, 100, 3*POPULATION_SIZE };
+    for (size_t s = 0; s < sizeof(sizes)/sizeof(sizes[0]); ++s)
+    {
+      is_picked predicate(sizes[s], totalWeight, wac);
+      ParticleArray resampled = population;
+      size_t size = trsl::resample_in_place(resampled, predicate);
+      if (size != sizes[s] || resampled.size() != sizes[s])
+      {
+        TRSL_TEST_FAILURE;
+        std::cout << TRSL_NVP(size) << "\n" << TRSL_NVP(sizes[s]) << std::endl;
+      }
+      if (!check_sample(population, resampled, predicate))
+        TRSL_TEST_FAILURE;
+    }
+  }
+
+  return 0;
+}
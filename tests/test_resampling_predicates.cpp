@@ -0,0 +1,193 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+// Checks shared by all persistent_filter_iterator predicates that
+// don't have a test of their own.
+
+#include <trsl/is_picked_stratified.hpp>
+#include <trsl/is_picked_residual.hpp>
+#include <trsl/ppfilter_iterator.hpp>
+#include <tests/common.hpp>
+using namespace trsl::test;
+
+#include <string>
+
+unsigned long random_seed = time(NULL)*getpid();
+
+template<class is_picked>
+void test_predicate(const std::string& name)
+{
+  if (TEST_VERBOSE > 0)
+    std::cout << name << std::endl;
+
+  // ---------------------------------------------------- //
+  // Test 1: large population --------------------------- //
+  // ---------------------------------------------------- //
+  {
+    const size_t POPULATION_SIZE = 1000000;
+    const size_t SAMPLE_SIZE = 1000;
+
+    typedef std::list<PickCountParticle> ParticleArray;
+
+    typedef trsl::persistent_filter_iterator
+      <is_picked, ParticleArray::const_iterator> sample_iterator;
+
+    ParticleArray population;
+    generatePopulation(POPULATION_SIZE, population);
+    ParticleArray const& const_pop = population;
+
+    //------------------------------//
+    // Test 1a: correct sample size //
+    //------------------------------//
+    {
+      size_t sampleSize = 0;
+      is_picked predicate(SAMPLE_SIZE, 1.0, &PickCountParticle::getWeight);
+
+      sample_iterator sb = sample_iterator(predicate, const_pop.begin(), const_pop.end());
+      sample_iterator se = sample_iterator(predicate, const_pop.end(),   const_pop.end());
+      for (sample_iterator si = sb; si != se; ++si)
+        sampleSize++;
+      if (! (sampleSize == SAMPLE_SIZE) )
+      {
+        TRSL_TEST_FAILURE;
+        std::cout << name << "\n"
+                  << TRSL_NVP(sampleSize) << "\n" << TRSL_NVP(SAMPLE_SIZE) << std::endl;
+      }
+    }
+  }
+
+  // ---------------------------------------------------- //
+  // Test 2: small population --------------------------- //
+  // ---------------------------------------------------- //
+  {
+    const size_t POPULATION_SIZE = 100;
+    const size_t SAMPLE_SIZE = 5;
+
+    typedef trsl::persistent_filter_iterator
+      <is_picked, std::vector<PickCountParticle>::iterator> sample_iterator;
+
+    std::vector<PickCountParticle> population;
+    generatePopulation(POPULATION_SIZE, population);
+
+    //------------------------------------------------//
+    // Test 2a: sampling coherency with probabilities //
+    //------------------------------------------------//
+    {
+      const unsigned N_ROUNDS = 500000;
+      unsigned pickCount = 0;
+
+      for (unsigned round = 0; round < N_ROUNDS; round++)
+      {
+        is_picked predicate(SAMPLE_SIZE, 1.0, &PickCountParticle::getWeight);
+
+        sample_iterator sb = sample_iterator(predicate,
+                                             population.begin(),
+                                             population.end());
+        sample_iterator se = sample_iterator(predicate,
+                                             population.end(),
+                                             population.end());
+        for (sample_iterator si = sb; si != se; ++si)
+        {
+          si->pick();
+          pickCount++;
+        }
+      }
+      if (! (pickCount == N_ROUNDS * SAMPLE_SIZE) )
+      {
+        TRSL_TEST_FAILURE;
+        std::cout << name << "\n"
+                  << TRSL_NVP(N_ROUNDS) << std::endl
+                  << TRSL_NVP(SAMPLE_SIZE) << std::endl
+                  << TRSL_NVP(pickCount) << std::endl;
+      }
+      for (std::vector<PickCountParticle>::iterator e = population.begin();
+           e != population.end(); e++)
+      {
+        double pickProp = double(e->getPickCount()) / (N_ROUNDS * SAMPLE_SIZE);
+        if (! ( std::fabs(POPULATION_SIZE * e->getWeight() -
+                          POPULATION_SIZE * pickProp) <= 1e-1) )
+        {
+          TRSL_TEST_FAILURE;
+          std::cout << name << " element " << std::distance(population.begin(), e)
+                    << ": weight = " << int(100 * POPULATION_SIZE *
+                                            e->getWeight()) << "%"
+                    << ", pickp = " << int(100 * POPULATION_SIZE *
+                                           pickProp) << "%"
+                    << std::endl;
+        }
+      }
+    }
+  }
+
+  // ---------------------------------------------------- //
+  // Test 3: sample larger than population -------------- //
+  // ---------------------------------------------------- //
+  {
+    const size_t POPULATION_SIZE = 800;
+    const size_t SAMPLE_SIZE = 1000;
+
+    typedef trsl::ppfilter_iterator
+      <is_picked, std::vector<PickCountParticle>::const_iterator> sample_iterator;
+
+    std::vector<PickCountParticle> population;
+    generatePopulation(POPULATION_SIZE, population);
+    std::vector<PickCountParticle> const& const_pop = population;
+
+    is_picked predicate(SAMPLE_SIZE, 1.0, &PickCountParticle::getWeight);
+    sample_iterator sb = sample_iterator(predicate, const_pop.begin(), const_pop.end());
+    sample_iterator se = sb.end();
+
+    //------------------------------------------//
+    // Test 3a: ppfilter_iterator, begin() copy //
+    //------------------------------------------//
+    {
+      std::vector<size_t> first, second;
+      for (sample_iterator si = sb; si != se; ++si)
+        first.push_back(si.index());
+      for (sample_iterator si = sb.begin(); si != se; ++si)
+        second.push_back(si.index());
+
+      if (first.size() != SAMPLE_SIZE || first != second)
+      {
+        TRSL_TEST_FAILURE;
+        std::cout << name << "\n"
+                  << TRSL_NVP(first.size()) << "\n" << TRSL_NVP(second.size()) << std::endl;
+      }
+    }
+
+    //------------------------//
+    // Test 3b: is_first_pick //
+    //------------------------//
+    {
+      int duplicates = 0;
+      for (sample_iterator
+             si = sb,
+             previous = sb; si != se; previous = si++)
+      {
+        bool repeated = si != previous && si.index() == previous.index();
+        if (repeated)
+          duplicates++;
+        if (repeated == is_first_pick(si))
+          TRSL_TEST_FAILURE;
+      }
+      if (duplicates == 0)
+        TRSL_TEST_FAILURE;
+    }
+  }
+}
+
+int main()
+{
+  // BSD has two different random generators
+  srandom(random_seed);
+  srand(random_seed);
+
+  test_predicate< trsl::is_picked_stratified<PickCountParticle> >
+    ("is_picked_stratified");
+  test_predicate< trsl::is_picked_residual<PickCountParticle> >
+    ("is_picked_residual");
+
+  return 0;
+}
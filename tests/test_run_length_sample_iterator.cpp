@@ -0,0 +1,126 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <trsl/run_length_sample_iterator.hpp>
+#include <trsl/systematic_sample.hpp>
+#include <tests/common.hpp>
+using namespace trsl::test;
+
+int main()
+{
+  // BSD has two different random generators
+  unsigned long random_seed = time(NULL)*getpid();
+  srandom(random_seed);
+  srand(random_seed);
+
+  typedef std::list<PickCountParticle> ParticleArray;
+  typedef trsl::mp_weight_accessor<double, PickCountParticle> accessor;
+  typedef trsl::run_length_sample_iterator<
+    ParticleArray::const_iterator> sample_iterator;
+
+  accessor wac(&PickCountParticle::getWeight);
+
+  // ---------------------------------------------------- //
+  // Test 1: skewed population -------------------------- //
+  // ---------------------------------------------------- //
+  {
+    const size_t POPULATION_SIZE = 10000;
+    const size_t SAMPLE_SIZE = 100000;
+    const unsigned N_ROUNDS = 100;
+
+    ParticleArray population;
+    generatePopulation(POPULATION_SIZE, population, false);
+    // A few heavy elements, picked many times.
+    size_t i = 0;
+    for (ParticleArray::iterator e = population.begin();
+         e != population.end(); ++e, ++i)
+      if (i % 100 == 0)
+        e->setWeight(e->getWeight() * 1000);
+    double totalWeight = 0;
+    for (ParticleArray::iterator e = population.begin();
+         e != population.end(); ++e)
+      totalWeight += e->getWeight();
+    ParticleArray const& const_pop = population;
+
+    boost::mt19937 rng((unsigned)random_seed);
+    boost::uniform_01<boost::mt19937> uni_dist(rng);
+
+    size_t mismatches = 0;
+    for (unsigned round = 0; round < N_ROUNDS; ++round)
+    {
+      const double u = uni_dist();
+
+      std::vector<size_t> expected;
+      trsl::systematic_offspring(const_pop.begin(), const_pop.end(),
+                                 SAMPLE_SIZE, totalWeight, u, wac,
+                                 std::back_inserter(expected));
+
+      std::vector<size_t> counts(POPULATION_SIZE, 0);
+      size_t total = 0;
+      sample_iterator sb(const_pop.begin(), const_pop.end(),
+                         SAMPLE_SIZE, totalWeight, u, wac);
+      for (sample_iterator si = sb; si != sb.end(); ++si)
+      {
+        if (si.multiplicity() == 0)
+          TRSL_TEST_FAILURE;
+        const size_t index = std::distance(const_pop.begin(), si.base());
+        if (counts[index] != 0)
+          TRSL_TEST_FAILURE;
+        counts[index] = si.multiplicity();
+        total += si.multiplicity();
+      }
+
+      //------------------------------------------------//
+      // Test 1a: sample size                           //
+      //------------------------------------------------//
+      if (total != SAMPLE_SIZE)
+      {
+        TRSL_TEST_FAILURE;
+        std::cout << TRSL_NVP(total) << "\n" << TRSL_NVP(SAMPLE_SIZE) << std::endl;
+      }
+
+      //------------------------------------------------//
+      // Test 1b: same counts as is_picked_systematic,  //
+      // up to rounding at element boundaries           //
+      //------------------------------------------------//
+      for (size_t k = 0; k < POPULATION_SIZE; ++k)
+        if (counts[k] != expected[k])
+          mismatches++;
+
+      //------------------------------------------------//
+      // Test 1c: begin() restarts the sample           //
+      //------------------------------------------------//
+      if (round == 0)
+      {
+        sample_iterator si = sb.begin();
+        size_t again = 0;
+        for (; si != sb.end(); ++si)
+          again += si.multiplicity();
+        if (again != total)
+          TRSL_TEST_FAILURE;
+      }
+    }
+    // A boundary mismatch moves one pick between two elements.
+    if (mismatches > 2 * N_ROUNDS)
+    {
+      TRSL_TEST_FAILURE;
+      std::cout << TRSL_NVP(mismatches) << std::endl;
+    }
+  }
+
+  // ---------------------------------------------------- //
+  // Test 2: empty sample ------------------------------- //
+  // ---------------------------------------------------- //
+  {
+    ParticleArray population;
+    generatePopulation(10, population);
+    ParticleArray const& const_pop = population;
+    sample_iterator si(const_pop.begin(), const_pop.end(), 0, 1.0, wac);
+    if (si != si.end())
+      TRSL_TEST_FAILURE;
+  }
+
+  return 0;
+}
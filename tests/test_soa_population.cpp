@@ -0,0 +1,126 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <trsl/soa_population.hpp>
+#include <trsl/ppfilter_iterator.hpp>
+#include <tests/common.hpp>
+using namespace trsl::test;
+
+namespace {
+
+  struct Record
+  {
+    Record(size_t id = 0) : id(id) {}
+    size_t id;
+    double payload[8];
+  };
+
+}
+
+int main()
+{
+  // BSD has two different random generators
+  unsigned long random_seed = time(NULL)*getpid();
+  srandom(random_seed);
+  srand(random_seed);
+
+  typedef trsl::soa_population<Record> population_type;
+
+  const size_t POPULATION_SIZE = 1000;
+  const size_t SAMPLE_SIZE = 100;
+
+  population_type population;
+  population.reserve(POPULATION_SIZE);
+  double totalWeight = 0;
+  for (size_t i = 0; i < POPULATION_SIZE; ++i)
+  {
+    // Only one element in three has a positive weight.
+    double w = (i % 3 == 0) ? double(rand())/RAND_MAX : 0;
+    population.add(Record(i), w);
+    totalWeight += w;
+  }
+  population.set_weight(1, .5);
+  totalWeight += .5;
+
+  // ---------------------------------------------------- //
+  // Test 1: total weight ------------------------------- //
+  // ---------------------------------------------------- //
+  if (population.size() != POPULATION_SIZE ||
+      ! (std::fabs(population.total_weight() - totalWeight) <= 1e-9) )
+    TRSL_TEST_FAILURE;
+
+  // ---------------------------------------------------- //
+  // Test 2: records are gathered at picked indices ----- //
+  // ---------------------------------------------------- //
+  {
+    size_t size = 0;
+    for (population_type::sample_iterator si =
+           population.sample_begin(SAMPLE_SIZE);
+         si != population.sample_end(); ++si)
+    {
+      const size_t index = si.base().base() - population.weight_begin();
+      if (si->id != index || &*si != &population.record(index))
+        TRSL_TEST_FAILURE;
+      if (! (population.weight(index) > 0) )
+        TRSL_TEST_FAILURE;
+      ++size;
+    }
+    if (size != SAMPLE_SIZE)
+    {
+      TRSL_TEST_FAILURE;
+      std::cout << TRSL_NVP(size) << "\n" << TRSL_NVP(SAMPLE_SIZE) << std::endl;
+    }
+  }
+
+  // ---------------------------------------------------- //
+  // Test 3: ppfilter_iterator over the weight column -- //
+  // ---------------------------------------------------- //
+  {
+    typedef trsl::ppfilter_iterator<
+      population_type::is_picked,
+      population_type::weight_iterator> sample_iterator;
+    population_type::is_picked predicate(SAMPLE_SIZE,
+                                         population.total_weight());
+    sample_iterator sb(predicate,
+                       population.weight_begin(), population.weight_end());
+    size_t size = 0;
+    for (sample_iterator si = sb; si != sb.end(); ++si)
+    {
+      const size_t index = si.index();
+      if (population.record(index).id != index || *si != population.weight(index))
+        TRSL_TEST_FAILURE;
+      ++size;
+    }
+    if (size != SAMPLE_SIZE)
+      TRSL_TEST_FAILURE;
+  }
+
+  // ---------------------------------------------------- //
+  // Test 4: repeated weight updates -------------------- //
+  // ---------------------------------------------------- //
+  {
+    // Adding 1 to 1e16 is lost to rounding; without compensation,
+    // each update would make the total drift.
+    population_type heavy;
+    heavy.add(Record(0), 1e16);
+    heavy.add(Record(1), 0);
+    for (int i = 0; i < 1000; ++i)
+    {
+      heavy.set_weight(1, 1);
+      heavy.set_weight(1, 0);
+    }
+    if (! (heavy.total_weight() == 1e16) )
+    {
+      TRSL_TEST_FAILURE;
+      std::cout << TRSL_NVP(heavy.total_weight() - 1e16) << std::endl;
+    }
+    heavy.set_weight(1, 1);
+    heavy.set_weight(0, 0);
+    if (! (heavy.total_weight() == 1) )
+      TRSL_TEST_FAILURE;
+  }
+
+  return 0;
+}
@@ -152,6 +152,41 @@ int main()
         std::cout << TRSL_NVP(sample.size()) << "\n" << TRSL_NVP(POPULATION_SIZE) << std::endl;
       }
     }
+    //-----------------------------//
+    // Test 1e: 32-bit index type //
+    //-----------------------------//
+    {
+      typedef trsl::reorder_iterator
+        <ParticleArray::const_iterator, boost::uint32_t> compact_iterator;
+
+      permutation_iterator sb = trsl::sort_iterator
+        (const_pop.begin(), const_pop.end(), ParticleXComparator(), SAMPLE_SIZE);
+      compact_iterator cb = trsl::sort_iterator<boost::uint32_t>
+        (const_pop.begin(), const_pop.end(), ParticleXComparator(), SAMPLE_SIZE);
+      if (! (std::distance(cb, cb.end()) == std::ptrdiff_t(SAMPLE_SIZE)) )
+        TRSL_TEST_FAILURE;
+      for (compact_iterator ci = cb; ci != cb.end(); ++ci, ++sb)
+      {
+        if (! (ci->getX() == sb->getX()) )
+        {
+          TRSL_TEST_FAILURE;
+          break;
+        }
+      }
+      cb = trsl::sort_iterator<boost::uint32_t>(const_pop.begin(), const_pop.end());
+      if (! (std::distance(cb, cb.end()) == std::ptrdiff_t(POPULATION_SIZE)) )
+        TRSL_TEST_FAILURE;
+
+      // Indices of more than 2^8 elements do not fit in 8 bits.
+      bool thrown = false;
+      try {
+        trsl::sort_iterator<unsigned char>(const_pop.begin(), const_pop.end());
+      } catch (trsl::bad_parameter_value &e) {
+        thrown = true;
+      }
+      if (!thrown)
+        TRSL_TEST_FAILURE;
+    }
     
   }
   
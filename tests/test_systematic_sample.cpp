@@ -0,0 +1,287 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//#define TRSL_USE_SYSTEMATIC_INTUITIVE_ALGORITHM
+
+#include <trsl/systematic_sample.hpp>
+#include <trsl/parallel_systematic_sample.hpp>
+#include <tests/common.hpp>
+using namespace trsl::test;
+
+#include <iterator>
+
+int main()
+{
+  // BSD has two different random generators
+  unsigned long random_seed = time(NULL)*getpid();
+  srandom(random_seed);
+  srand(random_seed);
+
+  typedef std::vector<PickCountParticle> ParticleArray;
+
+  typedef trsl::is_picked_systematic<PickCountParticle> is_picked;
+
+  typedef trsl::persistent_filter_iterator
+    <is_picked, ParticleArray::const_iterator> sample_iterator;
+
+  typedef trsl::mp_weight_accessor<double, PickCountParticle> accessor;
+
+  boost::mt19937 rng((unsigned)random_seed);
+  boost::uniform_01<boost::mt19937> uni_dist(rng);
+
+  // ---------------------------------------------------- //
+  // Test 1: identity with is_picked_systematic --------- //
+  // ---------------------------------------------------- //
+  {
+    const size_t POPULATION_SIZES[] = { 1, 10, 1000, 100000 };
+    const size_t SAMPLE_SIZES[] = { 1, 3, 1000, 20000 };
+    const unsigned N_ROUNDS = 20;
+
+    for (unsigned p = 0; p < sizeof(POPULATION_SIZES)/sizeof(size_t); ++p)
+      for (unsigned s = 0; s < sizeof(SAMPLE_SIZES)/sizeof(size_t); ++s)
+        for (unsigned round = 0; round < N_ROUNDS; ++round)
+        {
+          ParticleArray population;
+          generatePopulation(POPULATION_SIZES[p], population);
+          ParticleArray const& const_pop = population;
+
+          double u = uni_dist();
+
+          //-----------------------//
+          // Test 1a: sample index //
+          //-----------------------//
+
+          std::vector<size_t> iteratorIndices;
+          is_picked predicate(SAMPLE_SIZES[s], 1.0, u, &PickCountParticle::getWeight);
+          for (sample_iterator
+                 si = sample_iterator(predicate, const_pop.begin(), const_pop.end()),
+                 se = sample_iterator(predicate, const_pop.end(), const_pop.end());
+               si != se; ++si)
+            iteratorIndices.push_back(std::distance(const_pop.begin(), si.base()));
+
+          std::vector<size_t> batchIndices;
+          trsl::systematic_sample(const_pop.begin(), const_pop.end(),
+                                  SAMPLE_SIZES[s], 1.0, u,
+                                  accessor(&PickCountParticle::getWeight),
+                                  std::back_inserter(batchIndices));
+
+          if (iteratorIndices != batchIndices)
+          {
+            TRSL_TEST_FAILURE;
+            std::cout << TRSL_NVP(iteratorIndices.size()) << "\n"
+                      << TRSL_NVP(batchIndices.size()) << std::endl;
+          }
+
+          //--------------------------//
+          // Test 1b: offspring count //
+          //--------------------------//
+
+          std::vector<size_t> counts(const_pop.size(), 0);
+          std::vector<size_t>::iterator countEnd =
+            trsl::systematic_offspring(const_pop.begin(), const_pop.end(),
+                                       SAMPLE_SIZES[s], 1.0, u,
+                                       accessor(&PickCountParticle::getWeight),
+                                       counts.begin());
+          if (countEnd != counts.end())
+            TRSL_TEST_FAILURE;
+
+          std::vector<size_t> expanded;
+          for (size_t i = 0; i < counts.size(); ++i)
+            expanded.insert(expanded.end(), counts[i], i);
+          if (expanded != batchIndices)
+            TRSL_TEST_FAILURE;
+        }
+  }
+
+  // ---------------------------------------------------- //
+  // Test 2: empty sample ------------------------------- //
+  // ---------------------------------------------------- //
+  {
+    ParticleArray population;
+    generatePopulation(1000, population);
+
+    std::vector<size_t> indices;
+    trsl::systematic_sample(population.begin(), population.end(),
+                            0, 1.0,
+                            accessor(&PickCountParticle::getWeight),
+                            std::back_inserter(indices));
+    if (!indices.empty())
+      TRSL_TEST_FAILURE;
+
+    std::vector<size_t> counts(population.size(), 1);
+    trsl::systematic_offspring(population.begin(), population.end(),
+                               0, 1.0,
+                               accessor(&PickCountParticle::getWeight),
+                               counts.begin());
+    if (std::count(counts.begin(), counts.end(), size_t(0)) != long(counts.size()))
+      TRSL_TEST_FAILURE;
+  }
+
+  // ---------------------------------------------------- //
+  // Test 3: forward-only population -------------------- //
+  // ---------------------------------------------------- //
+  {
+    const size_t POPULATION_SIZE = 1000;
+    const size_t SAMPLE_SIZE = 100;
+
+    std::list<PickCountParticle> population;
+    generatePopulation(POPULATION_SIZE, population);
+
+    std::vector<size_t> indices;
+    trsl::systematic_sample(population.begin(), population.end(),
+                            SAMPLE_SIZE, 1.0,
+                            accessor(&PickCountParticle::getWeight),
+                            std::back_inserter(indices));
+    if (indices.size() != SAMPLE_SIZE)
+    {
+      TRSL_TEST_FAILURE;
+      std::cout << TRSL_NVP(indices.size()) << "\n" << TRSL_NVP(SAMPLE_SIZE) << std::endl;
+    }
+    for (size_t i = 1; i < indices.size(); ++i)
+      if (indices[i-1] > indices[i] || indices[i] >= POPULATION_SIZE)
+        TRSL_TEST_FAILURE;
+  }
+
+  // ---------------------------------------------------- //
+  // Test 4: identity of the multithreaded versions ----- //
+  // ---------------------------------------------------- //
+  {
+#ifdef _OPENMP
+    // Chunking only happens with several threads, even if they have
+    // to share a core.
+    omp_set_num_threads(4);
+#endif
+    const size_t POPULATION_SIZES[] = { 1000, 100000, 1000000 };
+    const size_t SAMPLE_SIZES[] = { 1, 1000, 100000, 1000000 };
+    const unsigned N_ROUNDS = 4;
+
+    for (unsigned p = 0; p < sizeof(POPULATION_SIZES)/sizeof(size_t); ++p)
+      for (unsigned s = 0; s < sizeof(SAMPLE_SIZES)/sizeof(size_t); ++s)
+        for (unsigned round = 0; round < N_ROUNDS; ++round)
+        {
+          ParticleArray population;
+          generatePopulation(POPULATION_SIZES[p], population);
+          ParticleArray const& const_pop = population;
+
+          double u = uni_dist();
+          accessor wac(&PickCountParticle::getWeight);
+
+          //-----------------------//
+          // Test 4a: sample index //
+          //-----------------------//
+
+          std::vector<size_t> serialIndices;
+          trsl::systematic_sample(const_pop.begin(), const_pop.end(),
+                                  SAMPLE_SIZES[s], 1.0, u, wac,
+                                  std::back_inserter(serialIndices));
+
+          std::vector<size_t> parallelIndices(serialIndices.size() + 2);
+          std::vector<size_t>::iterator indexEnd =
+            trsl::parallel_systematic_sample(const_pop.begin(), const_pop.end(),
+                                             SAMPLE_SIZES[s], 1.0, u, wac,
+                                             parallelIndices.begin());
+          parallelIndices.erase(indexEnd, parallelIndices.end());
+
+          if (serialIndices != parallelIndices)
+          {
+            TRSL_TEST_FAILURE;
+            std::cout << TRSL_NVP(POPULATION_SIZES[p]) << "\n"
+                      << TRSL_NVP(SAMPLE_SIZES[s]) << "\n"
+                      << TRSL_NVP(serialIndices.size()) << "\n"
+                      << TRSL_NVP(parallelIndices.size()) << std::endl;
+          }
+
+          //--------------------------//
+          // Test 4b: offspring count //
+          //--------------------------//
+
+          std::vector<size_t> serialCounts(const_pop.size());
+          trsl::systematic_offspring(const_pop.begin(), const_pop.end(),
+                                     SAMPLE_SIZES[s], 1.0, u, wac,
+                                     serialCounts.begin());
+          std::vector<size_t> parallelCounts(const_pop.size());
+          std::vector<size_t>::iterator countEnd =
+            trsl::parallel_systematic_offspring(const_pop.begin(), const_pop.end(),
+                                                SAMPLE_SIZES[s], 1.0, u, wac,
+                                                parallelCounts.begin());
+          if (countEnd != parallelCounts.end() ||
+              serialCounts != parallelCounts)
+            TRSL_TEST_FAILURE;
+        }
+  }
+
+  // ---------------------------------------------------- //
+  // Test 5: exact products ----------------------------- //
+  // ---------------------------------------------------- //
+  {
+    // (1 + 2^-k)^2 = 1 + 2^(1-k) + 2^-2k, whose last term is lost
+    // when rounding to WeightType.
+    float fhi, flo;
+    const float fa = 1 + std::ldexp(1.0f, -15);
+    trsl::detail::exact_product(fa, fa, fhi, flo);
+    if (! (fhi == 1 + std::ldexp(1.0f, -14) && flo == std::ldexp(1.0f, -30)) )
+      TRSL_TEST_FAILURE;
+    double dhi, dlo;
+    const double da = 1 + std::ldexp(1.0, -30);
+    trsl::detail::exact_product(da, da, dhi, dlo);
+    if (! (dhi == 1 + std::ldexp(1.0, -29) && dlo == std::ldexp(1.0, -60)) )
+      TRSL_TEST_FAILURE;
+    long double lhi, llo;
+    const int k = std::numeric_limits<long double>::digits / 2 + 1;
+    const long double la = 1 + std::ldexp(1.0L, -k);
+    trsl::detail::exact_product(la, la, lhi, llo);
+    if (! (lhi == 1 + std::ldexp(1.0L, 1 - k) && llo == std::ldexp(1.0L, -2 * k)) )
+      TRSL_TEST_FAILURE;
+  }
+
+  // ---------------------------------------------------- //
+  // Test 6: output bound ------------------------------- //
+  // ---------------------------------------------------- //
+  {
+    // An understated population weight makes the walk pick about
+    // twice as many elements as requested. The output should still
+    // fit in sampleSize indices.
+    const size_t POPULATION_SIZE = 1000000;
+    const size_t SAMPLE_SIZE = 1000;
+    const size_t GUARD = size_t(-1);
+
+    ParticleArray population;
+    generatePopulation(POPULATION_SIZE, population);
+    ParticleArray const& const_pop = population;
+    accessor wac(&PickCountParticle::getWeight);
+    double u = uni_dist();
+
+    std::vector<size_t> indices(SAMPLE_SIZE + 1, GUARD);
+    std::vector<size_t>::iterator end =
+      trsl::systematic_sample(const_pop.begin(), const_pop.end(),
+                              SAMPLE_SIZE, .5, u, wac, indices.begin());
+    if (! (end - indices.begin() == std::ptrdiff_t(SAMPLE_SIZE) &&
+           indices.back() == GUARD) )
+      TRSL_TEST_FAILURE;
+
+    std::vector<size_t> parallelIndices(SAMPLE_SIZE + 1, GUARD);
+    end = trsl::parallel_systematic_sample(const_pop.begin(), const_pop.end(),
+                                           SAMPLE_SIZE, .5, u, wac,
+                                           parallelIndices.begin());
+    if (! (end - parallelIndices.begin() == std::ptrdiff_t(SAMPLE_SIZE) &&
+           parallelIndices == indices) )
+      TRSL_TEST_FAILURE;
+
+    // Offspring counts are capped in the same way.
+    std::vector<size_t> counts(POPULATION_SIZE), parallelCounts(POPULATION_SIZE);
+    trsl::systematic_offspring(const_pop.begin(), const_pop.end(),
+                               SAMPLE_SIZE, .5, u, wac, counts.begin());
+    trsl::parallel_systematic_offspring(const_pop.begin(), const_pop.end(),
+                                        SAMPLE_SIZE, .5, u, wac,
+                                        parallelCounts.begin());
+    std::vector<size_t> expected(POPULATION_SIZE, 0);
+    for (size_t i = 0; i < SAMPLE_SIZE; ++i)
+      expected[indices[i]]++;
+    if (! (counts == expected && parallelCounts == expected) )
+      TRSL_TEST_FAILURE;
+  }
+
+  return 0;
+}
@@ -0,0 +1,214 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <trsl/weighted_reservoir.hpp>
+#include <tests/common.hpp>
+using namespace trsl::test;
+
+#include <algorithm>
+
+unsigned long random_seed = time(NULL)*getpid();
+
+typedef std::vector<PickCountParticle> ParticleArray;
+
+// Sampling indices lets tests identify sampled elements.
+struct index_accessor
+{
+  index_accessor(ParticleArray const* population = NULL) :
+    population_(population) {}
+  double operator()(size_t i) const
+    {
+      return (*population_)[i].getWeight();
+    }
+  ParticleArray const* population_;
+};
+
+typedef trsl::weighted_reservoir<size_t, double, index_accessor> reservoir;
+
+int main()
+{
+  // BSD has two different random generators
+  srandom(random_seed);
+  srand(random_seed);
+
+  // ---------------------------------------------------- //
+  // Test 1: single-element reservoir ------------------- //
+  // ---------------------------------------------------- //
+  {
+    // A one-element reservoir holds each element with a probability
+    // equal to its normalized weight.
+    const size_t POPULATION_SIZE = 100;
+    const size_t N_TRIALS = 200000;
+
+    ParticleArray population;
+    generatePopulation(POPULATION_SIZE, population);
+    // Elements with a null weight should never be picked.
+    population[7].setWeight(0);
+    population[42].setWeight(0);
+
+    double totalWeight = 0;
+    for (size_t i = 0; i < POPULATION_SIZE; ++i)
+      totalWeight += population[i].getWeight();
+
+    reservoir r(1, boost::uint32_t(rand()), index_accessor(&population));
+    std::vector<size_t> counts(POPULATION_SIZE, 0);
+    for (size_t trial = 0; trial < N_TRIALS; ++trial)
+    {
+      r.clear();
+      for (size_t i = 0; i < POPULATION_SIZE; ++i)
+        r.push(i);
+      if (r.size() != 1)
+        TRSL_TEST_FAILURE;
+      counts.at(*r.begin())++;
+    }
+
+    for (size_t i = 0; i < POPULATION_SIZE; ++i)
+    {
+      double weight = population[i].getWeight() / totalWeight;
+      double pickProp = double(counts[i]) / N_TRIALS;
+      if (! ( std::fabs(POPULATION_SIZE * weight -
+                        POPULATION_SIZE * pickProp) <= 1e-1) ||
+          (weight == 0 && counts[i] != 0))
+      {
+        TRSL_TEST_FAILURE;
+        std::cout << "Element " << i
+                  << ": weight = " << int(100 * POPULATION_SIZE *
+                                          weight) << "%"
+                  << ", pickp = " << int(100 * POPULATION_SIZE *
+                                         pickProp) << "%"
+                  << std::endl;
+      }
+    }
+  }
+
+  // ---------------------------------------------------- //
+  // Test 2: inclusion probabilities -------------------- //
+  // ---------------------------------------------------- //
+  {
+    // With two draws without replacement, element i is included with
+    // probability p_i + sum_{j != i} p_j p_i / (1 - p_j).
+    const size_t POPULATION_SIZE = 5;
+    const size_t N_TRIALS = 400000;
+    const double WEIGHTS[POPULATION_SIZE] = { .4, .05, .25, .2, .1 };
+
+    ParticleArray population;
+    for (size_t i = 0; i < POPULATION_SIZE; ++i)
+      population.push_back(PickCountParticle(WEIGHTS[i], 0, 0));
+
+    reservoir r(2, boost::uint32_t(rand()), index_accessor(&population));
+    std::vector<size_t> counts(POPULATION_SIZE, 0);
+    std::vector<size_t> stream(POPULATION_SIZE);
+    for (size_t i = 0; i < POPULATION_SIZE; ++i)
+      stream[i] = i;
+    for (size_t trial = 0; trial < N_TRIALS; ++trial)
+    {
+      r.clear();
+      r.push(stream.begin(), stream.end());
+      if (r.size() != 2 || *r.begin() == *(r.begin() + 1))
+        TRSL_TEST_FAILURE;
+      for (reservoir::const_iterator i = r.begin(); i != r.end(); ++i)
+        counts.at(*i)++;
+    }
+
+    for (size_t i = 0; i < POPULATION_SIZE; ++i)
+    {
+      double expected = WEIGHTS[i];
+      for (size_t j = 0; j < POPULATION_SIZE; ++j)
+        if (j != i)
+          expected += WEIGHTS[j] * WEIGHTS[i] / (1 - WEIGHTS[j]);
+      double pickProp = double(counts[i]) / N_TRIALS;
+      if (! (std::fabs(expected - pickProp) <= 5e-3) )
+      {
+        TRSL_TEST_FAILURE;
+        std::cout << "Element " << i
+                  << ": expected = " << expected
+                  << ", pickp = " << pickProp << std::endl;
+      }
+    }
+  }
+
+  // ---------------------------------------------------- //
+  // Test 3: single pass, reproducibility --------------- //
+  // ---------------------------------------------------- //
+  {
+    const size_t POPULATION_SIZE = 100000;
+    const size_t SAMPLE_SIZE = 100;
+
+    ParticleArray population;
+    generatePopulation(POPULATION_SIZE, population);
+    for (size_t i = 0; i < POPULATION_SIZE; i += 3)
+      population[i].setWeight(0);
+
+    std::list<size_t> stream;
+    for (size_t i = 0; i < POPULATION_SIZE; ++i)
+      stream.push_back(i);
+
+    boost::uint32_t seed = rand();
+
+    //-------------------------------------------------//
+    // Test 3a: range and element-wise pushes coincide //
+    //-------------------------------------------------//
+    reservoir byRange(SAMPLE_SIZE, seed, index_accessor(&population));
+    byRange.push(stream.begin(), stream.end());
+    reservoir byElement(SAMPLE_SIZE, seed, index_accessor(&population));
+    for (std::list<size_t>::const_iterator i = stream.begin();
+         i != stream.end(); ++i)
+      byElement.push(*i);
+    if (byRange.size() != SAMPLE_SIZE ||
+        !std::equal(byRange.begin(), byRange.end(), byElement.begin()))
+      TRSL_TEST_FAILURE;
+
+    //--------------------------------------------------//
+    // Test 3b: no duplicates, no null-weight elements //
+    //--------------------------------------------------//
+    std::vector<size_t> sample(byRange.begin(), byRange.end());
+    std::sort(sample.begin(), sample.end());
+    if (std::adjacent_find(sample.begin(), sample.end()) != sample.end())
+      TRSL_TEST_FAILURE;
+    for (size_t i = 0; i < sample.size(); ++i)
+      if (population[sample[i]].getWeight() == 0)
+        TRSL_TEST_FAILURE;
+
+    //--------------------------//
+    // Test 3c: different seeds //
+    //--------------------------//
+    reservoir other(SAMPLE_SIZE, seed + 1, index_accessor(&population));
+    other.push(stream.begin(), stream.end());
+    if (std::equal(byRange.begin(), byRange.end(), other.begin()))
+      TRSL_TEST_FAILURE;
+  }
+
+  // ---------------------------------------------------- //
+  // Test 4: short streams ------------------------------ //
+  // ---------------------------------------------------- //
+  {
+    // Streams shorter than the reservoir are kept entirely,
+    // including null-weight elements.
+    const size_t POPULATION_SIZE = 10;
+
+    ParticleArray population;
+    generatePopulation(POPULATION_SIZE, population);
+    population[3].setWeight(0);
+
+    reservoir r(20, index_accessor(&population));
+    for (size_t i = 0; i < POPULATION_SIZE; ++i)
+      r.push(i);
+    std::vector<size_t> sample(r.begin(), r.end());
+    std::sort(sample.begin(), sample.end());
+    if (sample.size() != POPULATION_SIZE)
+      TRSL_TEST_FAILURE;
+    for (size_t i = 0; i < sample.size(); ++i)
+      if (sample[i] != i)
+        TRSL_TEST_FAILURE;
+
+    reservoir empty(0, index_accessor(&population));
+    for (size_t i = 0; i < POPULATION_SIZE; ++i)
+      empty.push(i);
+    if (empty.size() != 0)
+      TRSL_TEST_FAILURE;
+  }
+
+  return 0;
+}
@@ -0,0 +1,172 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <trsl/weighted_sample_without_replacement.hpp>
+#include <tests/common.hpp>
+using namespace trsl::test;
+
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+unsigned long random_seed = time(NULL)*getpid();
+
+typedef std::vector<PickCountParticle> ParticleArray;
+typedef trsl::mp_weight_accessor<double, PickCountParticle> accessor;
+typedef trsl::reorder_iterator<ParticleArray::const_iterator> sample_iterator;
+
+// Indices of the sample, in sampling order.
+std::vector<size_t> sample_indices(sample_iterator si)
+{
+  std::vector<size_t> indices;
+  for (sample_iterator i = si.begin(); i != si.end(); ++i)
+    indices.push_back(i.index());
+  return indices;
+}
+
+int main()
+{
+  // BSD has two different random generators
+  srandom(random_seed);
+  srand(random_seed);
+
+  accessor wac(&PickCountParticle::getWeight);
+
+  // ---------------------------------------------------- //
+  // Test 1: draw probabilities ------------------------- //
+  // ---------------------------------------------------- //
+  {
+    // The first element of the sample is element i with probability
+    // p_i. Element i is in a sample of two elements with probability
+    // p_i + sum_{j != i} p_j p_i / (1 - p_j).
+    const size_t POPULATION_SIZE = 5;
+    const size_t N_TRIALS = 400000;
+    const double WEIGHTS[POPULATION_SIZE] = { .4, .05, .25, .2, .1 };
+
+    ParticleArray population;
+    for (size_t i = 0; i < POPULATION_SIZE; ++i)
+      population.push_back(PickCountParticle(WEIGHTS[i], 0, 0));
+    ParticleArray const& const_pop = population;
+
+    std::vector<size_t> firstCounts(POPULATION_SIZE, 0);
+    std::vector<size_t> counts(POPULATION_SIZE, 0);
+    for (size_t trial = 0; trial < N_TRIALS; ++trial)
+    {
+      std::vector<size_t> indices =
+        sample_indices(trsl::weighted_sample_without_replacement
+                       (const_pop.begin(), const_pop.end(), 2,
+                        boost::uint32_t(trial + random_seed), wac));
+      if (indices.size() != 2 || indices[0] == indices[1])
+        TRSL_TEST_FAILURE;
+      firstCounts.at(indices[0])++;
+      counts.at(indices[0])++;
+      counts.at(indices[1])++;
+    }
+
+    for (size_t i = 0; i < POPULATION_SIZE; ++i)
+    {
+      double expected = WEIGHTS[i];
+      for (size_t j = 0; j < POPULATION_SIZE; ++j)
+        if (j != i)
+          expected += WEIGHTS[j] * WEIGHTS[i] / (1 - WEIGHTS[j]);
+      double firstProp = double(firstCounts[i]) / N_TRIALS;
+      double pickProp = double(counts[i]) / N_TRIALS;
+      if (! (std::fabs(WEIGHTS[i] - firstProp) <= 5e-3) ||
+          ! (std::fabs(expected - pickProp) <= 5e-3) )
+      {
+        TRSL_TEST_FAILURE;
+        std::cout << "Element " << i
+                  << ": weight = " << WEIGHTS[i]
+                  << ", firstp = " << firstProp
+                  << ", expected = " << expected
+                  << ", pickp = " << pickProp << std::endl;
+      }
+    }
+  }
+
+  // ---------------------------------------------------- //
+  // Test 2: large population --------------------------- //
+  // ---------------------------------------------------- //
+  {
+    const size_t POPULATION_SIZE = 100000;
+    const size_t SAMPLE_SIZE = 1000;
+
+    ParticleArray population;
+    generatePopulation(POPULATION_SIZE, population);
+    for (size_t i = 0; i < POPULATION_SIZE; i += 2)
+      population[i].setWeight(0);
+    ParticleArray const& const_pop = population;
+    boost::uint32_t seed = rand();
+
+    std::vector<size_t> first =
+      sample_indices(trsl::weighted_sample_without_replacement
+                     (const_pop.begin(), const_pop.end(),
+                      SAMPLE_SIZE, seed, wac));
+
+    //--------------------------------------------------//
+    // Test 2a: distinct elements, no null-weight picks //
+    //--------------------------------------------------//
+    std::vector<size_t> sorted(first);
+    std::sort(sorted.begin(), sorted.end());
+    if (first.size() != SAMPLE_SIZE ||
+        std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end())
+      TRSL_TEST_FAILURE;
+    for (size_t i = 0; i < first.size(); ++i)
+      if (population[first[i]].getWeight() == 0)
+        TRSL_TEST_FAILURE;
+
+#ifdef _OPENMP
+    //--------------------------------//
+    // Test 2b: any number of threads //
+    //--------------------------------//
+    const int maxThreads = omp_get_max_threads();
+    omp_set_num_threads(3);
+    std::vector<size_t> second =
+      sample_indices(trsl::weighted_sample_without_replacement
+                     (const_pop.begin(), const_pop.end(),
+                      SAMPLE_SIZE, seed, wac));
+    omp_set_num_threads(maxThreads);
+    if (first != second)
+      TRSL_TEST_FAILURE;
+#endif
+
+    //----------------------------------------------------//
+    // Test 2c: null-weight elements come last, in order //
+    //----------------------------------------------------//
+    std::vector<size_t> all =
+      sample_indices(trsl::weighted_sample_without_replacement
+                     (const_pop.begin(), const_pop.end(),
+                      POPULATION_SIZE, seed, wac));
+    if (all.size() != POPULATION_SIZE)
+      TRSL_TEST_FAILURE;
+    for (size_t i = POPULATION_SIZE / 2; i < all.size(); ++i)
+      if (all[i] != 2 * (i - POPULATION_SIZE / 2))
+      {
+        TRSL_TEST_FAILURE;
+        break;
+      }
+  }
+
+  // ---------------------------------------------------- //
+  // Test 3: bad parameters ----------------------------- //
+  // ---------------------------------------------------- //
+  {
+    ParticleArray population;
+    generatePopulation(10, population);
+    bool thrown = false;
+    try {
+      trsl::weighted_sample_without_replacement(population.begin(),
+                                                population.end(),
+                                                11, wac);
+    } catch (trsl::bad_parameter_value &e) {
+      thrown = true;
+    }
+    if (!thrown)
+      TRSL_TEST_FAILURE;
+  }
+
+  return 0;
+}
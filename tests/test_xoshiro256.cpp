@@ -0,0 +1,175 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <trsl/xoshiro256.hpp>
+#include <trsl/is_picked_systematic.hpp>
+#include <trsl/ppfilter_iterator.hpp>
+#include <trsl/random_permutation_iterator.hpp>
+#include <tests/common.hpp>
+using namespace trsl::test;
+
+int main()
+{
+  // BSD has two different random generators
+  unsigned long random_seed = time(NULL)*getpid();
+  srandom(random_seed);
+  srand(random_seed);
+
+  // ---------------------------------------------------- //
+  // Test 1: engine ------------------------------------- //
+  // ---------------------------------------------------- //
+  {
+    const size_t N = 100000;
+
+    //------------------------------------------------//
+    // Test 1a: fill() matches individual calls       //
+    //------------------------------------------------//
+    trsl::xoshiro256 g(random_seed), h(random_seed);
+    std::vector<boost::uint64_t> buffer(N);
+    g.fill(&buffer[0], &buffer[0] + N);
+    for (size_t i = 0; i < N; ++i)
+      if (buffer[i] != h())
+      {
+        TRSL_TEST_FAILURE;
+        break;
+      }
+    if (g != h)
+      TRSL_TEST_FAILURE;
+
+    //------------------------------------------------//
+    // Test 1b: fill_01() range and mean              //
+    //------------------------------------------------//
+    std::vector<double> reals(N);
+    g.fill_01(&reals[0], &reals[0] + N);
+    double sum = 0;
+    for (size_t i = 0; i < N; ++i)
+    {
+      if (! (reals[i] >= 0 && reals[i] < 1) )
+        TRSL_TEST_FAILURE;
+      sum += reals[i];
+    }
+    // The standard deviation of the mean is 1/sqrt(12 N) ~ 1e-3.
+    if (! (std::fabs(sum / N - .5) < 5e-3) )
+    {
+      TRSL_TEST_FAILURE;
+      std::cout << TRSL_NVP(sum / N) << std::endl;
+    }
+    std::vector<float> floats(N);
+    g.fill_01(&floats[0], &floats[0] + N);
+    for (size_t i = 0; i < N; ++i)
+      if (! (floats[i] >= 0 && floats[i] < 1) )
+        TRSL_TEST_FAILURE;
+    if (! (trsl::xoshiro256::to_01<float>(~boost::uint64_t(0)) < 1) ||
+        ! (trsl::xoshiro256::to_01<double>(~boost::uint64_t(0)) < 1) )
+      TRSL_TEST_FAILURE;
+
+    //------------------------------------------------//
+    // Test 1c: jump() gives a different stream       //
+    //------------------------------------------------//
+    trsl::xoshiro256 j = h;
+    j.jump();
+    size_t equal = 0;
+    for (size_t i = 0; i < 1000; ++i)
+      if (j() == h()) ++equal;
+    if (equal > 0)
+      TRSL_TEST_FAILURE;
+
+    //------------------------------------------------//
+    // Test 1d: uniform_01() matches fill_01()        //
+    //------------------------------------------------//
+    trsl::xoshiro256 u = h;
+    h.fill_01(&reals[0], &reals[0] + N);
+    h.fill_01(&floats[0], &floats[0] + N);
+    for (size_t i = 0; i < N; ++i)
+      if (trsl::rand_gen::uniform_01<double>(u) != reals[i])
+      {
+        TRSL_TEST_FAILURE;
+        break;
+      }
+    for (size_t i = 0; i < N; ++i)
+      if (trsl::rand_gen::uniform_01<float>(u) != floats[i])
+      {
+        TRSL_TEST_FAILURE;
+        break;
+      }
+  }
+
+  // ---------------------------------------------------- //
+  // Test 2: user generators in factories --------------- //
+  // ---------------------------------------------------- //
+  {
+    typedef std::vector<PickCountParticle> ParticleArray;
+    typedef trsl::is_picked_systematic<PickCountParticle> is_picked;
+    typedef trsl::ppfilter_iterator<
+      is_picked, ParticleArray::const_iterator> sample_iterator;
+    typedef trsl::reorder_iterator<
+      ParticleArray::const_iterator> permutation_iterator;
+
+    const size_t POPULATION_SIZE = 1000;
+    const size_t SAMPLE_SIZE = 100;
+
+    ParticleArray population;
+    generatePopulation(POPULATION_SIZE, population);
+    ParticleArray const& const_pop = population;
+
+    //------------------------------------------------//
+    // Test 2a: random_permutation_iterator           //
+    //------------------------------------------------//
+    trsl::xoshiro256 g(random_seed), h(random_seed);
+    permutation_iterator p =
+      trsl::random_permutation_iterator(const_pop.begin(), const_pop.end(), g);
+    permutation_iterator q =
+      trsl::random_permutation_iterator(const_pop.begin(), const_pop.end(), h);
+    std::vector<bool> seen(POPULATION_SIZE, false);
+    size_t size = 0;
+    for (; p != p.end(); ++p, ++q)
+    {
+      if (p.index() != q.index() || seen[p.index()])
+        TRSL_TEST_FAILURE;
+      seen[p.index()] = true;
+      ++size;
+    }
+    if (size != POPULATION_SIZE)
+      TRSL_TEST_FAILURE;
+
+    boost::mt19937 mt((unsigned)random_seed);
+    p = trsl::random_permutation_iterator(const_pop.begin(), const_pop.end(),
+                                          SAMPLE_SIZE, mt);
+    if (std::distance(p, p.end()) != std::ptrdiff_t(SAMPLE_SIZE))
+      TRSL_TEST_FAILURE;
+
+    //------------------------------------------------//
+    // Test 2b: is_picked_systematic                  //
+    //------------------------------------------------//
+    trsl::xoshiro256 k = g;
+    is_picked a(SAMPLE_SIZE, 1.0, g, &PickCountParticle::getWeight);
+    is_picked b(SAMPLE_SIZE, 1.0,
+                trsl::rand_gen::uniform_01<double>(k),
+                &PickCountParticle::getWeight);
+    if (! (a == b) )
+      TRSL_TEST_FAILURE;
+
+    //------------------------------------------------//
+    // Test 2c: ppfilter_iterator                     //
+    //------------------------------------------------//
+    h = g;
+    sample_iterator sa(a, const_pop.begin(), const_pop.end(), g);
+    sample_iterator sb(a, const_pop.begin(), const_pop.end(), h);
+    size = 0;
+    for (; sa != sa.end(); ++sa, ++sb)
+    {
+      if (sa.index() != sb.index())
+        TRSL_TEST_FAILURE;
+      ++size;
+    }
+    if (size != SAMPLE_SIZE)
+    {
+      TRSL_TEST_FAILURE;
+      std::cout << TRSL_NVP(size) << std::endl;
+    }
+  }
+
+  return 0;
+}
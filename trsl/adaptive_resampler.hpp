@@ -0,0 +1,131 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+/** @file */
+
+#ifndef TRSL_ADAPTIVE_RESAMPLER_HPP
+#define TRSL_ADAPTIVE_RESAMPLER_HPP
+
+#include <trsl/error_handling.hpp>
+#include <trsl/common.hpp>
+#include <trsl/ppfilter_iterator.hpp>
+#include <trsl/weight_statistics.hpp>
+
+namespace trsl
+{
+
+  /**
+   * @brief Resamples a population only when its effective sample
+   * size is too small.
+   *
+   * Resampling a population whose weights are nearly uniform wastes
+   * a permutation and a copy of the population, and adds noise. A
+   * common strategy is to resample only when the effective sample
+   * size (see weight_statistics) drops below a fraction of the
+   * population size.
+   *
+   * The constructor computes the weight_statistics of the population
+   * in a single pass. If the effective sample size is below
+   * <tt>threshold * populationSize</tt>, it builds a ppfilter_iterator
+   * over a sample of the population, reusing the population weight
+   * computed along with the statistics; otherwise it builds nothing.
+   * resampled() reports the decision; begin() and end() go through
+   * the sample, which is empty if the population was not resampled.
+   *
+   * @p Predicate is a sampling predicate, e.g. is_picked_systematic,
+   * that provides <tt>weight_type</tt> and
+   * <tt>weight_accessor_type</tt> typedefs and a constructor taking
+   * a sample size, a population weight and a weight accessor.
+   *
+   * @p ElementIterator should model <em>Random Access Iterator</em>.
+   */
+  template<class Predicate, class ElementIterator>
+  class adaptive_resampler
+  {
+  public:
+    typedef ppfilter_iterator<Predicate, ElementIterator> sample_iterator;
+    typedef typename Predicate::weight_type weight_type;
+    typedef typename Predicate::weight_accessor_type weight_accessor_type;
+
+    /**
+     * @brief Computes the weight statistics of [@p first, @p last),
+     * and samples it if its effective sample size is too small.
+     *
+     * @param sampleSize Number of elements in the sample, within
+     * <tt>[0, infinity[</tt>.
+     *
+     * @param threshold The population is resampled if its effective
+     * sample size is strictly smaller than <tt>threshold *
+     * populationSize</tt>. Within <tt>[0, 1]</tt>; 0.5 is a common
+     * choice.
+     *
+     * @param wac Weight accessor, see @ref accessor.
+     *
+     * Throws a bad_parameter_value if @p threshold is out of range,
+     * or if the population has to be resampled but its weight is
+     * null.
+     */
+    adaptive_resampler(ElementIterator first,
+                       ElementIterator last,
+                       size_t sampleSize,
+                       weight_type threshold,
+                       weight_accessor_type const& wac = weight_accessor_type())
+      {
+        if (! (threshold >= 0 && threshold <= 1) )
+          throw bad_parameter_value(
+            "adaptive_resampler: "
+            "parameter threshold out of range.");
+        statistics_ =
+          compute_weight_statistics<weight_type>(first, last, wac);
+        resampled_ = statistics_.effectiveSampleSize <
+          threshold * weight_type(statistics_.populationSize);
+        if (resampled_)
+        {
+          if (! (statistics_.populationWeight > 0) )
+            throw bad_parameter_value(
+              "adaptive_resampler: "
+              "population weight must be strictly positive.");
+          sample_ = sample_iterator(Predicate(sampleSize,
+                                              statistics_.populationWeight,
+                                              wac),
+                                    first, last);
+        }
+        else
+          sample_ = sample_iterator(Predicate(), last, last);
+      }
+
+    /**
+     * @brief Returns whether the population was resampled.
+     */
+    bool resampled() const { return resampled_; }
+
+    /**
+     * @brief Returns the statistics of the population weights, on
+     * which the decision was based.
+     */
+    weight_statistics<weight_type> const& statistics() const
+      { return statistics_; }
+
+    /**
+     * @brief Returns an iterator to the beginning of the sample.
+     *
+     * If the population was not resampled, begin() == end().
+     */
+    sample_iterator begin() const { return sample_.begin(); }
+
+    /**
+     * @brief Returns an iterator to the end of the sample.
+     */
+    sample_iterator end() const { return sample_.end(); }
+
+  private:
+    weight_statistics<weight_type> statistics_;
+    bool resampled_;
+    sample_iterator sample_;
+  };
+
+} // namespace trsl
+
+#endif // include guard
@@ -0,0 +1,329 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+/** @file */
+
+#ifndef TRSL_ALIAS_TABLE_HPP
+#define TRSL_ALIAS_TABLE_HPP
+
+#include <trsl/common.hpp>
+#include <trsl/error_handling.hpp>
+#include <trsl/weight_accessor.hpp>
+
+#include <vector>
+#include <limits>
+#include <boost/static_assert.hpp>
+#include <boost/mpl/has_xxx.hpp>
+#include <boost/type_traits/integral_constant.hpp>
+#include <boost/type_traits/is_integral.hpp>
+
+namespace trsl {
+
+  namespace detail {
+
+    BOOST_MPL_HAS_XXX_TRAIT_DEF(result_type)
+
+    // Whether G is a Uniform Random Number Generator (integer
+    // results), rather than a functor returning reals in [0,1[.
+    template<class G, bool = has_result_type<G>::value>
+    struct is_integer_generator : boost::false_type {};
+
+    template<class G>
+    struct is_integer_generator<G, true> :
+      boost::is_integral<typename G::result_type> {};
+
+  }
+
+  /**
+   * @brief Walker's alias table, for repeated independent draws from
+   * a fixed weighted population.
+   *
+   * A sample iterator (e.g. is_picked_systematic with
+   * persistent_filter_iterator) walks through the whole population to
+   * produce a sample. If single elements are drawn many times from
+   * the same population, each draw thus costs <em>O(n)</em>. The alias
+   * method [1, 2] instead preprocesses the population weights in
+   * <em>O(n)</em> into a table of @p n buckets, after which each draw
+   * takes <em>O(1)</em>: a random bucket is selected, and a uniform
+   * number decides between the bucket's own element and its
+   * <em>alias</em>.
+   *
+   * Draws are independent, i.e. a series of draws forms a
+   * multinomial sample of the population.
+   *
+   * The table stores indices into the population, not elements. A
+   * draw returns the index of an element relative to the beginning of
+   * the range the table was built from. The table is built with
+   * Vose's algorithm [2], which is numerically stable.
+   *
+   * @param WeightType Element weight type, should be a floating point type.
+   * Defaults to <tt>double</tt>.
+   *
+   * <b>References:</b>
+   *
+   * - [1] A. J. Walker. An efficient method for generating discrete
+   * random variables with general distributions. ACM Transactions on
+   * Mathematical Software, 3(3):253-256, 1977.
+   *
+   * - [2] M. D. Vose. A linear algorithm for generating random
+   * numbers with a given distribution. IEEE Transactions on Software
+   * Engineering, 17(9):972-975, 1991.
+   */
+  template<typename WeightType = double>
+  class alias_table
+  {
+  private:
+    BOOST_STATIC_ASSERT((std::numeric_limits<WeightType>::is_integer == false));
+  public:
+    typedef WeightType weight_type;
+
+    /**
+     * @brief Constructs an empty table. An empty table cannot be
+     * drawn from; see assign().
+     */
+    alias_table() {}
+
+    /**
+     * @brief Constructs a table for the population [@p first,
+     * @p last).
+     *
+     * See assign().
+     */
+    template<class ElementIterator, class WeightAccessor>
+    alias_table(ElementIterator first, ElementIterator last,
+                WeightAccessor const& wac)
+      {
+        assign(first, last, wac);
+      }
+
+    /**
+     * @brief Rebuilds the table for the population [@p first,
+     * @p last).
+     *
+     * The population is read once, through @p wac. @p ElementIterator
+     * should model <em>Input Iterator</em>. Storage allocated by
+     * previous calls is reused whenever possible.
+     *
+     * Throws a bad_parameter_value if the population is empty, or if
+     * its total weight is not strictly positive.
+     *
+     * @param wac Weight accessor, see @ref accessor. Note that a bare
+     * method pointer is not an accessor; wrap it in a
+     * trsl::mp_weight_accessor.
+     */
+    template<class ElementIterator, class WeightAccessor>
+    void assign(ElementIterator first, ElementIterator last,
+                WeightAccessor const& wac)
+      {
+        buckets_.clear();
+        WeightType total = 0;
+        for (; first != last; ++first)
+        {
+          bucket b = { wac(*first), 0 };
+          total += b.probability;
+          buckets_.push_back(b);
+        }
+        if (buckets_.empty())
+          throw bad_parameter_value(
+            "alias_table: "
+            "empty population.");
+        if (!(total > 0))
+          throw bad_parameter_value(
+            "alias_table: "
+            "population weight must be strictly positive.");
+
+        const size_t n = buckets_.size();
+        const WeightType scale = WeightType(n) / total;
+
+        // Vose's algorithm. Buckets whose scaled weight is below 1
+        // ("small") are topped up with mass taken from buckets whose
+        // scaled weight is above 1 ("large").
+        small_.clear();
+        large_.clear();
+        for (size_t i = 0; i < n; ++i)
+        {
+          buckets_[i].probability *= scale;
+          buckets_[i].alias = i;
+          if (buckets_[i].probability < 1)
+            small_.push_back(i);
+          else
+            large_.push_back(i);
+        }
+        while (!small_.empty() && !large_.empty())
+        {
+          size_t s = small_.back(); small_.pop_back();
+          size_t l = large_.back();
+          buckets_[s].alias = l;
+          buckets_[l].probability =
+            (buckets_[l].probability + buckets_[s].probability) - 1;
+          if (buckets_[l].probability < 1)
+          {
+            large_.pop_back();
+            small_.push_back(l);
+          }
+        }
+        // Leftovers are due to rounding errors, their probability
+        // should be 1.
+        for (size_t i = 0; i < large_.size(); ++i)
+          buckets_[large_[i]].probability = 1;
+        for (size_t i = 0; i < small_.size(); ++i)
+          buckets_[small_[i]].probability = 1;
+      }
+
+    /**
+     * @brief Number of elements in the population.
+     */
+    size_t size() const { return buckets_.size(); }
+
+    /**
+     * @brief Draws an element index, with user-provided random
+     * number.
+     *
+     * @param uniform01 Random number in <tt>[0,1[</tt>. Its integer
+     * part (after scaling by size()) selects a bucket, its
+     * fractional part selects between the bucket and its alias.
+     *
+     * The fractional part keeps the bits of @p uniform01 that the
+     * bucket selection does not use: with a 31-bit random number and
+     * a large table, few of them are left, and the alias decision is
+     * coarse. The functions below draw the bucket and the alias
+     * decision separately.
+     *
+     * @return An index in <tt>[0, size()[</tt>.
+     */
+    size_t draw(WeightType uniform01) const
+      {
+        const WeightType x = uniform01 * WeightType(buckets_.size());
+        size_t i = size_t(x);
+        if (i >= buckets_.size()) i = buckets_.size() - 1;
+        return draw_bucket(i, x - WeightType(i));
+      }
+
+    /**
+     * @brief Draws an element index from bucket @p i, with
+     * user-provided random number.
+     *
+     * @param i Bucket, uniformly drawn in <tt>[0, size()[</tt>.
+     *
+     * @param uniform01 Random number in <tt>[0,1[</tt>, which selects
+     * between the bucket and its alias.
+     *
+     * @return An index in <tt>[0, size()[</tt>.
+     */
+    size_t draw_bucket(size_t i, WeightType uniform01) const
+      {
+        const bucket& b = buckets_[i];
+        return (uniform01 < b.probability) ? i : b.alias;
+      }
+
+    /**
+     * @brief Draws an element index, with system-provided random
+     * numbers.
+     *
+     * The bucket is drawn without bias from the system generator
+     * behind trsl::rand_gen::uniform_int, in as many calls as tables
+     * of more than <tt>2^32</tt> buckets require. The alias decision
+     * is drawn with trsl::rand_gen::uniform_01. See @ref random.
+     */
+    size_t draw() const
+      {
+        const size_t i =
+          size_t(detail::system_uniform_int(boost::uint64_t(buckets_.size())));
+        return draw_bucket(i, rand_gen::uniform_01<WeightType>());
+      }
+
+    /**
+     * @brief Draws @p n element indices and writes them to @p out,
+     * with system-provided random numbers.
+     *
+     * @return The output iterator, past the last written index.
+     */
+    template<class OutputIterator>
+    OutputIterator draw(size_t n, OutputIterator out) const
+      {
+        for (size_t k = 0; k < n; ++k)
+          *out++ = draw();
+        return out;
+      }
+
+    /**
+     * @brief Draws @p n element indices and writes them to @p out,
+     * with user-provided random numbers.
+     *
+     * @param g Either a <em>Uniform Random Number Generator</em> with
+     * an integral <tt>result_type</tt>, e.g. <tt>boost::mt19937</tt>
+     * or trsl::xoshiro256, or a nullary functor that returns random
+     * numbers in <tt>[0,1[</tt>, e.g.
+     * <tt>boost::uniform_01<boost::mt19937></tt>. It is passed by
+     * reference.
+     *
+     * From a generator, the bucket is drawn without bias with
+     * trsl::rand_gen::uniform_int_adaptor, and the alias decision with
+     * trsl::rand_gen::uniform_01. From a functor, each draw makes two
+     * calls: one selects the bucket by scaling a real, the other
+     * decides between the bucket and its alias. The bucket then has
+     * the resolution of the functor: with 32 random bits per real,
+     * buckets are slightly non-uniform, and tables of more than
+     * <tt>2^32</tt> buckets cannot reach every bucket.
+     *
+     * @return The output iterator, past the last written index.
+     */
+    template<class OutputIterator, class UniformGenerator>
+    OutputIterator draw(size_t n, OutputIterator out,
+                        UniformGenerator& g) const
+      {
+        return draw_n(n, out, g,
+                      detail::is_integer_generator<UniformGenerator>());
+      }
+
+  private:
+    template<class OutputIterator, class UniformRandomNumberGenerator>
+    OutputIterator draw_n(size_t n, OutputIterator out,
+                          UniformRandomNumberGenerator& g,
+                          boost::true_type) const
+      {
+        const std::ptrdiff_t size = std::ptrdiff_t(buckets_.size());
+        rand_gen::uniform_int_adaptor<UniformRandomNumberGenerator> index(g);
+        for (size_t k = 0; k < n; ++k)
+        {
+          const size_t i = size_t(index(size));
+          *out++ = draw_bucket(i, rand_gen::uniform_01<WeightType>(g));
+        }
+        return out;
+      }
+
+    template<class OutputIterator, class UniformGenerator>
+    OutputIterator draw_n(size_t n, OutputIterator out,
+                          UniformGenerator& uniform01,
+                          boost::false_type) const
+      {
+        const size_t size = buckets_.size();
+        for (size_t k = 0; k < n; ++k)
+        {
+          size_t i = size_t(double(uniform01()) * double(size));
+          if (i >= size) i = size - 1;
+          *out++ = draw_bucket(i, WeightType(uniform01()));
+        }
+        return out;
+      }
+
+    // Probability and alias are stored together, so that a draw
+    // touches a single cache line.
+    struct bucket
+    {
+      WeightType probability;
+      size_t alias;
+    };
+
+    std::vector<bucket> buckets_;
+    // Work lists for Vose's algorithm, kept to avoid reallocations
+    // in assign().
+    std::vector<size_t> small_;
+    std::vector<size_t> large_;
+  };
+
+}
+
+#endif // include guard
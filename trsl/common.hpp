@@ -9,7 +9,12 @@
 #define TRSL_COMMON_HPP
 
 #include <cstdlib>
+#include <cmath>
 #include <algorithm> //iter_swap
+#include <cstddef>
+#include <limits>
+#include <boost/cstdint.hpp>
+#include <boost/static_assert.hpp>
 
 /**
  * @brief Code version string.
@@ -56,6 +61,305 @@ namespace trsl {
       }
     }
     
+    /**
+     * @brief Scrambles the bits of a seed.
+     *
+     * Seeds that are close to each other (e.g. 1, 2, 3...) lead to
+     * correlated sequences with simple generators such as linear
+     * congruential generators. This function spreads each seed bit
+     * over all bits of the result (finalizer of MurmurHash3).
+     */
+    inline boost::uint32_t mix_seed(boost::uint32_t h)
+    {
+      h ^= h >> 16;
+      h *= 0x85ebca6bU;
+      h ^= h >> 13;
+      h *= 0xc2b2ae35U;
+      h ^= h >> 16;
+      return h;
+    }
+
+    /**
+     * @brief Returns the seed of the @p i-th of a family of random
+     * streams identified by @p seed.
+     *
+     * Used to give each output slot of a multithreaded algorithm its
+     * own generator, so that the result does not depend on how slots
+     * are distributed among threads.
+     */
+    inline boost::uint32_t stream_seed(boost::uint32_t seed, boost::uint32_t i)
+    {
+      return mix_seed(mix_seed(seed) ^ i);
+    }
+
+    /**
+     * @brief Draws a 64-bit integer as four 16-bit integers from @p
+     * rng, which returns a uniform integer of <tt>[0,n[</tt> when
+     * called with @p n.
+     *
+     * The bound of each draw fits in a 32-bit <tt>ptrdiff_t</tt>.
+     */
+    template<class RandomNumberGenerator>
+    boost::uint64_t random_uint64(RandomNumberGenerator& rng)
+    {
+      const std::ptrdiff_t n = std::ptrdiff_t(1) << 16;
+      boost::uint64_t x = 0;
+      for (int i = 0; i < 4; ++i)
+        x = (x << 16) | boost::uint64_t(rng(n));
+      return x;
+    }
+
+    /**
+     * @brief Accumulates @p x into the unevaluated sum @p sum + @p
+     * compensation (Neumaier's variant of Kahan summation).
+     */
+    template<typename WeightType>
+    inline void compensated_add(WeightType& sum,
+                                WeightType& compensation,
+                                WeightType x)
+    {
+      const WeightType t = sum + x;
+      if (std::fabs(sum) >= std::fabs(x))
+        compensation += (sum - t) + x;
+      else
+        compensation += (x - t) + sum;
+      sum = t;
+    }
+
+    /**
+     * @brief Computes the 128-bit product of @p a and @p b.
+     */
+    inline void multiply_64x64(boost::uint64_t a, boost::uint64_t b,
+                               boost::uint64_t& high, boost::uint64_t& low)
+    {
+#ifdef __SIZEOF_INT128__
+      const unsigned __int128 p = (unsigned __int128)a * b;
+      high = boost::uint64_t(p >> 64);
+      low = boost::uint64_t(p);
+#else
+      const boost::uint64_t mask = 0xffffffffULL;
+      const boost::uint64_t a0 = a & mask, a1 = a >> 32;
+      const boost::uint64_t b0 = b & mask, b1 = b >> 32;
+      const boost::uint64_t p00 = a0 * b0, p01 = a0 * b1;
+      const boost::uint64_t p10 = a1 * b0, p11 = a1 * b1;
+      const boost::uint64_t middle = (p00 >> 32) + (p01 & mask) + (p10 & mask);
+      high = p11 + (p01 >> 32) + (p10 >> 32) + (middle >> 32);
+      low = (middle << 32) | (p00 & mask);
+#endif
+    }
+
+    /**
+     * @brief Returns an integer uniformly distributed in
+     * <tt>[0,n[</tt>, with Lemire's multiply-shift method [1].
+     *
+     * @p source is called as <tt>source()</tt>, and returns integers
+     * uniformly distributed in <tt>[0, 2^bits[</tt>, with @p bits in
+     * <tt>[1, 64]</tt>. @p n should be in <tt>]0, 2^bits]</tt>.
+     *
+     * The result is the high part of <tt>x * n</tt>, where @p x is
+     * drawn from @p source. Unlike <tt>x % n</tt>, it is unbiased: the
+     * few values of @p x that would favor some results are rejected.
+     * A division is computed only when the low part of the product is
+     * smaller than @p n, i.e. with probability <tt>n / 2^bits</tt>.
+     *
+     * [1] D. Lemire. Fast random integer generation in an interval.
+     * ACM Transactions on Modeling and Computer Simulation,
+     * 29(1):3:1-3:12, 2019.
+     */
+    template<class BitSource>
+    inline boost::uint64_t bounded_uniform_int(BitSource& source,
+                                               unsigned bits,
+                                               boost::uint64_t n)
+    {
+      // With x in [0, 2^bits[, x * n is split into a result,
+      // x * n / 2^bits, and a remainder, x * n % 2^bits.
+      const boost::uint64_t mask =
+        (bits == 64) ? ~boost::uint64_t(0) : ((boost::uint64_t(1) << bits) - 1);
+      const unsigned shift = bits % 64;
+      boost::uint64_t high, low;
+      multiply_64x64(source(), n, high, low);
+      boost::uint64_t remainder = low & mask;
+      if (remainder < n)
+      {
+        // (2^bits - n) % n
+        const boost::uint64_t threshold = (mask - n + 1) % n;
+        while (remainder < threshold)
+        {
+          multiply_64x64(source(), n, high, low);
+          remainder = low & mask;
+        }
+      }
+      if (shift == 0) return high;
+      return (high << (64 - shift)) | (low >> shift);
+    }
+
+    /**
+     * @brief Returns the number of bits of the integers in
+     * <tt>[0, range]</tt> if <tt>range + 1</tt> is a power of two,
+     * and 0 otherwise. Used internally.
+     */
+    inline unsigned range_bits(boost::uint64_t range)
+    {
+      if (range == ~boost::uint64_t(0)) return 64;
+      if ((range & (range + 1)) != 0) return 0;
+      unsigned bits = 0;
+      for (; range != 0; range >>= 1)
+        bits++;
+      return bits;
+    }
+
+    /**
+     * @brief Converts @p x, an integer in <tt>[0, 2^bits[</tt>, to a
+     * real in <tt>[0,1[</tt>. Used internally.
+     *
+     * The real is built from the high bits of @p x, as many as the
+     * mantissa of @p Real holds, and is thus never rounded up to 1.
+     */
+    template<typename Real>
+    inline Real bits_to_01(boost::uint64_t x, unsigned bits)
+    {
+      const unsigned digits = std::numeric_limits<Real>::digits;
+      if (bits > digits)
+      {
+        x >>= bits - digits;
+        bits = digits;
+      }
+      return Real(x) * std::ldexp(Real(1), -int(bits));
+    }
+
+    /**
+     * @brief Number of bits of the integer @p N. Used internally.
+     */
+    template<unsigned long N>
+    struct bit_count
+    {
+      BOOST_STATIC_CONSTANT(unsigned, value = 1 + bit_count<(N >> 1)>::value);
+    };
+
+    template<>
+    struct bit_count<0>
+    {
+      BOOST_STATIC_CONSTANT(unsigned, value = 0);
+    };
+
+    /**
+     * @brief Returns a random integer in <tt>[0, RAND_MAX]</tt> from
+     * the system generator. Used internally.
+     */
+    inline boost::uint64_t system_random()
+    {
+#ifdef TRSL_USE_BSD_BETTER_RANDOM_GENERATOR
+      return boost::uint64_t(::random());
+#else
+      return boost::uint64_t(std::rand());
+#endif
+    }
+
+    /**
+     * @brief Bit source for bounded_uniform_int: concatenates the bits
+     * of @p calls calls to the system generator. Used internally.
+     */
+    class system_bit_source
+    {
+    public:
+      explicit system_bit_source(unsigned calls) : calls_(calls) {}
+
+      boost::uint64_t operator()()
+        {
+          boost::uint64_t x = 0;
+          for (unsigned i = 0; i < calls_; ++i)
+            x = (x << bit_count<RAND_MAX>::value) | system_random();
+          return x;
+        }
+    private:
+      unsigned calls_;
+    };
+
+    /**
+     * @brief Bit source for bounded_uniform_int: concatenates the bits
+     * of @p calls calls to @p source, which returns integers in
+     * <tt>[0, 2^bits[</tt>. Only the low 64 bits are kept. Used
+     * internally.
+     */
+    template<class BitSource>
+    class concatenated_bit_source
+    {
+    public:
+      concatenated_bit_source(BitSource& source, unsigned bits, unsigned calls) :
+        source_(source), bits_(bits), calls_(calls) {}
+
+      boost::uint64_t operator()()
+        {
+          boost::uint64_t x = source_();
+          for (unsigned i = 1; i < calls_; ++i)
+            x = (x << bits_) | source_();
+          return x;
+        }
+    private:
+      BitSource& source_;
+      unsigned bits_;
+      unsigned calls_;
+    };
+
+    /**
+     * @brief Returns an integer uniformly distributed in
+     * <tt>[0,n[</tt>, drawn from the system generator. Used
+     * internally.
+     *
+     * <tt>RAND_MAX + 1</tt> should be a power of two. When @p n is
+     * larger than <tt>RAND_MAX + 1</tt>, the bits of several calls are
+     * concatenated, as many as fit in 64 bits. Beyond that (above
+     * <tt>2^62</tt> with a 31-bit generator), one more call is
+     * concatenated and the low 64 bits are kept.
+     */
+    inline boost::uint64_t system_uniform_int(boost::uint64_t n)
+    {
+      BOOST_STATIC_ASSERT(((RAND_MAX & (RAND_MAX + 1UL)) == 0));
+      const unsigned bits = bit_count<RAND_MAX>::value;
+      BOOST_STATIC_ASSERT(bits <= 32);
+      if (n <= boost::uint64_t(RAND_MAX) + 1)
+      {
+        // One call; x * n fits in 64 bits.
+        boost::uint64_t product = system_random() * n;
+        boost::uint64_t remainder = product & RAND_MAX;
+        if (remainder < n)
+        {
+          const boost::uint64_t threshold = (RAND_MAX - n + 1) % n;
+          while (remainder < threshold)
+          {
+            product = system_random() * n;
+            remainder = product & RAND_MAX;
+          }
+        }
+        return product >> bits;
+      }
+      unsigned calls = 2;
+      while ((calls + 1) * bits <= 64 &&
+             n > (boost::uint64_t(1) << (calls * bits)))
+        calls++;
+      if (calls * bits < 64 && n > (boost::uint64_t(1) << (calls * bits)))
+      {
+        system_bit_source source(calls + 1);
+        return bounded_uniform_int(source, 64, n);
+      }
+      system_bit_source source(calls);
+      return bounded_uniform_int(source, calls * bits, n);
+    }
+
+    /**
+     * @brief Adapts system_uniform_int to the
+     * <tt>RandomNumberGenerator</tt> argument of
+     * <tt>std::random_shuffle</tt> and partial_random_shuffle. Used
+     * internally.
+     */
+    struct system_uniform_int_generator
+    {
+      std::ptrdiff_t operator()(std::ptrdiff_t n)
+        {
+          return std::ptrdiff_t(system_uniform_int(boost::uint64_t(n)));
+        }
+    };
+
   }
   
   /** @brief Random number wrapper functions. */
@@ -67,11 +371,7 @@ namespace trsl {
      */
     inline unsigned int uniform_int(unsigned int n)
     {
-#ifdef TRSL_USE_BSD_BETTER_RANDOM_GENERATOR
-      return ::random()%n;
-#else
-      return std::rand()%n;
-#endif
+      return (unsigned int)(detail::system_uniform_int(n));
     }
   
     /**
@@ -88,6 +388,96 @@ namespace trsl {
 #endif
     }
     
+    /**
+     * @brief Returns a float in <tt>[0,1[</tt>, drawn from @p g.
+     * Used internally.
+     *
+     * @p g should model <em>Uniform Random Number Generator</em>, as
+     * defined by the <a
+     * href="http://www.boost.org/libs/random/index.html" >Boost
+     * Random Number Library</a>.
+     *
+     * If the range of @p g is a power of two, e.g. trsl::xoshiro256
+     * or <tt>boost::mt19937</tt>, the real is built from the high bits
+     * of one output of @p g, as xoshiro256::to_01() does.
+     */
+    template<typename Real, class UniformRandomNumberGenerator>
+    inline Real uniform_01(UniformRandomNumberGenerator& g)
+    {
+      const boost::uint64_t min = boost::uint64_t((g.min)());
+      const unsigned bits =
+        detail::range_bits(boost::uint64_t((g.max)()) - min);
+      if (bits != 0)
+        return detail::bits_to_01<Real>(boost::uint64_t(g()) - min, bits);
+      const Real r =
+        Real(g() - (g.min)()) / (Real((g.max)() - (g.min)()) + 1);
+      // With generators wider than the mantissa of Real, the division
+      // may round up to 1.
+      return (r < 1) ? r : Real(1) - std::numeric_limits<Real>::epsilon() / 2;
+    }
+
+    /**
+     * @brief Adapts a <em>Uniform Random Number Generator</em> to the
+     * <tt>RandomNumberGenerator</tt> argument of
+     * <tt>std::random_shuffle</tt>. Used internally.
+     *
+     * Integers are drawn with detail::bounded_uniform_int, from the
+     * bits of one or several outputs of the generator: if @p n is
+     * larger than the range of the generator, the bits of several
+     * outputs are concatenated, up to 64 bits. If the range of the
+     * generator is not a power of two, outputs beyond the largest
+     * power of two it contains are rejected.
+     */
+    template<class UniformRandomNumberGenerator>
+    class uniform_int_adaptor
+    {
+    public:
+      explicit uniform_int_adaptor(UniformRandomNumberGenerator& g) :
+        g_(g), bits_(0)
+        {
+          // bits_ is the number of uniform bits of an output of g,
+          // after rejection.
+          const boost::uint64_t range =
+            boost::uint64_t((g_.max)()) - boost::uint64_t((g_.min)());
+          if (range == ~boost::uint64_t(0))
+            bits_ = 64;
+          else
+            for (boost::uint64_t r = range + 1; r > 1; r >>= 1)
+              bits_++;
+        }
+
+      std::ptrdiff_t operator()(std::ptrdiff_t n)
+        {
+          unsigned calls = 1;
+          while (calls * bits_ < 64 &&
+                 boost::uint64_t(n) > (boost::uint64_t(1) << (calls * bits_)))
+            calls++;
+          if (calls == 1)
+            return std::ptrdiff_t(detail::bounded_uniform_int(*this, bits_,
+                                                              boost::uint64_t(n)));
+          detail::concatenated_bit_source<uniform_int_adaptor>
+            source(*this, bits_, calls);
+          return std::ptrdiff_t(detail::bounded_uniform_int(
+            source, std::min(calls * bits_, 64u), boost::uint64_t(n)));
+        }
+
+      /**
+       * @brief Bit source for detail::bounded_uniform_int: returns an
+       * integer in <tt>[0, 2^bits_[</tt>.
+       */
+      boost::uint64_t operator()()
+        {
+          boost::uint64_t x = boost::uint64_t(g_()) - boost::uint64_t((g_.min)());
+          if (bits_ < 64)
+            while ((x >> bits_) != 0)
+              x = boost::uint64_t(g_()) - boost::uint64_t((g_.min)());
+          return x;
+        }
+    private:
+      UniformRandomNumberGenerator& g_;
+      unsigned bits_;
+    };
+    
   }
 }
 
@@ -0,0 +1,241 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+/** @file */
+
+#ifndef TRSL_DOUBLE_BUFFERED_POPULATION_HPP
+#define TRSL_DOUBLE_BUFFERED_POPULATION_HPP
+
+#include <trsl/common.hpp>
+#include <trsl/weight_accessor.hpp>
+#include <trsl/is_picked_systematic.hpp>
+#include <trsl/persistent_filter_iterator.hpp>
+
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+
+namespace trsl {
+
+  /**
+   * @brief Population container with two preallocated buffers, for
+   * resampling loops that do not allocate memory.
+   *
+   * A particle filter typically samples its population into a new
+   * container at every generation, which allocates a buffer of the
+   * size of the sample. double_buffered_population instead owns two
+   * buffers, reserved once at construction: the <em>current</em>
+   * generation, which is read and sampled, and the <em>next</em>
+   * generation, into which the sample is written. swap_generation()
+   * exchanges the buffers in constant time, and empties the new next
+   * buffer without releasing its memory. As long as generations fit
+   * within the capacity given at construction, the steady-state loop
+   *
+   * @code
+   * population.resample(sampleSize);
+   * population.swap_generation();
+   * @endcode
+   *
+   * does not touch the heap.
+   *
+   * The total weight of each generation is kept up to date as
+   * elements are added, with a compensated summation, so that
+   * sampling does not require a pass over the population to compute
+   * it.
+   *
+   * Samples are drawn with is_picked_systematic and a
+   * persistent_filter_iterator. Unlike ppfilter_iterator, which
+   * allocates a random permutation of the population, these do not
+   * allocate memory; the sample is thus not a probability sample
+   * (see @ref products_systematic_sampling).
+   *
+   * @param ElementType Type of the elements.
+   *
+   * @param WeightType Element weight type, should be a floating point type.
+   * Defaults to <tt>double</tt>.
+   *
+   * @param WeightAccessor Type of the accessor that will allow to
+   * extract weights from elements. Defaults to mp_weight_accessor,
+   * see @ref accessor for further details on accessors.
+   */
+  template<
+    class ElementType,
+    typename WeightType = double,
+    class WeightAccessor = mp_weight_accessor<WeightType, ElementType>
+  >
+  class double_buffered_population
+  {
+  public:
+    typedef ElementType element_type;
+    typedef WeightType weight_type;
+    typedef WeightAccessor weight_accessor_type;
+
+    typedef std::vector<ElementType> buffer_type;
+    typedef typename buffer_type::const_iterator const_iterator;
+
+    typedef is_picked_systematic<
+      ElementType, WeightType, WeightAccessor> is_picked;
+    typedef persistent_filter_iterator<
+      is_picked, const_iterator> const_sample_iterator;
+
+    /**
+     * @brief Reserves @p capacity elements in each buffer.
+     */
+    explicit double_buffered_population(size_t capacity,
+                                        WeightAccessor const& wac = WeightAccessor()) :
+      wac_(wac),
+      totalWeight_(0), totalWeightCompensation_(0),
+      nextTotalWeight_(0), nextTotalWeightCompensation_(0)
+      {
+        current_.reserve(capacity);
+        next_.reserve(capacity);
+      }
+
+    /**
+     * @brief Appends @p e to the current generation.
+     */
+    void add(const ElementType& e)
+      {
+        detail::compensated_add(totalWeight_, totalWeightCompensation_,
+                                WeightType(wac_(e)));
+        current_.push_back(e);
+      }
+
+    /**
+     * @brief Replaces the element at @p i of the current generation
+     * with @p e, e.g. to update its weight.
+     */
+    void replace(size_t i, const ElementType& e)
+      {
+        detail::compensated_add(totalWeight_, totalWeightCompensation_,
+                                WeightType(wac_(e)));
+        detail::compensated_add(totalWeight_, totalWeightCompensation_,
+                                WeightType(-wac_(current_[i])));
+        current_[i] = e;
+      }
+
+    /**
+     * @brief Appends @p e to the next generation.
+     */
+    void add_next(const ElementType& e)
+      {
+        detail::compensated_add(nextTotalWeight_, nextTotalWeightCompensation_,
+                                WeightType(wac_(e)));
+        next_.push_back(e);
+      }
+
+    /**
+     * @brief Appends [@p first, @p last) to the next generation,
+     * e.g. a sample of the current generation.
+     */
+    template<class InputIterator>
+    void add_next(InputIterator first, InputIterator last)
+      {
+        for (; first != last; ++first)
+          add_next(*first);
+      }
+
+    /**
+     * @brief Appends a systematic sample of size @p sampleSize of the
+     * current generation to the next generation.
+     *
+     * Equivalent to <tt>add_next(sample_begin(sampleSize),
+     * sample_end())</tt>.
+     */
+    void resample(size_t sampleSize)
+      {
+        add_next(sample_begin(sampleSize), sample_end());
+      }
+
+    /**
+     * @brief Makes the next generation current, and empties the next
+     * generation.
+     *
+     * The buffers are exchanged, not copied. The memory of the former
+     * current generation is kept for the next one.
+     */
+    void swap_generation()
+      {
+        current_.swap(next_);
+        next_.clear();
+        totalWeight_ = nextTotalWeight_;
+        totalWeightCompensation_ = nextTotalWeightCompensation_;
+        nextTotalWeight_ = nextTotalWeightCompensation_ = 0;
+      }
+
+    /**
+     * @brief Empties both generations, without releasing memory.
+     */
+    void clear()
+      {
+        current_.clear();
+        next_.clear();
+        totalWeight_ = totalWeightCompensation_ = 0;
+        nextTotalWeight_ = nextTotalWeightCompensation_ = 0;
+      }
+
+    /** @brief Size of the current generation. */
+    size_t size() const { return current_.size(); }
+
+    /** @brief Size of the next generation. */
+    size_t next_size() const { return next_.size(); }
+
+    /**
+     * @brief Number of elements a generation can hold without
+     * allocating memory.
+     */
+    size_t capacity() const
+      { return std::min(current_.capacity(), next_.capacity()); }
+
+    /** @brief Total weight of the current generation. */
+    WeightType total_weight() const
+      { return totalWeight_ + totalWeightCompensation_; }
+
+    /** @brief Total weight of the next generation. */
+    WeightType next_total_weight() const
+      { return nextTotalWeight_ + nextTotalWeightCompensation_; }
+
+    const ElementType& operator[](size_t i) const { return current_[i]; }
+
+    const_iterator begin() const { return current_.begin(); }
+    const_iterator end() const { return current_.end(); }
+
+    /**
+     * @brief Returns an iterator to the beginning of a systematic
+     * sample of size @p sampleSize of the current generation.
+     */
+    const_sample_iterator sample_begin(size_t sampleSize) const
+      {
+        is_picked predicate(sampleSize, total_weight(), wac_);
+        return const_sample_iterator(predicate, current_.begin(), current_.end());
+      }
+
+    /**
+     * @brief Returns an iterator to the end of a sample of the current
+     * generation.
+     */
+    const_sample_iterator sample_end() const
+      {
+        // For an end of range filter_iterator, the predicate operator()
+        // will never be called. We can put anything for sampleSize and
+        // populationWeight.  A "random" number should be provided, to
+        // avoid a useless call to random().
+        is_picked predicate(1, 1, 0, wac_);
+        return const_sample_iterator(predicate, current_.end(), current_.end());
+      }
+
+  private:
+    WeightAccessor wac_;
+    buffer_type current_;
+    buffer_type next_;
+    WeightType totalWeight_;
+    WeightType totalWeightCompensation_;
+    WeightType nextTotalWeight_;
+    WeightType nextTotalWeightCompensation_;
+  };
+
+}
+
+#endif // include guard
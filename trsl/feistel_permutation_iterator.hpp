@@ -0,0 +1,433 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+/** @file */
+
+#ifndef TRSL_FEISTEL_PERMUTATION_ITERATOR_HPP
+#define TRSL_FEISTEL_PERMUTATION_ITERATOR_HPP
+
+#include <trsl/common.hpp>
+#include <trsl/error_handling.hpp>
+#include <trsl/ppfilter_iterator.hpp>
+
+#include <cstddef>
+#include <iterator>
+#include <algorithm>
+#include <boost/cstdint.hpp>
+#include <boost/utility/enable_if.hpp>
+#include <boost/type_traits/is_arithmetic.hpp>
+#include <boost/detail/iterator.hpp>
+#include <boost/iterator/iterator_facade.hpp>
+#include <boost/iterator/iterator_adaptor.hpp> // enable_if_convertible
+
+namespace trsl
+{
+
+  template<class ElementIterator>
+  class feistel_reorder_iterator;
+
+  namespace detail
+  {
+    /**
+     * @brief Used internally. Keyed bijection of <tt>[0,n[</tt>.
+     *
+     * A Feistel network of FEISTEL_ROUNDS rounds permutes the integers
+     * of <tt>[0, 2^b[</tt>, where <tt>2^b</tt> is the smallest power
+     * of two not smaller than @p n. The network is unbalanced when @p
+     * b is odd: its halves hold <tt>ceil(b/2)</tt> and
+     * <tt>floor(b/2)</tt> bits, and swap sizes at each round. Values
+     * outside <tt>[0,n[</tt> are encrypted again until they fall
+     * within it (cycle walking), which restricts the bijection to
+     * <tt>[0,n[</tt>. Since <tt>2^b < 2n</tt>, an index requires
+     * fewer than two encryptions on average.
+     */
+    class feistel_permutation
+    {
+    public:
+      typedef size_t index_t;
+
+      // Four rounds suffice for large domains [Luby-Rackoff]; small
+      // domains (e.g. n = 10, 2-bit halves) need more to reach
+      // uniform positions.
+      static const int FEISTEL_ROUNDS = 8;
+
+      feistel_permutation() : size_(0), highBits_(1), lowBits_(1)
+        {
+          for (int i = 0; i < FEISTEL_ROUNDS; ++i) keys_[i] = 0;
+        }
+
+      /**
+       * @brief Bijection of <tt>[0, size[</tt>, the round keys of
+       * which are expanded from @p key with SplitMix64.
+       */
+      feistel_permutation(size_t size, boost::uint64_t key) :
+        size_(size)
+        {
+          unsigned bits = 2;
+          while (bits < 64 && (boost::uint64_t(1) << bits) < boost::uint64_t(size))
+            bits++;
+          lowBits_ = bits / 2;
+          highBits_ = bits - lowBits_;
+          for (int i = 0; i < FEISTEL_ROUNDS; ++i)
+          {
+            key += 0x9e3779b97f4a7c15ULL;
+            keys_[i] = mix(key);
+          }
+        }
+
+      size_t size() const { return size_; }
+
+      /**
+       * @brief Returns the image of @p i, which should be in
+       * <tt>[0, size()[</tt>.
+       */
+      index_t operator()(index_t i) const
+        {
+          boost::uint64_t x = i;
+          do
+            x = encrypt(x);
+          while (x >= size_);
+          return index_t(x);
+        }
+
+    private:
+      // SplitMix64 finalizer.
+      static boost::uint64_t mix(boost::uint64_t z)
+        {
+          z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+          z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+          return z ^ (z >> 31);
+        }
+
+      boost::uint64_t encrypt(boost::uint64_t x) const
+        {
+          unsigned high = highBits_, low = lowBits_;
+          for (int i = 0; i < FEISTEL_ROUNDS; ++i)
+          {
+            // (h, l) -> (l, h ^ F(l)): the low half moves up, and the
+            // halves swap sizes.
+            const boost::uint64_t h = x >> low;
+            const boost::uint64_t l = x & ((boost::uint64_t(1) << low) - 1);
+            const boost::uint64_t f =
+              mix(l ^ keys_[i]) & ((boost::uint64_t(1) << high) - 1);
+            x = (l << high) | (h ^ f);
+            std::swap(high, low);
+          }
+          return x;
+        }
+
+      boost::uint64_t size_;
+      unsigned highBits_;
+      unsigned lowBits_;
+      boost::uint64_t keys_[FEISTEL_ROUNDS];
+    };
+
+    /** @brief Used internally. */
+    template<class ElementIterator>
+    struct feistel_reorder_iterator_base
+    {
+      typedef boost::iterator_facade<
+        feistel_reorder_iterator<ElementIterator>,
+        typename boost::detail::iterator_traits<ElementIterator>::value_type,
+        boost::random_access_traversal_tag,
+        typename boost::detail::iterator_traits<ElementIterator>::reference
+      > type;
+    };
+  }
+
+  /**
+   * @brief Provides an iterator over a pseudorandom permutation of a
+   * range, without storing the permutation.
+   *
+   * reorder_iterator stores one <tt>size_t</tt> index per element of
+   * the permutation: 16GB for two billion elements. This iterator
+   * instead computes the index at position @p i as the image of @p i
+   * by a keyed bijection of <tt>[0,n[</tt> (a Feistel network with
+   * cycle walking). Its memory does not depend on @p n, and copies
+   * are independent: two iterators built from the same key go through
+   * the same permutation.
+   *
+   * <b>Statistical quality.</b> The permutation is determined by a
+   * 64-bit key: at most <tt>2^64</tt> of the <tt>n!</tt>
+   * permutations can be reached, whereas random_permutation_iterator
+   * can reach any permutation that its random number generator
+   * allows. The permutations are not exactly uniform; an eight-round
+   * Feistel network with a well-mixing round function is however
+   * close to uniform by simple statistics, e.g. each element appears
+   * at each position with probability close to <tt>1/n</tt>, which
+   * is what probability sampling with ppfilter_iterator relies on.
+   * The deviation is largest on tiny ranges (about 2% for
+   * <tt>n = 10</tt>), where the Feistel halves hold two bits.
+   *
+   * <b>Cost.</b> Construction costs <tt>O(1)</tt>, and reading @p k
+   * elements costs <tt>O(k)</tt>. Each dereference or call to index()
+   * evaluates eight rounds of 64-bit integer mixing, fewer than twice
+   * on average, instead of reading an index array: about 50ns per
+   * index on a current desktop processor. Traversing all the elements
+   * of a large population is thus slower than with
+   * random_permutation_iterator; on 10^8 elements, it takes about 2.4
+   * times as long as shuffling and traversing an index array, which
+   * requires 800MB (see random_permutation_efficiency.cpp).
+   *
+   * Instances are constructed with feistel_permutation_iterator(). A
+   * feistel_reorder_iterator can also be used as the upstream stage of
+   * a ppfilter_iterator, see feistel_ppfilter_iterator.
+   *
+   * @p ElementIterator should model <em>Random Access Iterator</em>.
+   */
+  template<class ElementIterator>
+  class feistel_reorder_iterator
+    : public detail::feistel_reorder_iterator_base<ElementIterator>::type
+  {
+    typedef typename detail::feistel_reorder_iterator_base<
+      ElementIterator>::type super_t;
+
+    friend class boost::iterator_core_access;
+
+  public:
+    typedef ElementIterator element_iterator;
+    typedef detail::feistel_permutation permutation_type;
+    typedef permutation_type::index_t index_t;
+
+    feistel_reorder_iterator() :
+      m_elt_iter(), m_size(0), m_position(0)
+      {}
+
+    /**
+     * @brief Constructs an iterator that will walk through the first
+     * @p permutationSize images of @p permutation, in the range that
+     * begins at @p first.
+     */
+    feistel_reorder_iterator(ElementIterator first,
+                             const permutation_type& permutation,
+                             size_t permutationSize) :
+      m_elt_iter(first), m_permutation(permutation),
+      m_size(permutationSize), m_position(0)
+      {}
+
+    /**
+     * @brief Allows conversion from a feistel_reorder_iterator to a
+     * const feistel_reorder_iterator, see reorder_iterator.
+     */
+    template<class OtherElementIterator>
+    feistel_reorder_iterator
+    (feistel_reorder_iterator<OtherElementIterator> const& r,
+     typename boost::enable_if_convertible<OtherElementIterator, ElementIterator>::type* = 0) :
+      m_elt_iter(r.m_elt_iter), m_permutation(r.m_permutation),
+      m_size(r.m_size), m_position(r.m_position)
+      {}
+
+    /**
+     * @brief Returns an iterator pointing to the beginning of the
+     * permutation.
+     */
+    feistel_reorder_iterator begin() const
+      {
+        feistel_reorder_iterator i(*this);
+        i.m_position = 0;
+        return i;
+      }
+
+    /**
+     * @brief Returns an iterator pointing to the end of the
+     * permutation.
+     */
+    feistel_reorder_iterator end() const
+      {
+        feistel_reorder_iterator i(*this);
+        i.m_position = m_size;
+        return i;
+      }
+
+    /**
+     * @brief Returns the index of the element that the iterator is
+     * currently pointing to.
+     */
+    index_t index() const
+      {
+        return m_permutation(m_position);
+      }
+
+  private:
+    typename super_t::reference dereference() const
+      { return *(m_elt_iter + index()); }
+
+    bool equal(feistel_reorder_iterator const& i) const
+      { return m_position == i.m_position; }
+
+    void increment() { ++m_position; }
+
+    void decrement() { --m_position; }
+
+    void advance(typename super_t::difference_type n)
+      { m_position += n; }
+
+    typename super_t::difference_type
+    distance_to(feistel_reorder_iterator const& i) const
+      {
+        return typename super_t::difference_type(i.m_position) -
+          typename super_t::difference_type(m_position);
+      }
+
+#ifndef BOOST_NO_MEMBER_TEMPLATE_FRIENDS
+    template <class> friend class feistel_reorder_iterator;
+#else
+  public:
+#endif
+    ElementIterator m_elt_iter;
+    permutation_type m_permutation;
+    size_t m_size;
+    size_t m_position;
+  };
+
+  namespace detail
+  {
+    /** @brief Used internally. */
+    template<class ElementIterator>
+    feistel_reorder_iterator<ElementIterator>
+    feistel_permutation_iterator(ElementIterator first,
+                                 ElementIterator last,
+                                 size_t permutationSize,
+                                 boost::uint64_t key)
+    {
+      std::ptrdiff_t size = std::distance(first, last);
+      if (size < 0)
+        throw bad_parameter_value(
+          "feistel_permutation_iterator: "
+          "bad input range.");
+      if (permutationSize > size_t(size))
+        throw bad_parameter_value(
+          "feistel_permutation_iterator: "
+          "parameter permutationSize out of range.");
+      return feistel_reorder_iterator<ElementIterator>(
+        first, feistel_permutation(size_t(size), key), permutationSize);
+    }
+  }
+
+  /**
+   * @brief Constructs a feistel_reorder_iterator that will iterate
+   * through a subset of size @p permutationSize of a pseudorandom
+   * permutation of the population referenced by @p first and @p
+   * last.
+   *
+   * The @p permutationSize should be smaller or equal to the
+   * size of the population. If it is not the case, a bad_parameter_value
+   * is thrown.
+   *
+   * The key of the permutation is drawn as four 16-bit integers from
+   * the system generator behind rand_gen::uniform_int; see @ref
+   * random for further details.
+   */
+  template<class ElementIterator>
+  feistel_reorder_iterator<ElementIterator>
+  feistel_permutation_iterator(ElementIterator first,
+                               ElementIterator last,
+                               size_t permutationSize)
+  {
+    detail::system_uniform_int_generator rng;
+    return detail::feistel_permutation_iterator(
+      first, last, permutationSize, detail::random_uint64(rng));
+  }
+
+  /**
+   * @brief Constructs a feistel_reorder_iterator that will iterate
+   * through a subset of size @p permutationSize of a pseudorandom
+   * permutation of the population referenced by @p first and @p last,
+   * the key of which is drawn from @p g.
+   *
+   * @p g should model <em>Uniform Random Number Generator</em>, see
+   * @ref random.
+   */
+  template<class ElementIterator, class UniformRandomNumberGenerator>
+  feistel_reorder_iterator<ElementIterator>
+  feistel_permutation_iterator(ElementIterator first,
+                               ElementIterator last,
+                               size_t permutationSize,
+                               UniformRandomNumberGenerator& g)
+  {
+    rand_gen::uniform_int_adaptor<UniformRandomNumberGenerator> rng(g);
+    return detail::feistel_permutation_iterator(
+      first, last, permutationSize, detail::random_uint64(rng));
+  }
+
+  /**
+   * @brief Constructs a feistel_reorder_iterator that will iterate
+   * through a pseudorandom permutation of the population referenced
+   * by @p first and @p last.
+   *
+   * See above.
+   */
+  template<class ElementIterator>
+  feistel_reorder_iterator<ElementIterator>
+  feistel_permutation_iterator(ElementIterator first,
+                               ElementIterator last)
+  {
+    return feistel_permutation_iterator(first, last,
+                                        std::distance(first, last));
+  }
+
+  /**
+   * @brief Constructs a feistel_reorder_iterator that will iterate
+   * through a pseudorandom permutation of the population referenced
+   * by @p first and @p last, the key of which is drawn from @p g.
+   *
+   * See above.
+   */
+  template<class ElementIterator, class UniformRandomNumberGenerator>
+  typename boost::disable_if<
+    boost::is_arithmetic<UniformRandomNumberGenerator>,
+    feistel_reorder_iterator<ElementIterator>
+  >::type
+  feistel_permutation_iterator(ElementIterator first,
+                               ElementIterator last,
+                               UniformRandomNumberGenerator& g)
+  {
+    return feistel_permutation_iterator(first, last,
+                                        std::distance(first, last), g);
+  }
+
+  namespace detail
+  {
+    /** @brief Used internally. */
+    template<class ElementIterator>
+    struct ppfilter_upstream< feistel_reorder_iterator<ElementIterator> >
+    {
+      typedef feistel_reorder_iterator<ElementIterator> type;
+
+      static type make(ElementIterator first, ElementIterator last)
+        {
+          return trsl::feistel_permutation_iterator(first, last);
+        }
+
+      template<class UniformRandomNumberGenerator>
+      static type make(ElementIterator first, ElementIterator last,
+                       UniformRandomNumberGenerator& g)
+        {
+          return trsl::feistel_permutation_iterator(first, last, g);
+        }
+    };
+  }
+
+  /**
+   * @brief Type generator for a ppfilter_iterator that uses a
+   * feistel_reorder_iterator upstream.
+   *
+   * <tt>feistel_ppfilter_iterator<Predicate, ElementIterator>::type</tt>
+   * is used as a ppfilter_iterator, but does not allocate an index
+   * array.
+   */
+  template<class Predicate, class ElementIterator>
+  struct feistel_ppfilter_iterator
+  {
+    typedef ppfilter_iterator<
+      Predicate,
+      ElementIterator,
+      feistel_reorder_iterator<ElementIterator>
+    > type;
+  };
+
+} // namespace trsl
+
+#endif // include guard
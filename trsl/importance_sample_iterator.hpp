@@ -0,0 +1,296 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+/** @file */
+
+#ifndef TRSL_IMPORTANCE_SAMPLE_ITERATOR_HPP
+#define TRSL_IMPORTANCE_SAMPLE_ITERATOR_HPP
+
+#include <trsl/error_handling.hpp>
+#include <trsl/common.hpp>
+
+#include <trsl/is_picked_systematic.hpp>
+#include <trsl/persistent_filter_iterator.hpp>
+
+#include <boost/detail/iterator.hpp>
+
+namespace trsl
+{
+
+  /**
+   * @brief Weight accessor that returns the importance weight of an
+   * element, i.e. the ratio of its target density to its proposal
+   * density.
+   *
+   * Elements whose proposal density is not positive have a null
+   * importance weight: they could not have been drawn from the
+   * proposal.
+   *
+   * @param TargetAccessor, ProposalAccessor Accessors to the target
+   * and proposal densities of an element, see @ref accessor.
+   */
+  template<
+    typename WeightType,
+    typename ElementType,
+    class TargetAccessor,
+    class ProposalAccessor
+  >
+  class importance_weight_accessor
+  {
+  public:
+    importance_weight_accessor() {}
+
+    importance_weight_accessor(TargetAccessor const& target,
+                               ProposalAccessor const& proposal) :
+      target_(target), proposal_(proposal) {}
+
+    /**
+     * @brief Functor implementation.
+     *
+     * @return <tt>target(e) / proposal(e)</tt>, or 0 if
+     * <tt>proposal(e)</tt> is not positive.
+     */
+    WeightType operator()(ElementType const& e) const
+      {
+        const WeightType q = proposal_(e);
+        if (!(q > 0))
+          return 0;
+        return target_(e) / q;
+      }
+
+  private:
+    TargetAccessor target_;
+    ProposalAccessor proposal_;
+  };
+
+  template<class ElementIterator, class TargetAccessor,
+           class ProposalAccessor, typename WeightType>
+  class importance_sample_iterator;
+
+  namespace detail
+  {
+    /** @brief Used internally. */
+    template<class ElementIterator, class TargetAccessor,
+             class ProposalAccessor, typename WeightType>
+    struct importance_sample_iterator_base
+    {
+      typedef typename
+      boost::detail::iterator_traits<ElementIterator>::value_type
+      element_type;
+
+      typedef importance_weight_accessor<
+        WeightType, element_type,
+        TargetAccessor, ProposalAccessor> weight_accessor_t;
+      typedef is_picked_systematic<
+        element_type, WeightType, weight_accessor_t> predicate_t;
+      typedef persistent_filter_iterator<
+        predicate_t, ElementIterator> downstream_iterator;
+
+      typedef boost::iterator_adaptor<
+        importance_sample_iterator<ElementIterator, TargetAccessor,
+                                   ProposalAccessor, WeightType>,
+        downstream_iterator,
+        element_type,
+        boost::forward_traversal_tag,
+        typename boost::detail::iterator_traits<ElementIterator>::reference
+      > type;
+    };
+  }
+
+  /**
+   * @brief Sample iterator for importance resampling.
+   *
+   * Importance resampling draws a sample from a population that was
+   * drawn from a <em>proposal</em> density, so that the sample
+   * follows a <em>target</em> density. Each element is picked with a
+   * probability proportional to its importance weight, i.e. the ratio
+   * of its target density to its proposal density.
+   *
+   * This iterator systematically samples (see is_picked_systematic)
+   * the population [@p first, @p last), with importance weights
+   * computed on the fly from the target and proposal accessors by an
+   * importance_weight_accessor. Importance weights are thus never
+   * stored. When their total is not known in advance, it is computed
+   * by the constructor, in an extra pass that only reads the
+   * population.
+   *
+   * @p ElementIterator should model <em>Forward Iterator</em>.
+   *
+   * @param TargetAccessor, ProposalAccessor Accessors to the target
+   * and proposal densities of an element, see @ref accessor. The
+   * densities need not be normalized.
+   *
+   * @param WeightType Density type, should be a floating point type.
+   * Defaults to <tt>double</tt>.
+   */
+  template<
+    class ElementIterator,
+    class TargetAccessor,
+    class ProposalAccessor,
+    typename WeightType = double
+  >
+  class importance_sample_iterator
+    : public detail::importance_sample_iterator_base<
+        ElementIterator, TargetAccessor, ProposalAccessor, WeightType
+      >::type
+  {
+    typedef detail::importance_sample_iterator_base<
+      ElementIterator, TargetAccessor, ProposalAccessor, WeightType
+    > base_t;
+    typedef typename base_t::type super_t;
+
+    friend class boost::iterator_core_access;
+
+    typedef typename base_t::downstream_iterator downstream_iterator;
+
+  public:
+
+    typedef ElementIterator element_iterator;
+    /** @brief Type of the underlying is_picked_systematic predicate. */
+    typedef typename base_t::predicate_t predicate_type;
+    /** @brief Type of the importance weight accessor. */
+    typedef typename base_t::weight_accessor_t weight_accessor_type;
+
+    importance_sample_iterator() :
+      super_t()
+      {}
+
+    /**
+     * @brief Constructor, with known population weight.
+     *
+     * @param first, last Population range.
+     *
+     * @param sampleSize Number of elements in the sample, within
+     * <tt>[0, infinity[</tt>.
+     *
+     * @param populationWeight Sum of the importance weights of the
+     * population, within <tt>]0, infinity[</tt>.
+     *
+     * @param target, proposal Target and proposal density accessors.
+     */
+    importance_sample_iterator(ElementIterator first,
+                               ElementIterator last,
+                               size_t sampleSize,
+                               WeightType populationWeight,
+                               TargetAccessor const& target,
+                               ProposalAccessor const& proposal)
+      : super_t()
+      {
+        initialize(first, last, sampleSize, populationWeight,
+                   weight_accessor_type(target, proposal));
+      }
+
+    /**
+     * @brief Constructor, computes the population weight.
+     *
+     * Reads the population once to sum the importance weights, then
+     * behaves as the constructor above.
+     *
+     * Throws a bad_parameter_value if the sum of the importance
+     * weights is not strictly positive.
+     *
+     * @param first, last Population range.
+     *
+     * @param sampleSize Number of elements in the sample, within
+     * <tt>[0, infinity[</tt>.
+     *
+     * @param target, proposal Target and proposal density accessors.
+     */
+    importance_sample_iterator(ElementIterator first,
+                               ElementIterator last,
+                               size_t sampleSize,
+                               TargetAccessor const& target,
+                               ProposalAccessor const& proposal)
+      : super_t()
+      {
+        weight_accessor_type wac(target, proposal);
+        WeightType populationWeight = 0;
+        for (ElementIterator i = first; i != last; ++i)
+          populationWeight += wac(*i);
+        if (!(populationWeight > 0))
+          throw bad_parameter_value(
+            "importance_sample_iterator: "
+            "population weight must be strictly positive.");
+        initialize(first, last, sampleSize, populationWeight, wac);
+      }
+
+    /**
+     * @brief Allows conversion from an importance_sample_iterator to
+     * a const importance_sample_iterator, won't allow conversion from
+     * a const importance_sample_iterator to an
+     * importance_sample_iterator.
+     *
+     * See ppfilter_iterator.
+     */
+    template<class OtherElementIterator>
+    importance_sample_iterator
+    (importance_sample_iterator<OtherElementIterator, TargetAccessor,
+                                ProposalAccessor, WeightType> const& r,
+     typename boost::enable_if_convertible<OtherElementIterator, ElementIterator>::type* = 0) :
+      super_t(r.base()), predicate_(r.predicate_), first_(r.first_)
+      {}
+
+    /**
+     * @brief Returns an importance_sample_iterator pointing to the
+     * begining of the sample.
+     *
+     * The sample is the same as the one iterated from the
+     * constructed iterator.
+     */
+    importance_sample_iterator begin() const
+      {
+        importance_sample_iterator i(*this);
+        i.base_reference() =
+          downstream_iterator(predicate_, first_,
+                              this->base_reference().end());
+        return i;
+      }
+
+    /**
+     * @brief Returns an importance_sample_iterator pointing to the
+     * end of the sample.
+     */
+    importance_sample_iterator end() const
+      {
+        importance_sample_iterator i(*this);
+        i.base_reference() =
+          downstream_iterator(predicate_,
+                              this->base_reference().end(),
+                              this->base_reference().end());
+        return i;
+      }
+
+    /**
+     * @brief Returns the persistent_filter_iterator predicate.
+     */
+    predicate_type predicate() const { return this->base_reference().predicate(); }
+
+  private:
+    void initialize(ElementIterator first,
+                    ElementIterator last,
+                    size_t sampleSize,
+                    WeightType populationWeight,
+                    weight_accessor_type const& wac)
+      {
+        predicate_ = predicate_type(sampleSize, populationWeight, wac);
+        first_ = first;
+        this->base_reference() = downstream_iterator(predicate_, first, last);
+      }
+
+#ifndef BOOST_NO_MEMBER_TEMPLATE_FRIENDS
+    template <class, class, class, typename>
+    friend class importance_sample_iterator;
+#else
+  public:
+#endif
+    // Need to store the initial predicate and position to implement
+    // begin().
+    predicate_type predicate_;
+    ElementIterator first_;
+  };
+
+} // namespace trsl
+
+#endif // include guard
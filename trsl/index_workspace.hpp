@@ -0,0 +1,104 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+/** @file */
+
+#ifndef TRSL_INDEX_WORKSPACE_HPP
+#define TRSL_INDEX_WORKSPACE_HPP
+
+#include <trsl/common.hpp>
+
+#include <cstddef>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+namespace trsl {
+
+  /**
+   * @brief Pool of index arrays, for loops that create reorder
+   * iterators without allocating memory.
+   *
+   * random_permutation_iterator() and sort_iterator() store the
+   * permutation they compute in a new index array, shared by all
+   * copies of the returned reorder_iterator. In a loop that creates a
+   * permutation at every round, this allocates an array of the size
+   * of the population each time. The overloads of these functions
+   * that take an index_workspace instead reuse an array of the pool
+   * that no reorder_iterator refers to anymore, i.e. an array whose
+   * last reorder_iterator copy has been destroyed. A new array is
+   * added to the pool only if all arrays are in use. Once the pool
+   * holds as many arrays as there are permutations alive at a time,
+   * and these arrays have grown to the size of the population, the
+   * steady-state loop
+   *
+   * @code
+   * trsl::index_workspace<> workspace;
+   * for (;;)
+   * {
+   *   permutation_iterator sb =
+   *     trsl::random_permutation_iterator(first, last, workspace);
+   *   // ...
+   * }
+   * @endcode
+   *
+   * does not allocate memory.
+   *
+   * Arrays are shared through <a
+   * href="http://www.boost.org/libs/smart_ptr/shared_ptr.htm"
+   * >boost::shared_ptr</a>, as in reorder_iterator: an array remains
+   * valid as long as a reorder_iterator refers to it, even if the
+   * workspace is destroyed. An index_workspace should not be used from
+   * several threads at once, nor while reorder_iterator copies that
+   * refer to its arrays are created or destroyed in another thread.
+   *
+   * @param IndexType Type of the stored indices, see reorder_iterator.
+   */
+  template<class IndexType = size_t>
+  class index_workspace
+  {
+  public:
+    typedef IndexType index_t;
+    typedef std::vector<index_t> index_container;
+    typedef boost::shared_ptr<index_container> index_container_ptr;
+
+    index_workspace() {}
+
+    /**
+     * @brief Returns an index array that no reorder_iterator refers
+     * to.
+     *
+     * The content of the array is unspecified. The array is added to
+     * the pool if it is new.
+     */
+    index_container_ptr acquire()
+      {
+        for (typename pool_type::iterator i = pool_.begin();
+             i != pool_.end(); ++i)
+          if (i->unique())
+            return *i;
+        pool_.push_back(index_container_ptr(new index_container));
+        return pool_.back();
+      }
+
+    /**
+     * @brief Returns the number of arrays in the pool.
+     */
+    size_t size() const { return pool_.size(); }
+
+    /**
+     * @brief Releases the arrays of the pool. Arrays that are still
+     * referred to by reorder iterators are freed with their last
+     * iterator.
+     */
+    void clear() { pool_.clear(); }
+
+  private:
+    typedef std::vector<index_container_ptr> pool_type;
+    pool_type pool_;
+  };
+
+} // namespace trsl
+
+#endif // include guard
@@ -0,0 +1,246 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+/** @file */
+
+#ifndef TRSL_IS_PICKED_MULTINOMIAL_HPP
+#define TRSL_IS_PICKED_MULTINOMIAL_HPP
+
+#include <trsl/common.hpp>
+#include <trsl/weight_accessor.hpp>
+
+#include <cmath>
+#include <limits>
+#include <cassert>
+#include <boost/static_assert.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/random/linear_congruential.hpp>
+
+namespace trsl {
+
+  /**
+   * @brief Functor to use with persistent_filter_iterator for
+   * multinomial sampling of a range.
+   *
+   * Multinomial sampling draws @p sampleSize elements independently,
+   * each one with a probability proportional to its weight
+   * [1]. The naive implementation draws @p sampleSize uniform
+   * numbers and locates each of them in the cumulative weights with
+   * a binary search, which costs <em>O(M log n)</em> and requires
+   * random access to the population.
+   *
+   * This predicate instead generates the @p sampleSize uniform
+   * numbers directly in ascending order, one at a time, and merges
+   * them with the cumulative weight of the population while the
+   * persistent_filter_iterator walks through it. A sample of @p M
+   * elements from a population of @p n elements thus costs
+   * <em>O(n+M)</em>, requires no extra storage, and works with
+   * Forward Iterators. Ascending uniforms are obtained from the
+   * distribution of the smallest of @p r uniform numbers, which is
+   * that of <tt>1 - V^(1/r)</tt> with @p V uniform in
+   * <tt>]0,1]</tt>.
+   *
+   * The sorted uniforms are generated on the fly by a small
+   * pseudo-random generator (<a
+   * href="http://www.boost.org/libs/random/index.html"
+   * >boost::rand48</a>) stored in the predicate. The generator is
+   * copied along with the predicate, so that all copies of a
+   * sample iterator, and all iterators returned by
+   * ppfilter_iterator::begin(), go through the same sample.
+   *
+   * is_picked_multinomial satisfies the same requirements as
+   * trsl::is_picked_systematic, and can be used with
+   * trsl::persistent_filter_iterator, trsl::ppfilter_iterator and
+   * trsl::is_first_pick in the same way.
+   *
+   * @param ElementType Type of the elements in the population, see
+   * trsl::is_picked_systematic.
+   *
+   * @param WeightType Element weight type, should be a floating point type.
+   * Defaults to <tt>double</tt>.
+   *
+   * @param WeightAccessor Type of the accessor that will allow to
+   * extract weights from elements. Defaults to mp_weight_accessor,
+   * see @ref accessor for further details on accessors.
+   *
+   * <b>References:</b>
+   *
+   * - [1] R. Douc, O. Cappe, and E. Moulines. Comparison of
+   * resampling schemes for particle filtering. International
+   * Symposium on Parallel and Distributed Processing and
+   * Applications, 2005:64, 2005.
+   */
+  template<
+    typename ElementType,
+    typename WeightType = double,
+    typename WeightAccessor = mp_weight_accessor<WeightType, ElementType>
+  > class is_picked_multinomial
+  {
+  private:
+    BOOST_STATIC_ASSERT((std::numeric_limits<WeightType>::is_integer == false));
+  public:
+    typedef ElementType element_type;
+    typedef WeightType weight_type;
+    typedef WeightAccessor weight_accessor_type;
+    /** @brief Type of the seed of the internal random generator. */
+    typedef boost::uint32_t seed_type;
+
+    /**
+     * @brief Default constructor, shoud not be used explicitely.
+     *
+     * This constructor makes an invalid predicate. It should only be used in
+     * cases where the predicate is never used.
+     */
+    is_picked_multinomial() :
+      sampleSize_(0),
+      populationWeight_(0)
+      {
+        initialize( 0 );
+      }
+
+    /**
+     * @brief Construction with system-provided seed.
+     *
+     * The internal generator is seeded with
+     * trsl::rand_gen::uniform_int.  See @ref random for more details.
+     *
+     * @param sampleSize Number of elements in the sample, within
+     * <tt>[0, infinity[</tt>.
+     *
+     * @param populationWeight Total weight of the
+     * population, within <tt>]0, infinity[</tt>. Generally equal to 1.
+     *
+     * @param wac Weight accessor, see trsl::is_picked_systematic.
+     */
+    is_picked_multinomial(size_t sampleSize,
+                          WeightType populationWeight,
+                          WeightAccessor const& wac = WeightAccessor()) :
+      wac_(wac), sampleSize_(sampleSize),
+      populationWeight_(populationWeight)
+      {
+        initialize( rand_gen::uniform_int(RAND_MAX) );
+      }
+
+    /**
+     * @brief Construction with user-provided seed.
+     *
+     * Two predicates constructed with the same parameters and the
+     * same @p seed pick the same elements.
+     *
+     * @param sampleSize Number of elements in the sample, within
+     * <tt>[0, infinity[</tt>.
+     *
+     * @param populationWeight Total weight of the
+     * population, within <tt>]0, infinity[</tt>. Generally equal to 1.
+     *
+     * @param seed Seed for the internal random generator.
+     *
+     * @param wac Weight accessor, see trsl::is_picked_systematic.
+     */
+    is_picked_multinomial(size_t sampleSize,
+                          WeightType populationWeight,
+                          seed_type seed,
+                          WeightAccessor const& wac = WeightAccessor()) :
+      wac_(wac), sampleSize_(sampleSize),
+      populationWeight_(populationWeight)
+      {
+        initialize(seed);
+      }
+
+    /**
+     * @brief Decides whether <tt>e</tt> should be picked or not (used
+     * by persistent_filter_iterator).
+     *
+     * Part of the requirements for persistent_filter_iterator
+     * predicates.
+     */
+    bool operator()(const ElementType & e)
+      {
+        if (k_ == sampleSize_) return false;
+
+        const WeightType w = wac_(e);
+        assert(cumulative_ <= arrow_);
+        if (arrow_ < cumulative_ + w)
+        {
+          k_++;
+          picksOfCurrent_++;
+          next_arrow();
+          return true;
+        }
+        cumulative_ += w;
+        picksOfCurrent_ = 0;
+        return false;
+      }
+
+    /**
+     * @brief Return whether @p e has been picked already.
+     *
+     * Same semantics as is_picked_systematic::is_first_pick. This
+     * method is meant to be called by trsl::is_first_pick.
+     */
+    bool is_first_pick(const ElementType &) const
+    {
+      return picksOfCurrent_ <= 1;
+    }
+
+    /**
+     * @brief Returns whether two predicates are at the same sampling
+     * advancement.
+     *
+     * Part of the requirements for persistent_filter_iterator
+     * predicates.
+     */
+    bool operator== (const is_picked_multinomial<ElementType, WeightType, WeightAccessor> &p) const
+      {
+        return
+          sampleSize_ == p.sampleSize_ &&
+          populationWeight_ == p.populationWeight_ &&
+          k_ == p.k_ &&
+          cumulative_ == p.cumulative_ &&
+          uniform_ == p.uniform_;
+      }
+
+  private:
+    void initialize(seed_type seed)
+      {
+        rng_.seed(detail::mix_seed(seed));
+        k_ = 0;
+        picksOfCurrent_ = 0;
+        cumulative_ = 0;
+        uniform_ = 0;
+        arrow_ = 0;
+        next_arrow();
+      }
+
+    /**
+     * Sets uniform_ to the (k_+1)-th smallest of sampleSize_
+     * uniform numbers, given that uniform_ is the k_-th smallest.
+     */
+    void next_arrow()
+      {
+        if (k_ == sampleSize_) return;
+        // v in ]0,1], so that log(v) is finite.
+        WeightType v = 1 - rand_gen::uniform_01<WeightType>(rng_);
+        WeightType r = WeightType(sampleSize_ - k_);
+        uniform_ = 1 - (1 - uniform_) * std::exp(std::log(v) / r);
+        arrow_ = uniform_ * populationWeight_;
+      }
+
+  private:
+    WeightAccessor wac_;
+    size_t sampleSize_;
+    WeightType populationWeight_;
+
+    boost::rand48 rng_;
+    size_t k_;
+    size_t picksOfCurrent_;
+    WeightType cumulative_;
+    WeightType uniform_;
+    WeightType arrow_;
+  };
+
+}
+
+#endif // include guard
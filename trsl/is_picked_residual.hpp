@@ -0,0 +1,243 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+/** @file */
+
+#ifndef TRSL_IS_PICKED_RESIDUAL_HPP
+#define TRSL_IS_PICKED_RESIDUAL_HPP
+
+#include <trsl/common.hpp>
+#include <trsl/weight_accessor.hpp>
+
+#include <limits>
+#include <cassert>
+#include <boost/static_assert.hpp>
+
+namespace trsl {
+
+  /**
+   * @brief Functor to use with persistent_filter_iterator for
+   * residual sampling of a range.
+   *
+   * Residual sampling [1, 2] first picks each element
+   * <tt>floor(sampleSize * w / populationWeight)</tt> times, without
+   * any random draw. The remaining picks are drawn from the
+   * <em>residual</em> weights, i.e. the fractional parts of
+   * <tt>sampleSize * w / populationWeight</tt>.
+   *
+   * In this implementation, the residual picks are drawn by
+   * systematic sampling of the residual weights, with one pick per
+   * unit of residual weight. Since the residual weights sum to an
+   * integer, the number of residual picks follows without having to
+   * compute it beforehand, and the whole sample is produced in a
+   * single pass, from a single random number. The deterministic picks
+   * make residual sampling less variable than multinomial sampling.
+   *
+   * is_picked_residual satisfies the same requirements as
+   * trsl::is_picked_systematic, and can be used with
+   * trsl::persistent_filter_iterator, trsl::ppfilter_iterator and
+   * trsl::is_first_pick in the same way.
+   *
+   * @param ElementType Type of the elements in the population, see
+   * trsl::is_picked_systematic.
+   *
+   * @param WeightType Element weight type, should be a floating point type.
+   * Defaults to <tt>double</tt>.
+   *
+   * @param WeightAccessor Type of the accessor that will allow to
+   * extract weights from elements. Defaults to mp_weight_accessor,
+   * see @ref accessor for further details on accessors.
+   *
+   * <b>References:</b>
+   *
+   * - [1] R. Douc, O. Cappe, and E. Moulines. Comparison of
+   * resampling schemes for particle filtering. International
+   * Symposium on Parallel and Distributed Processing and
+   * Applications, 2005:64, 2005.
+   *
+   * - [2] J. Hol, T. Sch&ouml;n, and F. Gustafsson. On resampling
+   * algorithms for particle filters. In Nonlinear Statistical Signal
+   * Processing Workshop, 2006.
+   */
+  template<
+    typename ElementType,
+    typename WeightType = double,
+    typename WeightAccessor = mp_weight_accessor<WeightType, ElementType>
+  > class is_picked_residual
+  {
+  private:
+    BOOST_STATIC_ASSERT((std::numeric_limits<WeightType>::is_integer == false));
+  public:
+    typedef ElementType element_type;
+    typedef WeightType weight_type;
+    typedef WeightAccessor weight_accessor_type;
+
+    /**
+     * @brief Default constructor, shoud not be used explicitely.
+     *
+     * This constructor makes an invalid predicate. It should only be used in
+     * cases where the predicate is never used.
+     */
+    is_picked_residual() :
+      sampleSize_(0),
+      populationWeight_(0)
+      {
+        initialize( 0 );
+      }
+
+    /**
+     * @brief Construction with system-provided random number.
+     *
+     * The residual sampling predicate initialization needs a random
+     * number in <tt>[0,1[</tt>.  This constructor uses
+     * trsl::rand_gen::uniform_01 to generate that number.  See @ref
+     * random for more details.
+     *
+     * @param sampleSize Number of elements in the sample, within
+     * <tt>[0, infinity[</tt>.
+     *
+     * @param populationWeight Total weight of the
+     * population, within <tt>]0, infinity[</tt>. Generally equal to 1.
+     *
+     * @param wac Weight accessor, see trsl::is_picked_systematic.
+     */
+    is_picked_residual(size_t sampleSize,
+                       WeightType populationWeight,
+                       WeightAccessor const& wac = WeightAccessor()) :
+      wac_(wac), sampleSize_(sampleSize),
+      populationWeight_(populationWeight)
+      {
+        initialize( rand_gen::uniform_01<WeightType>() );
+      }
+
+    /**
+     * @brief Construction with user-provided random number.
+     *
+     * @param sampleSize Number of elements in the sample, within
+     * <tt>[0, infinity[</tt>.
+     *
+     * @param populationWeight Total weight of the
+     * population, within <tt>]0, infinity[</tt>. Generally equal to 1.
+     *
+     * @param uniform01 Random number in <tt>[0,1[</tt>.
+     *
+     * @param wac Weight accessor, see trsl::is_picked_systematic.
+     */
+    is_picked_residual(size_t sampleSize,
+                       WeightType populationWeight,
+                       WeightType uniform01,
+                       WeightAccessor const& wac = WeightAccessor()) :
+      wac_(wac), sampleSize_(sampleSize),
+      populationWeight_(populationWeight)
+      {
+        initialize(uniform01);
+      }
+
+    /**
+     * @brief Decides whether <tt>e</tt> should be picked or not (used
+     * by persistent_filter_iterator).
+     *
+     * Part of the requirements for persistent_filter_iterator
+     * predicates.
+     */
+    bool operator()(const ElementType & e)
+      {
+        if (sampleSize_ == 0) return false;
+
+        if (!inElement_)
+        {
+          // First call on e: split its scaled weight into
+          // deterministic copies and residual weight.
+          // Weights are non-negative, truncation is floor.
+          const WeightType scaled = wac_(e) * scale_;
+          deterministic_ = size_t(scaled);
+          residual_ = scaled - WeightType(deterministic_);
+          inElement_ = true;
+          picksOfCurrent_ = 0;
+        }
+        if (deterministic_ > 0)
+        {
+          deterministic_--;
+          picksOfCurrent_++;
+          return true;
+        }
+        // Systematic sampling of the residual weight, with a step of
+        // 1. Since residual_ < 1, e is picked at most once here.
+        assert(position_ >= 0);
+        if (position_ < residual_)
+        {
+          position_ += 1;
+          picksOfCurrent_++;
+          return true;
+        }
+        position_ -= residual_;
+        inElement_ = false;
+        return false;
+      }
+
+    /**
+     * @brief Return whether @p e has been picked already.
+     *
+     * Same semantics as is_picked_systematic::is_first_pick. This
+     * method is meant to be called by trsl::is_first_pick.
+     */
+    bool is_first_pick(const ElementType &) const
+    {
+      return picksOfCurrent_ <= 1;
+    }
+
+    /**
+     * @brief Returns whether two predicates are at the same sampling
+     * advancement.
+     *
+     * Part of the requirements for persistent_filter_iterator
+     * predicates.
+     */
+    bool operator== (const is_picked_residual<ElementType, WeightType, WeightAccessor> &p) const
+      {
+        return
+          sampleSize_ == p.sampleSize_ &&
+          populationWeight_ == p.populationWeight_ &&
+          position_ == p.position_ &&
+          inElement_ == p.inElement_ &&
+          (!inElement_ || (deterministic_ == p.deterministic_ &&
+                           picksOfCurrent_ == p.picksOfCurrent_));
+      }
+
+  private:
+    void initialize(WeightType randomReal)
+      {
+        // See is_picked_systematic::initialize().
+        if (sampleSize_ != 0)
+          scale_ = sampleSize_ / populationWeight_;
+        else
+          scale_ = 0;
+        position_ = randomReal;
+        inElement_ = false;
+        deterministic_ = 0;
+        residual_ = 0;
+        picksOfCurrent_ = 0;
+      }
+
+  private:
+    WeightAccessor wac_;
+    size_t sampleSize_;
+    WeightType populationWeight_;
+    // Converts a weight to a number of expected picks.
+    WeightType scale_;
+
+    // Distance to the next residual pick, in residual weight units.
+    WeightType position_;
+    // Whether the last call to operator() returned true, i.e. whether
+    // the next call concerns the same element.
+    bool inElement_;
+    size_t deterministic_;
+    WeightType residual_;
+    size_t picksOfCurrent_;
+  };
+
+}
+
+#endif // include guard
@@ -0,0 +1,227 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+/** @file */
+
+#ifndef TRSL_IS_PICKED_STRATIFIED_HPP
+#define TRSL_IS_PICKED_STRATIFIED_HPP
+
+#include <trsl/common.hpp>
+#include <trsl/weight_accessor.hpp>
+
+#include <limits>
+#include <cassert>
+#include <boost/static_assert.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/random/linear_congruential.hpp>
+
+namespace trsl {
+
+  /**
+   * @brief Functor to use with persistent_filter_iterator for
+   * stratified sampling of a range.
+   *
+   * Stratified sampling [1, 2] divides the cumulative population
+   * weight into @p sampleSize strata of equal weight, and picks one
+   * element in each stratum, at a position drawn uniformly within the
+   * stratum. Systematic sampling (trsl::is_picked_systematic) is the
+   * special case where the same position is used in every stratum.
+   * Stratified sampling draws @p sampleSize random numbers instead of
+   * one; in exchange, it is less sensitive to patterns in the order
+   * of the population.
+   *
+   * The random numbers are generated on the fly by a small
+   * pseudo-random generator stored in the predicate, see
+   * trsl::is_picked_multinomial.
+   *
+   * is_picked_stratified satisfies the same requirements as
+   * trsl::is_picked_systematic, and can be used with
+   * trsl::persistent_filter_iterator, trsl::ppfilter_iterator and
+   * trsl::is_first_pick in the same way.
+   *
+   * @param ElementType Type of the elements in the population, see
+   * trsl::is_picked_systematic.
+   *
+   * @param WeightType Element weight type, should be a floating point type.
+   * Defaults to <tt>double</tt>.
+   *
+   * @param WeightAccessor Type of the accessor that will allow to
+   * extract weights from elements. Defaults to mp_weight_accessor,
+   * see @ref accessor for further details on accessors.
+   *
+   * <b>References:</b>
+   *
+   * - [1] R. Douc, O. Cappe, and E. Moulines. Comparison of
+   * resampling schemes for particle filtering. International
+   * Symposium on Parallel and Distributed Processing and
+   * Applications, 2005:64, 2005.
+   *
+   * - [2] J. Hol, T. Sch&ouml;n, and F. Gustafsson. On resampling
+   * algorithms for particle filters. In Nonlinear Statistical Signal
+   * Processing Workshop, 2006.
+   */
+  template<
+    typename ElementType,
+    typename WeightType = double,
+    typename WeightAccessor = mp_weight_accessor<WeightType, ElementType>
+  > class is_picked_stratified
+  {
+  private:
+    BOOST_STATIC_ASSERT((std::numeric_limits<WeightType>::is_integer == false));
+  public:
+    typedef ElementType element_type;
+    typedef WeightType weight_type;
+    typedef WeightAccessor weight_accessor_type;
+    /** @brief Type of the seed of the internal random generator. */
+    typedef boost::uint32_t seed_type;
+
+    /**
+     * @brief Default constructor, shoud not be used explicitely.
+     *
+     * This constructor makes an invalid predicate. It should only be used in
+     * cases where the predicate is never used.
+     */
+    is_picked_stratified() :
+      sampleSize_(0),
+      populationWeight_(0)
+      {
+        initialize( 0 );
+      }
+
+    /**
+     * @brief Construction with system-provided seed.
+     *
+     * The internal generator is seeded with
+     * trsl::rand_gen::uniform_int.  See @ref random for more details.
+     *
+     * @param sampleSize Number of elements in the sample, within
+     * <tt>[0, infinity[</tt>.
+     *
+     * @param populationWeight Total weight of the
+     * population, within <tt>]0, infinity[</tt>. Generally equal to 1.
+     *
+     * @param wac Weight accessor, see trsl::is_picked_systematic.
+     */
+    is_picked_stratified(size_t sampleSize,
+                         WeightType populationWeight,
+                         WeightAccessor const& wac = WeightAccessor()) :
+      wac_(wac), sampleSize_(sampleSize),
+      populationWeight_(populationWeight)
+      {
+        initialize( rand_gen::uniform_int(RAND_MAX) );
+      }
+
+    /**
+     * @brief Construction with user-provided seed.
+     *
+     * Two predicates constructed with the same parameters and the
+     * same @p seed pick the same elements.
+     *
+     * @param sampleSize Number of elements in the sample, within
+     * <tt>[0, infinity[</tt>.
+     *
+     * @param populationWeight Total weight of the
+     * population, within <tt>]0, infinity[</tt>. Generally equal to 1.
+     *
+     * @param seed Seed for the internal random generator.
+     *
+     * @param wac Weight accessor, see trsl::is_picked_systematic.
+     */
+    is_picked_stratified(size_t sampleSize,
+                         WeightType populationWeight,
+                         seed_type seed,
+                         WeightAccessor const& wac = WeightAccessor()) :
+      wac_(wac), sampleSize_(sampleSize),
+      populationWeight_(populationWeight)
+      {
+        initialize(seed);
+      }
+
+    /**
+     * @brief Decides whether <tt>e</tt> should be picked or not (used
+     * by persistent_filter_iterator).
+     *
+     * Part of the requirements for persistent_filter_iterator
+     * predicates.
+     */
+    bool operator()(const ElementType & e)
+      {
+        if (sampleSize_ == 0) return false;
+
+        // Same algorithm as is_picked_systematic, except that the
+        // distance between two consecutive arrows is
+        // (1 - offset_k + offset_k+1) * step instead of step.
+        const WeightType w = wac_(e);
+        assert(position_ >= 0);
+        if (position_ < w)
+        {
+          WeightType offset = rand_gen::uniform_01<WeightType>(rng_);
+          position_ += ((1 - offset_) + offset) * step_;
+          offset_ = offset;
+          picksOfCurrent_++;
+          return true;
+        }
+        position_ -= w;
+        picksOfCurrent_ = 0;
+        return false;
+      }
+
+    /**
+     * @brief Return whether @p e has been picked already.
+     *
+     * Same semantics as is_picked_systematic::is_first_pick. This
+     * method is meant to be called by trsl::is_first_pick.
+     */
+    bool is_first_pick(const ElementType &) const
+    {
+      return picksOfCurrent_ <= 1;
+    }
+
+    /**
+     * @brief Returns whether two predicates are at the same sampling
+     * advancement.
+     *
+     * Part of the requirements for persistent_filter_iterator
+     * predicates.
+     */
+    bool operator== (const is_picked_stratified<ElementType, WeightType, WeightAccessor> &p) const
+      {
+        return
+          sampleSize_ == p.sampleSize_ &&
+          populationWeight_ == p.populationWeight_ &&
+          position_ == p.position_ &&
+          offset_ == p.offset_;
+      }
+
+  private:
+    void initialize(seed_type seed)
+      {
+        rng_.seed(detail::mix_seed(seed));
+        // See is_picked_systematic::initialize().
+        if (sampleSize_ != 0)
+          step_ = populationWeight_ / sampleSize_;
+        else
+          step_ = 0;
+        offset_ = rand_gen::uniform_01<WeightType>(rng_);
+        position_ = offset_ * step_;
+        picksOfCurrent_ = 0;
+      }
+
+  private:
+    WeightAccessor wac_;
+    size_t sampleSize_;
+    WeightType populationWeight_;
+    WeightType step_;
+
+    boost::rand48 rng_;
+    // Position of the current arrow within its stratum, in [0,1[.
+    WeightType offset_;
+    WeightType position_;
+    size_t picksOfCurrent_;
+  };
+
+}
+
+#endif // include guard
@@ -18,6 +18,10 @@
 #include <limits>
 #include <cassert>
 #include <boost/static_assert.hpp>
+#include <boost/utility/enable_if.hpp>
+#include <boost/mpl/or.hpp>
+#include <boost/type_traits/is_arithmetic.hpp>
+#include <boost/type_traits/is_convertible.hpp>
 
 /** @brief Public namespace. */
 namespace trsl {
@@ -69,6 +73,10 @@ namespace trsl {
    * - [2] J. Hol, T. Sch&ouml;n, and F. Gustafsson. On resampling
    * algorithms for particle filters. In Nonlinear Statistical Signal
    * Processing Workshop, 2006.
+   *
+   * @sa trsl::systematic_sample and trsl::systematic_offspring for a
+   * batch implementation that writes picked indices (or pick counts)
+   * to a buffer in a single pass.
    */
   template<
     typename ElementType,
@@ -171,6 +179,30 @@ namespace trsl {
         initialize(uniform01);
       }
 
+    /**
+     * @brief Construction with a random number drawn from @p g.
+     *
+     * Identical to the constructors above, except that the random
+     * number is drawn from @p g, which should model <em>Uniform Random
+     * Number Generator</em>, e.g. trsl::xoshiro256. See @ref random.
+     */
+    template<class UniformRandomNumberGenerator>
+    is_picked_systematic(size_t sampleSize,
+                         WeightType populationWeight,
+                         UniformRandomNumberGenerator& g,
+                         WeightAccessor const& wac = WeightAccessor(),
+                         typename boost::disable_if<
+                           boost::mpl::or_<
+                             boost::is_arithmetic<UniformRandomNumberGenerator>,
+                             boost::is_convertible<UniformRandomNumberGenerator,
+                                                   WeightAccessor> >
+                         >::type* = 0) :
+      wac_(wac), sampleSize_(sampleSize),
+      populationWeight_(populationWeight)
+      {
+        initialize( rand_gen::uniform_01<WeightType>(g) );
+      }
+
     /**
      * @brief Decides whether <tt>e</tt> should be picked or not (used
      * by persistent_filter_iterator).
@@ -182,6 +214,7 @@ namespace trsl {
       {
         if (sampleSize_ == 0) return false;
         
+        const WeightType w = wac_(e);
 #ifdef TRSL_USE_SYSTEMATIC_INTUITIVE_ALGORITHM
         // This algorithm is the intuitive implementation of
         // systematic sampling, where one pictures a wheel with
@@ -190,24 +223,24 @@ namespace trsl {
         // weight; the spokes point to picked elements.
         WeightType arrow = k_*step_;
         assert(cumulative_ <= arrow);
-        if (arrow < cumulative_ + wac_(e))
+        if (arrow < cumulative_ + w)
         {
           k_++;
           return true;
         }
-        cumulative_ += wac_(e);
+        cumulative_ += w;
         return false;
 #else
         // This algorithm is a massaged version of the intuitive
         // algorithm.  Both algorithms are conceptually identical, but
         // this version is faster.
         assert(position_ >= 0);
-        if (position_ < wac_(e))
+        if (position_ < w)
         {
           position_ += step_;
           return true;
         }
-        position_ -= wac_(e);
+        position_ -= w;
         return false;
 #endif
       }
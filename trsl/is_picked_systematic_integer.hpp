@@ -0,0 +1,348 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+/** @file */
+
+#ifndef TRSL_IS_PICKED_SYSTEMATIC_INTEGER_HPP
+#define TRSL_IS_PICKED_SYSTEMATIC_INTEGER_HPP
+
+#include <trsl/error_handling.hpp>
+#include <trsl/common.hpp>
+#include <trsl/weight_accessor.hpp>
+
+#include <cstddef>
+#include <cmath>
+#include <limits>
+#include <boost/cstdint.hpp>
+#include <boost/static_assert.hpp>
+
+namespace trsl {
+
+  namespace detail {
+
+    // Checks that populationWeight is positive and that
+    // (sampleSize + 1) * populationWeight fits in IntegerType.
+    template<typename IntegerType>
+    void check_systematic_integer(size_t sampleSize,
+                                  IntegerType populationWeight,
+                                  const char* caller)
+    {
+      if (! (populationWeight > 0) )
+        throw bad_parameter_value(std::string(caller) +
+                                  ": population weight must be strictly positive.");
+      if (populationWeight >
+          std::numeric_limits<IntegerType>::max() / (IntegerType(sampleSize) + 1))
+        throw bad_parameter_value(std::string(caller) +
+                                  ": sampleSize * populationWeight overflows.");
+    }
+
+    // Returns floor(uniform01 * n) for uniform01 in [0,1[, without
+    // rounding: uniform01 is m * 2^(e-53) with a 53-bit integer m, and
+    // the 128-bit product m * n is shifted right by 53 - e.
+    inline boost::uint64_t exact_floor_product(double uniform01,
+                                               boost::uint64_t n)
+    {
+      if (! (uniform01 > 0) )
+        return 0;
+      int e;
+      const boost::uint64_t m =
+        boost::uint64_t(std::ldexp(std::frexp(uniform01, &e), 53));
+      boost::uint64_t high, low;
+      multiply_64x64(m, n, high, low);
+      const int shift = 53 - e;
+      if (shift >= 128)
+        return 0;
+      if (shift >= 64)
+        return high >> (shift - 64);
+      return (high << (64 - shift)) | (low >> shift);
+    }
+
+    // Checks the parameters, and returns the initial position of the
+    // first arrow, floor(uniform01 * populationWeight), in units of
+    // 1 / sampleSize.
+    template<typename IntegerType>
+    IntegerType systematic_integer_offset(size_t sampleSize,
+                                          IntegerType populationWeight,
+                                          double uniform01,
+                                          const char* caller)
+    {
+      if (sampleSize == 0)
+        return 0;
+      check_systematic_integer(sampleSize, populationWeight, caller);
+      if (! (uniform01 < 1) )
+        return populationWeight - 1;
+      return IntegerType(exact_floor_product(uniform01,
+                                             boost::uint64_t(populationWeight)));
+    }
+
+    // Same as above, with an offset drawn uniformly from
+    // [0, populationWeight[ by the system generator.
+    template<typename IntegerType>
+    IntegerType systematic_integer_offset(size_t sampleSize,
+                                          IntegerType populationWeight,
+                                          const char* caller)
+    {
+      if (sampleSize == 0)
+        return 0;
+      check_systematic_integer(sampleSize, populationWeight, caller);
+      return IntegerType(system_uniform_int(boost::uint64_t(populationWeight)));
+    }
+
+  }
+
+  /**
+   * @brief Functor to use with persistent_filter_iterator for exact
+   * systematic sampling of a population with integer weights.
+   *
+   * is_picked_systematic subtracts floating-point weights from its
+   * position at each element; over a very large population, rounding
+   * errors accumulate, and the sample may contain one element more or
+   * less than requested. is_picked_systematic_integer implements the
+   * same algorithm on integer weights, scaled by the sample size:
+   * element weights become <tt>sampleSize * w</tt>, and the step
+   * between two arrows becomes the population weight. All operations
+   * are exact; if @p populationWeight is the sum of the weights, the
+   * sample contains exactly @p sampleSize elements. Integer
+   * arithmetic is also cheaper than floating-point arithmetic on
+   * populations that naturally have integer weights, e.g.
+   * histograms.
+   *
+   * Floating-point weights can be sampled exactly by converting them
+   * to fixed point, see fixed_point_weight_accessor; the population
+   * weight must then be computed with the same accessor.
+   *
+   * For a given @p uniform01, the sample is that of
+   * is_picked_systematic on the same weights, up to the rounding
+   * errors of the latter.
+   *
+   * The constructors throw a bad_parameter_value if the population
+   * weight is null while the sample size is not, or if <tt>(sampleSize
+   * + 1) * populationWeight</tt> does not fit in @p WeightType.
+   *
+   * @param ElementType Type of the elements in the population.
+   *
+   * @param WeightType Element weight type, should be an unsigned
+   * integer type. Defaults to <tt>boost::uint64_t</tt>.
+   *
+   * @param WeightAccessor Type of the accessor that will allow to
+   * extract weights from elements. Defaults to mp_weight_accessor,
+   * see @ref accessor for further details on accessors.
+   */
+  template<
+    typename ElementType,
+    typename WeightType = boost::uint64_t,
+    typename WeightAccessor = mp_weight_accessor<WeightType, ElementType>
+  > class is_picked_systematic_integer
+  {
+  private:
+    BOOST_STATIC_ASSERT((std::numeric_limits<WeightType>::is_integer == true));
+    BOOST_STATIC_ASSERT((std::numeric_limits<WeightType>::is_signed == false));
+  public:
+    typedef ElementType element_type;
+    typedef WeightType weight_type;
+    typedef WeightAccessor weight_accessor_type;
+
+    /**
+     * @brief Default constructor, shoud not be used explicitely.
+     */
+    is_picked_systematic_integer() :
+      sampleSize_(0), populationWeight_(0), position_(0)
+      {}
+
+    /**
+     * @brief Construction with system-provided random number.
+     *
+     * The initial position is drawn uniformly among the @p
+     * populationWeight possible positions, by the system generator
+     * behind trsl::rand_gen::uniform_int. See @ref random.
+     *
+     * @param sampleSize Number of elements in the sample, within
+     * <tt>[0, infinity[</tt>.
+     *
+     * @param populationWeight Sum of the weights of the population.
+     *
+     * @param wac Weight accessor, see @ref accessor.
+     */
+    is_picked_systematic_integer(size_t sampleSize,
+                                 WeightType populationWeight,
+                                 WeightAccessor const& wac = WeightAccessor()) :
+      wac_(wac), sampleSize_(sampleSize),
+      populationWeight_(populationWeight)
+      {
+        position_ = detail::systematic_integer_offset(
+          sampleSize, populationWeight, "is_picked_systematic_integer");
+      }
+
+    /**
+     * @brief Construction with user-provided random number.
+     *
+     * @param uniform01 Random number in <tt>[0,1[</tt>. The initial
+     * position is <tt>floor(uniform01 * populationWeight)</tt>,
+     * computed without rounding. A <tt>double</tt> has 53 bits: with
+     * a population weight above <tt>2^53</tt>, only one position in
+     * <tt>populationWeight / 2^53</tt> can be reached. The
+     * constructor above reaches all positions.
+     *
+     * See above for the other parameters.
+     */
+    is_picked_systematic_integer(size_t sampleSize,
+                                 WeightType populationWeight,
+                                 double uniform01,
+                                 WeightAccessor const& wac = WeightAccessor()) :
+      wac_(wac), sampleSize_(sampleSize),
+      populationWeight_(populationWeight)
+      {
+        position_ = detail::systematic_integer_offset(
+          sampleSize, populationWeight, uniform01,
+          "is_picked_systematic_integer");
+      }
+
+    /**
+     * @brief Decides whether <tt>e</tt> should be picked or not (used
+     * by persistent_filter_iterator).
+     */
+    bool operator()(const ElementType & e)
+      {
+        if (sampleSize_ == 0) return false;
+
+        // Same algorithm as is_picked_systematic, in units of
+        // 1 / sampleSize_: the step is populationWeight_.
+        const WeightType w = WeightType(sampleSize_) * wac_(e);
+        if (position_ < w)
+        {
+          position_ += populationWeight_;
+          return true;
+        }
+        position_ -= w;
+        return false;
+      }
+
+    /**
+     * @brief Same semantics as is_picked_systematic::is_first_pick.
+     * This method is meant to be called by trsl::is_first_pick.
+     */
+    bool is_first_pick(const ElementType & e) const
+      {
+        if (WeightType(sampleSize_) * wac_(e) <= populationWeight_) return true;
+        return position_ < 2*populationWeight_;
+      }
+
+    /**
+     * @brief Returns whether two predicates are at the same sampling
+     * advancement.
+     */
+    bool operator== (const is_picked_systematic_integer<ElementType, WeightType, WeightAccessor> &p) const
+      {
+        return sampleSize_ == p.sampleSize_ &&
+          populationWeight_ == p.populationWeight_ &&
+          position_ == p.position_;
+      }
+
+  private:
+    WeightAccessor wac_;
+    size_t sampleSize_;
+    WeightType populationWeight_;
+    WeightType position_;
+  };
+
+  /**
+   * @brief Writes, for each element of [@p first, @p last), the
+   * number of times it is picked by exact systematic sampling.
+   *
+   * Batch counterpart of is_picked_systematic_integer, which it
+   * matches exactly for the same @p uniform01. The count of each
+   * element is computed with one division, instead of one iteration
+   * per pick; the cost of the pass does not depend on the sample
+   * size.
+   *
+   * @param out Output iterator to which counts are written, as
+   * <tt>size_t</tt>. It should have room for
+   * <tt>std::distance(first, last)</tt> counts.
+   *
+   * See is_picked_systematic_integer and trsl::systematic_offspring
+   * for the other parameters.
+   *
+   * @return The output iterator, past the last written count.
+   */
+  template<
+    class ElementIterator,
+    typename WeightType,
+    class WeightAccessor,
+    class OutputIterator
+  >
+  OutputIterator systematic_offspring_integer(ElementIterator first,
+                                              ElementIterator last,
+                                              size_t sampleSize,
+                                              WeightType populationWeight,
+                                              double uniform01,
+                                              WeightAccessor wac,
+                                              OutputIterator out)
+  {
+    BOOST_STATIC_ASSERT((std::numeric_limits<WeightType>::is_integer == true));
+    BOOST_STATIC_ASSERT((std::numeric_limits<WeightType>::is_signed == false));
+    WeightType position = detail::systematic_integer_offset(
+      sampleSize, populationWeight, uniform01,
+      "systematic_offspring_integer");
+    for (; first != last; ++first)
+    {
+      const WeightType w = WeightType(sampleSize) * wac(*first);
+      if (position < w)
+      {
+        // Arrows position + k * populationWeight within [0, w[.
+        const WeightType count = (w - position - 1) / populationWeight + 1;
+        position = position + count * populationWeight - w;
+        *out++ = size_t(count);
+      }
+      else
+      {
+        position -= w;
+        *out++ = size_t(0);
+      }
+    }
+    return out;
+  }
+
+  /**
+   * @brief Weight accessor that converts the weights returned by
+   * another accessor to fixed point.
+   *
+   * Returns <tt>floor(w * scale)</tt> as an unsigned integer, where
+   * <tt>w</tt> is the weight returned by @p WeightAccessor, which
+   * should be non-negative. Used with is_picked_systematic_integer,
+   * it samples a population of floating-point weights exactly; the
+   * population weight must be computed with the same accessor.
+   *
+   * The scale is a trade-off between the resolution of the weights
+   * and overflow: <tt>(sampleSize + 1)</tt> times the sum of the
+   * converted weights must fit in @p IntegerType. For weights
+   * normalized to 1 and 64-bit integers, a scale of
+   * <tt>2^32</tt> allows samples of up to about 4 billion elements.
+   */
+  template<
+    typename IntegerType,
+    typename ElementType,
+    typename WeightAccessor
+  >
+  class fixed_point_weight_accessor
+  {
+  public:
+    fixed_point_weight_accessor() : scale_(1) {}
+
+    fixed_point_weight_accessor(double scale,
+                                WeightAccessor const& wac = WeightAccessor()) :
+      wac_(wac), scale_(scale) {}
+
+    IntegerType operator()(ElementType const& e) const
+      {
+        return IntegerType(std::floor(double(wac_(e)) * scale_));
+      }
+  private:
+    WeightAccessor wac_;
+    double scale_;
+  };
+
+}
+
+#endif // include guard
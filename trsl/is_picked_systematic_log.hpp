@@ -0,0 +1,209 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+/** @file */
+
+#ifndef TRSL_IS_PICKED_SYSTEMATIC_LOG_HPP
+#define TRSL_IS_PICKED_SYSTEMATIC_LOG_HPP
+
+#include <trsl/is_picked_systematic.hpp>
+#include <trsl/weight_accessor.hpp>
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+namespace trsl {
+
+  namespace detail {
+
+    // Number of log-weights whose maximum is computed before they
+    // are exponentiated by log_sum_exp.
+    static const size_t log_sum_exp_block_size = 64;
+
+  }
+
+  /**
+   * @brief Returns the logarithm of the total weight of [@p first,
+   * @p last), given the logarithms of element weights.
+   *
+   * Computes <tt>log(sum(exp(lwac(e))))</tt> without underflow or
+   * overflow, in a single pass over the population: log-weights are
+   * read by blocks, the maximum @p m of a block is computed first,
+   * and <tt>exp(lwac(e) - m)</tt> is accumulated relative to the
+   * largest maximum seen so far. The accessor is called once per
+   * element.
+   *
+   * @p ElementIterator should model <em>Input Iterator</em>.
+   *
+   * @param lwac Log-weight accessor, see @ref accessor. Log-weights
+   * may be <tt>-infinity</tt> (null weights).
+   *
+   * @return The log of the population weight, or <tt>-infinity</tt>
+   * if the population is empty or all its weights are null.
+   */
+  template<typename WeightType, class ElementIterator, class LogWeightAccessor>
+  WeightType log_sum_exp(ElementIterator first,
+                         ElementIterator last,
+                         LogWeightAccessor const& lwac)
+  {
+    const WeightType minusInf = -std::numeric_limits<WeightType>::infinity();
+    WeightType block[detail::log_sum_exp_block_size];
+    // The population weight is exp(max) * sum.
+    WeightType max = minusInf;
+    WeightType sum = 0;
+    while (first != last)
+    {
+      size_t n = 0;
+      for (; n < detail::log_sum_exp_block_size && first != last; ++n, ++first)
+        block[n] = lwac(*first);
+      WeightType blockMax = minusInf;
+      for (size_t i = 0; i < n; ++i)
+        blockMax = std::max(blockMax, block[i]);
+      if (blockMax == minusInf)
+        continue;
+      if (blockMax > max)
+      {
+        sum *= std::exp(max - blockMax);
+        max = blockMax;
+      }
+      for (size_t i = 0; i < n; ++i)
+        sum += std::exp(block[i] - max);
+    }
+    if (max == minusInf)
+      return minusInf;
+    return max + std::log(sum);
+  }
+
+  /**
+   * @brief Weight accessor that returns the weight of an element
+   * relative to a normalizer, given a log-weight accessor.
+   *
+   * Returns <tt>exp(lwac(e) - logNormalizer)</tt>. With @p
+   * logNormalizer set to the log_sum_exp() of the population, the
+   * weights sum to 1, even when <tt>exp(lwac(e))</tt> would underflow.
+   *
+   * @param LogWeightAccessor Log-weight accessor, see @ref accessor.
+   */
+  template<typename WeightType, typename ElementType,
+           class LogWeightAccessor = mp_weight_accessor<WeightType, ElementType> >
+  class exp_weight_accessor
+  {
+  public:
+    exp_weight_accessor() : logNormalizer_(0) {}
+
+    exp_weight_accessor(LogWeightAccessor const& lwac,
+                        WeightType logNormalizer) :
+      lwac_(lwac), logNormalizer_(logNormalizer) {}
+
+    /**
+     * @brief Functor implementation.
+     *
+     * @return <tt>exp(lwac(e) - logNormalizer)</tt>.
+     */
+    WeightType operator()(ElementType const& e) const
+      {
+        return std::exp(WeightType(lwac_(e)) - logNormalizer_);
+      }
+
+  private:
+    LogWeightAccessor lwac_;
+    WeightType logNormalizer_;
+  };
+
+  /**
+   * @brief Systematic sampling predicate for elements whose weights
+   * are given as logarithms.
+   *
+   * When weights are likelihoods, they often underflow floating-point
+   * types, and are better stored as logarithms. This predicate
+   * behaves as is_picked_systematic, but reads log-weights through
+   * its accessor. The log of the population weight, typically
+   * computed by log_sum_exp(), is subtracted from each log-weight
+   * before exponentiation: weights are thus normalized on the fly,
+   * and the population never has to be converted to linear weights.
+   *
+   * A typical use reads the population twice: once in log_sum_exp(),
+   * once through the sample iterator.
+   *
+   * @param ElementType Type of the elements in the population, see
+   * trsl::is_picked_systematic.
+   *
+   * @param WeightType Element weight type, should be a floating point type.
+   * Defaults to <tt>double</tt>.
+   *
+   * @param LogWeightAccessor Type of the accessor that will allow to
+   * extract log-weights from elements. Defaults to mp_weight_accessor,
+   * see @ref accessor for further details on accessors.
+   */
+  template<
+    typename ElementType,
+    typename WeightType = double,
+    typename LogWeightAccessor = mp_weight_accessor<WeightType, ElementType>
+  > class is_picked_systematic_log :
+    public is_picked_systematic<
+      ElementType, WeightType,
+      exp_weight_accessor<WeightType, ElementType, LogWeightAccessor> >
+  {
+    typedef is_picked_systematic<
+      ElementType, WeightType,
+      exp_weight_accessor<WeightType, ElementType, LogWeightAccessor>
+    > super_t;
+  public:
+    typedef LogWeightAccessor log_weight_accessor_type;
+
+    /**
+     * @brief Default constructor, shoud not be used explicitely.
+     *
+     * See is_picked_systematic::is_picked_systematic().
+     */
+    is_picked_systematic_log() {}
+
+    /**
+     * @brief Construction with system-provided random number.
+     *
+     * @param sampleSize Number of elements in the sample, within
+     * <tt>[0, infinity[</tt>.
+     *
+     * @param logPopulationWeight Logarithm of the total weight of the
+     * population, see log_sum_exp(). Should be finite.
+     *
+     * @param lwac Log-weight accessor. If you pass a method pointer,
+     * it is wrapped in a mp_weight_accessor.
+     */
+    is_picked_systematic_log(size_t sampleSize,
+                             WeightType logPopulationWeight,
+                             LogWeightAccessor const& lwac = LogWeightAccessor()) :
+      super_t(sampleSize, 1,
+              exp_weight_accessor<WeightType, ElementType, LogWeightAccessor>(
+                lwac, logPopulationWeight))
+      {}
+
+    /**
+     * @brief Construction with user-provided random number.
+     *
+     * @param sampleSize Number of elements in the sample, within
+     * <tt>[0, infinity[</tt>.
+     *
+     * @param logPopulationWeight Logarithm of the total weight of the
+     * population, see log_sum_exp(). Should be finite.
+     *
+     * @param uniform01 Random number in <tt>[0,1[</tt>.
+     *
+     * @param lwac Log-weight accessor.
+     */
+    is_picked_systematic_log(size_t sampleSize,
+                             WeightType logPopulationWeight,
+                             WeightType uniform01,
+                             LogWeightAccessor const& lwac = LogWeightAccessor()) :
+      super_t(sampleSize, 1, uniform01,
+              exp_weight_accessor<WeightType, ElementType, LogWeightAccessor>(
+                lwac, logPopulationWeight))
+      {}
+  };
+
+}
+
+#endif // include guard
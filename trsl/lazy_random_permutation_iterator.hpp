@@ -0,0 +1,362 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+/** @file */
+
+#ifndef TRSL_LAZY_RANDOM_PERMUTATION_ITERATOR_HPP
+#define TRSL_LAZY_RANDOM_PERMUTATION_ITERATOR_HPP
+
+#include <trsl/common.hpp>
+#include <trsl/xoshiro256.hpp>
+#include <trsl/error_handling.hpp>
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/utility/enable_if.hpp>
+#include <boost/type_traits/is_arithmetic.hpp>
+#include <boost/detail/iterator.hpp>
+#include <boost/iterator/iterator_facade.hpp>
+#include <boost/iterator/iterator_adaptor.hpp> // enable_if_convertible
+
+namespace trsl
+{
+
+  template<class ElementIterator, class RandomNumberGenerator>
+  class lazy_reorder_iterator;
+
+  namespace detail
+  {
+    /**
+     * @brief Used internally. Fisher-Yates shuffle of the indices
+     * <tt>[0, populationSize[</tt>, performed one step at a time.
+     *
+     * The array being shuffled is not stored: an index that has not
+     * been moved yet is equal to its position, and the few indices
+     * that have been moved are kept in a hash map. Memory and time
+     * are thus proportional to the number of steps performed.
+     */
+    template<class RandomNumberGenerator>
+    class lazy_permutation
+    {
+    public:
+      typedef size_t index_t;
+
+      lazy_permutation(size_t populationSize,
+                       size_t permutationSize,
+                       RandomNumberGenerator const& rng) :
+        populationSize_(populationSize),
+        permutationSize_(permutationSize),
+        rng_(rng)
+        {}
+
+      size_t size() const { return permutationSize_; }
+
+      /**
+       * @brief Returns the index at position @p i of the permutation,
+       * performing the shuffle steps up to @p i if needed.
+       */
+      index_t operator[](size_t i)
+        {
+          while (drawn_.size() <= i)
+            step();
+          return drawn_[i];
+        }
+
+    private:
+      index_t at(index_t j) const
+        {
+          typename displaced_map::const_iterator d = displaced_.find(j);
+          return d == displaced_.end() ? j : d->second;
+        }
+
+      void step()
+        {
+          const index_t j = drawn_.size();
+          const index_t r = j + index_t(rng_(std::ptrdiff_t(populationSize_ - j)));
+          drawn_.push_back(at(r));
+          // Position j is never read again: the index it held moves to
+          // position r, and j is forgotten.
+          if (r != j)
+            displaced_[r] = at(j);
+          displaced_.erase(j);
+        }
+
+      typedef boost::unordered_map<index_t, index_t> displaced_map;
+
+      size_t populationSize_;
+      size_t permutationSize_;
+      RandomNumberGenerator rng_;
+      std::vector<index_t> drawn_;
+      displaced_map displaced_;
+    };
+
+    /** @brief Used internally. */
+    template<class ElementIterator, class RandomNumberGenerator>
+    struct lazy_reorder_iterator_base
+    {
+      typedef boost::iterator_facade<
+        lazy_reorder_iterator<ElementIterator, RandomNumberGenerator>,
+        typename boost::detail::iterator_traits<ElementIterator>::value_type,
+        boost::random_access_traversal_tag,
+        typename boost::detail::iterator_traits<ElementIterator>::reference
+      > type;
+    };
+  }
+
+  /**
+   * @brief Provides an iterator over a random permutation of a range,
+   * computed as the iterator advances.
+   *
+   * trsl::random_permutation_iterator fills and shuffles an array of
+   * indices before the first element is read, which costs time and
+   * memory proportional to the size of the population. When a loop
+   * often stops after a few elements, most of that work is wasted.
+   * lazy_reorder_iterator performs one step of a Fisher-Yates shuffle
+   * each time it reaches a position that has not been drawn yet:
+   * construction costs <tt>O(1)</tt>, and the total cost is
+   * proportional to the number of positions reached. The indices
+   * moved by the shuffle are stored in a hash map; on a full
+   * traversal, random_permutation_iterator is faster.
+   *
+   * As with reorder_iterator, the state of the permutation is stored
+   * within the iterator by means of a <a
+   * href="http://www.boost.org/libs/smart_ptr/shared_ptr.htm"
+   * >boost::shared_ptr</a>: all copies of an iterator share it, and
+   * go through the same permutation. Copies are not thread-safe,
+   * since dereferencing one may extend the shared permutation.
+   *
+   * Instances are constructed with lazy_random_permutation_iterator().
+   *
+   * @p ElementIterator should model <em>Random Access Iterator</em>.
+   *
+   * @param RandomNumberGenerator Functor called as <tt>rng(n)</tt>,
+   * which returns an integer in <tt>[0,n[</tt>.
+   */
+  template<
+    class ElementIterator,
+    class RandomNumberGenerator = detail::system_uniform_int_generator
+  >
+  class lazy_reorder_iterator
+    : public detail::lazy_reorder_iterator_base<
+        ElementIterator, RandomNumberGenerator>::type
+  {
+    typedef typename detail::lazy_reorder_iterator_base<
+      ElementIterator, RandomNumberGenerator>::type super_t;
+
+    friend class boost::iterator_core_access;
+
+  public:
+    typedef ElementIterator element_iterator;
+    typedef detail::lazy_permutation<RandomNumberGenerator> permutation_type;
+    typedef typename permutation_type::index_t index_t;
+    typedef boost::shared_ptr<permutation_type> permutation_ptr;
+
+    lazy_reorder_iterator() :
+      m_elt_iter(), m_position(0)
+      {}
+
+    /**
+     * @brief Constructs an iterator that will walk through the elements
+     * of the range that begins at @p first, following the order
+     * defined by @p permutation.
+     */
+    lazy_reorder_iterator(ElementIterator first,
+                          const permutation_ptr& permutation) :
+      m_elt_iter(first), m_permutation(permutation), m_position(0)
+      {}
+
+    /**
+     * @brief Allows conversion from a lazy_reorder_iterator to a const
+     * lazy_reorder_iterator, see reorder_iterator.
+     */
+    template<class OtherElementIterator>
+    lazy_reorder_iterator
+    (lazy_reorder_iterator<OtherElementIterator, RandomNumberGenerator> const& r,
+     typename boost::enable_if_convertible<OtherElementIterator, ElementIterator>::type* = 0) :
+      m_elt_iter(r.m_elt_iter), m_permutation(r.m_permutation),
+      m_position(r.m_position)
+      {}
+
+    /**
+     * @brief Returns an iterator pointing to the beginning of the
+     * permutation.
+     */
+    lazy_reorder_iterator begin() const
+      {
+        lazy_reorder_iterator i(*this);
+        i.m_position = 0;
+        return i;
+      }
+
+    /**
+     * @brief Returns an iterator pointing to the end of the
+     * permutation.
+     */
+    lazy_reorder_iterator end() const
+      {
+        lazy_reorder_iterator i(*this);
+        i.m_position = m_permutation->size();
+        return i;
+      }
+
+    /**
+     * @brief Returns the index of the element that the iterator is
+     * currently pointing to.
+     */
+    index_t index() const
+      {
+        return (*m_permutation)[m_position];
+      }
+
+  private:
+    typename super_t::reference dereference() const
+      { return *(m_elt_iter + index()); }
+
+    bool equal(lazy_reorder_iterator const& i) const
+      { return m_position == i.m_position; }
+
+    void increment() { ++m_position; }
+
+    void decrement() { --m_position; }
+
+    void advance(typename super_t::difference_type n)
+      { m_position += n; }
+
+    typename super_t::difference_type
+    distance_to(lazy_reorder_iterator const& i) const
+      {
+        return typename super_t::difference_type(i.m_position) -
+          typename super_t::difference_type(m_position);
+      }
+
+#ifndef BOOST_NO_MEMBER_TEMPLATE_FRIENDS
+    template <class, class> friend class lazy_reorder_iterator;
+#else
+  public:
+#endif
+    ElementIterator m_elt_iter;
+    permutation_ptr m_permutation;
+    size_t m_position;
+  };
+
+  namespace detail
+  {
+    /** @brief Used internally. */
+    template<class ElementIterator, class RandomNumberGenerator>
+    lazy_reorder_iterator<ElementIterator, RandomNumberGenerator>
+    lazy_random_permutation_iterator(ElementIterator first,
+                                     ElementIterator last,
+                                     size_t permutationSize,
+                                     RandomNumberGenerator const& rng)
+    {
+      typedef lazy_reorder_iterator<ElementIterator, RandomNumberGenerator>
+        iterator;
+      std::ptrdiff_t size = std::distance(first, last);
+      if (size < 0)
+        throw bad_parameter_value(
+          "lazy_random_permutation_iterator: "
+          "bad input range.");
+      if (permutationSize > size_t(size))
+        throw bad_parameter_value(
+          "lazy_random_permutation_iterator: "
+          "parameter permutationSize out of range.");
+      typename iterator::permutation_ptr permutation(
+        new typename iterator::permutation_type(size_t(size),
+                                                permutationSize, rng));
+      return iterator(first, permutation);
+    }
+  }
+
+  /**
+   * @brief Constructs a lazy_reorder_iterator that will iterate
+   * through a random subset of size @p permutationSize of a random
+   * permutation of the population referenced by @p first and @p last.
+   *
+   * The @p permutationSize should be smaller or equal to the
+   * size of the population. If it is not the case, a bad_parameter_value
+   * is thrown.
+   *
+   * Random integers are provided by rand_gen::uniform_int; see @ref
+   * random for further details.
+   */
+  template<class ElementIterator>
+  lazy_reorder_iterator<ElementIterator>
+  lazy_random_permutation_iterator(ElementIterator first,
+                                   ElementIterator last,
+                                   size_t permutationSize)
+  {
+    return detail::lazy_random_permutation_iterator(
+      first, last, permutationSize, detail::system_uniform_int_generator());
+  }
+
+  /**
+   * @brief Constructs a lazy_reorder_iterator that will iterate
+   * through a random subset of size @p permutationSize of a random
+   * permutation of the population referenced by @p first and @p last,
+   * drawing random numbers from @p g.
+   *
+   * @p g should model <em>Uniform Random Number Generator</em>, see
+   * @ref random. Since the permutation is drawn as the iterator
+   * advances, it is not drawn from @p g: 64 bits are drawn from @p g
+   * at construction, and seed a private xoshiro256 engine shared by
+   * the iterator and its copies (see rand_gen::xoshiro256_uniform_int).
+   * The permutation thus only depends on the state of @p g at
+   * construction, and @p g may be destroyed or used while the
+   * iterator is in use.
+   */
+  template<class ElementIterator, class UniformRandomNumberGenerator>
+  lazy_reorder_iterator<ElementIterator, rand_gen::xoshiro256_uniform_int>
+  lazy_random_permutation_iterator(ElementIterator first,
+                                   ElementIterator last,
+                                   size_t permutationSize,
+                                   UniformRandomNumberGenerator& g)
+  {
+    return detail::lazy_random_permutation_iterator(
+      first, last, permutationSize,
+      rand_gen::xoshiro256_uniform_int::from(g));
+  }
+
+  /**
+   * @brief Constructs a lazy_reorder_iterator that will iterate
+   * through a random permutation of the population referenced by @p
+   * first and @p last.
+   *
+   * See above.
+   */
+  template<class ElementIterator>
+  lazy_reorder_iterator<ElementIterator>
+  lazy_random_permutation_iterator(ElementIterator first,
+                                   ElementIterator last)
+  {
+    return lazy_random_permutation_iterator(first, last,
+                                            std::distance(first, last));
+  }
+
+  /**
+   * @brief Constructs a lazy_reorder_iterator that will iterate
+   * through a random permutation of the population referenced by @p
+   * first and @p last, drawing random numbers from @p g.
+   *
+   * See above.
+   */
+  template<class ElementIterator, class UniformRandomNumberGenerator>
+  typename boost::disable_if<
+    boost::is_arithmetic<UniformRandomNumberGenerator>,
+    lazy_reorder_iterator<ElementIterator, rand_gen::xoshiro256_uniform_int>
+  >::type
+  lazy_random_permutation_iterator(ElementIterator first,
+                                   ElementIterator last,
+                                   UniformRandomNumberGenerator& g)
+  {
+    return lazy_random_permutation_iterator(first, last,
+                                            std::distance(first, last), g);
+  }
+
+} // namespace trsl
+
+#endif // include guard
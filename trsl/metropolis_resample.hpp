@@ -0,0 +1,157 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+/** @file */
+
+#ifndef TRSL_METROPOLIS_RESAMPLE_HPP
+#define TRSL_METROPOLIS_RESAMPLE_HPP
+
+#include <trsl/common.hpp>
+#include <trsl/error_handling.hpp>
+#include <trsl/weight_accessor.hpp>
+
+#include <cstddef>
+#include <boost/cstdint.hpp>
+#include <boost/random/linear_congruential.hpp>
+
+namespace trsl {
+
+  /**
+   * @brief Writes the indices of a sample of [@p first, @p last)
+   * drawn by Metropolis resampling to @p out.
+   *
+   * Metropolis resampling [1] computes each element of the sample
+   * with a short Metropolis chain over the population. The chain of
+   * slot @p i starts at element <tt>i % n</tt>. At each of the @p
+   * nSteps steps, it proposes an element <tt>j</tt> drawn uniformly,
+   * and moves to <tt>j</tt> with probability <tt>min(1, w(j) /
+   * w(k))</tt>, where <tt>k</tt> is the current element. The sample
+   * contains the last element of each chain.
+   *
+   * Unlike systematic or multinomial sampling, Metropolis resampling
+   * only compares the weights of pairs of elements: it does not
+   * need the total weight of the population, nor a cumulative sum of
+   * the weights. Slots are thus independent from each other, and are
+   * computed in parallel by OpenMP threads when OpenMP is available.
+   * Each slot has its own random generator, seeded from @p seed and
+   * the slot number: the sample depends on @p seed, but not on the
+   * number of threads.
+   *
+   * The price to pay is bias: the chains only approximately reach
+   * their stationary distribution (which is the distribution of the
+   * weights). The more unbalanced the weights, the larger @p nSteps
+   * should be. [1] suggests choosing @p nSteps such that
+   * <tt>(1 - E[w]/max w)^nSteps</tt> is small; for reasonably
+   * balanced weights, a few tens of steps are enough.  When an upper
+   * bound on the weights is known, trsl::rejection_resample is
+   * unbiased.
+   *
+   * The weight accessor is called concurrently from several threads.
+   * Weights are compared in <tt>double</tt> precision.
+   *
+   * @param first, last Population range. @p RandomAccessIterator
+   * should model <em>Random Access Iterator</em>.
+   *
+   * @param sampleSize Number of elements in the sample, within
+   * <tt>[0, infinity[</tt>.
+   *
+   * @param nSteps Length of the Metropolis chains.
+   *
+   * @param seed Seed for the random generators.
+   *
+   * @param wac Weight accessor, see @ref accessor. Note that a bare
+   * method pointer is not an accessor; wrap it in a
+   * trsl::mp_weight_accessor.
+   *
+   * @param out Random access iterator to which indices are written,
+   * as <tt>size_t</tt>. It should have room for @p sampleSize
+   * indices.
+   *
+   * @return The output iterator, past the last written index.
+   *
+   * Throws a bad_parameter_value if the population is empty.
+   *
+   * <b>References:</b>
+   *
+   * - [1] L. M. Murray, A. Lee, and P. E. Jacob. Parallel resampling
+   * in the particle filter. Journal of Computational and Graphical
+   * Statistics, 25(3):789-805, 2016.
+   */
+  template<
+    class RandomAccessIterator,
+    class WeightAccessor,
+    class RandomAccessOutputIterator
+  >
+  RandomAccessOutputIterator
+  metropolis_resample(RandomAccessIterator first,
+                      RandomAccessIterator last,
+                      size_t sampleSize,
+                      unsigned nSteps,
+                      boost::uint32_t seed,
+                      WeightAccessor wac,
+                      RandomAccessOutputIterator out)
+  {
+    const size_t n = last - first;
+    if (n == 0)
+      throw bad_parameter_value(
+        "metropolis_resample: empty population.");
+
+    const long signedSize = long(sampleSize);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (long i = 0; i < signedSize; ++i)
+    {
+      boost::rand48 rng(detail::stream_seed(seed, boost::uint32_t(i)));
+      rand_gen::uniform_int_adaptor<boost::rand48> index(rng);
+      size_t k = size_t(i) % n;
+      double wk = wac(first[k]);
+      for (unsigned step = 0; step < nSteps; ++step)
+      {
+        const size_t j = size_t(index(std::ptrdiff_t(n)));
+        const double wj = wac(first[j]);
+        // Accept with probability min(1, wj/wk), without dividing. The
+        // comparison is strict, so that a proposal of weight zero is
+        // never accepted.
+        if (rand_gen::uniform_01<double>(rng) * wk < wj)
+        {
+          k = j;
+          wk = wj;
+        }
+      }
+      out[i] = k;
+    }
+    return out + sampleSize;
+  }
+
+  /**
+   * @brief Writes the indices of a sample of [@p first, @p last)
+   * drawn by Metropolis resampling to @p out, with system-provided
+   * seed.
+   *
+   * Identical to the function above, except that the seed is
+   * generated by trsl::rand_gen::uniform_int. See @ref random.
+   */
+  template<
+    class RandomAccessIterator,
+    class WeightAccessor,
+    class RandomAccessOutputIterator
+  >
+  RandomAccessOutputIterator
+  metropolis_resample(RandomAccessIterator first,
+                      RandomAccessIterator last,
+                      size_t sampleSize,
+                      unsigned nSteps,
+                      WeightAccessor wac,
+                      RandomAccessOutputIterator out)
+  {
+    return metropolis_resample(first, last, sampleSize, nSteps,
+                               boost::uint32_t(rand_gen::uniform_int(RAND_MAX)),
+                               wac, out);
+  }
+
+}
+
+#endif // include guard
@@ -0,0 +1,504 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+/** @file */
+
+#ifndef TRSL_PARALLEL_SYSTEMATIC_SAMPLE_HPP
+#define TRSL_PARALLEL_SYSTEMATIC_SAMPLE_HPP
+
+#include <trsl/systematic_sample.hpp>
+
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+#include <limits>
+#include <iterator>
+#include <boost/static_assert.hpp>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace trsl {
+
+  namespace detail {
+
+    // Smallest number of elements worth a chunk of its own.
+    static const size_t systematic_min_chunk_size = 16384;
+
+    template<typename WeightType>
+    struct systematic_chunk
+    {
+      size_t begin;
+      size_t end;
+      // Weight of the chunk, as an unevaluated sum sum + compensation.
+      WeightType sum;
+      WeightType compensation;
+      // Value of is_picked_systematic's position_ when entering the
+      // chunk, and bound on its error.
+      WeightType position;
+      WeightType positionError;
+      // Set by systematic_walk(), see there.
+      WeightType slack;
+      WeightType drift;
+      size_t picks;
+    };
+
+    // Computes hi + lo == a * b exactly (Dekker).
+    template<typename WeightType>
+    inline void exact_product(WeightType a, WeightType b,
+                              WeightType& hi, WeightType& lo)
+    {
+      const WeightType splitter =
+        std::ldexp(WeightType(1),
+                   (std::numeric_limits<WeightType>::digits + 1) / 2) + 1;
+      WeightType t = splitter * a;
+      const WeightType ah = t - (t - a), al = a - ah;
+      t = splitter * b;
+      const WeightType bh = t - (t - b), bl = b - bh;
+      hi = a * b;
+      lo = ((ah * bh - hi) + ah * bl + al * bh) + al * bl;
+    }
+
+    // Element visitors for systematic_walk.
+
+    struct systematic_pick_counter
+    {
+      systematic_pick_counter() : picks(0) {}
+      void operator()(size_t /* index */, size_t count) { picks += count; }
+      size_t picks;
+    };
+
+    template<class OutputIterator>
+    struct systematic_index_writer
+    {
+      systematic_index_writer(OutputIterator out) : out(out) {}
+      void operator()(size_t index, size_t count)
+      {
+        for (; count > 0; --count)
+          *out++ = index;
+      }
+      OutputIterator out;
+    };
+
+    template<class RandomAccessIterator>
+    struct systematic_count_writer
+    {
+      systematic_count_writer(RandomAccessIterator out) : out(out), picks(0) {}
+      void operator()(size_t index, size_t count)
+      {
+        out[index] = count;
+        picks += count;
+      }
+      RandomAccessIterator out;
+      size_t picks;
+    };
+
+    /**
+     * @brief Runs the recurrence of is_picked_systematic on @p chunk,
+     * and calls @p visit with the pick count of each element.
+     *
+     * Along the way, accumulates in @p chunk.drift a bound on the
+     * rounding errors of the recurrence (u|x| for each rounded result
+     * x), and records in @p chunk.slack the smallest distance between
+     * the position and a weight it is compared to, minus the rounding
+     * errors that this run and a serial run may have accumulated
+     * since entering the chunk.
+     */
+    template<
+      class RandomAccessIterator,
+      typename WeightType,
+      class WeightAccessor,
+      class Visitor
+    >
+    void systematic_walk(RandomAccessIterator first,
+                         systematic_chunk<WeightType>& chunk,
+                         WeightType step,
+                         WeightAccessor const& wac,
+                         Visitor& visit)
+    {
+      const WeightType u = std::numeric_limits<WeightType>::epsilon() / 2;
+      WeightType position = chunk.position;
+      WeightType drift = 0;
+      WeightType slack = std::min(position, step - position);
+      for (size_t index = chunk.begin; index < chunk.end; ++index)
+      {
+        const WeightType w = wac(first[index]);
+        size_t count = 0;
+        while (position < w)
+        {
+          slack = std::min(slack, (w - position) - 2 * drift);
+          count++;
+          position += step;
+          drift += u * position;
+        }
+        position -= w;
+        drift += u * position;
+        // Zero weights are never picked, whatever the position.
+        if (w > 0)
+          slack = std::min(slack, position - 2 * drift);
+        visit(index, count);
+      }
+      chunk.slack = slack;
+      chunk.drift = drift;
+    }
+
+    /**
+     * @brief Splits [@p first, @p first + @p n) into chunks, and
+     * computes the position at which the systematic recurrence enters
+     * each chunk.
+     *
+     * The entry position of chunk 0 is that of a serial run. The entry
+     * positions of other chunks are derived from a compensated prefix
+     * sum of the chunk weights, computed in double precision
+     * arithmetic (in the sense of twice the precision of WeightType).
+     *
+     * Returns false if chunking is not worthwhile.
+     */
+    template<
+      class RandomAccessIterator,
+      typename WeightType,
+      class WeightAccessor
+    >
+    bool plan_systematic_chunks(RandomAccessIterator first,
+                                size_t n,
+                                size_t sampleSize,
+                                WeightType populationWeight,
+                                WeightType uniform01,
+                                WeightAccessor const& wac,
+                                std::vector< systematic_chunk<WeightType> >& chunks)
+    {
+#ifdef _OPENMP
+      const size_t nThreads = omp_get_max_threads();
+#else
+      const size_t nThreads = 1;
+#endif
+      if (nThreads < 2 || sampleSize == 0)
+        return false;
+      // A few chunks per thread to even out the load.
+      const size_t nChunks = std::min(4 * nThreads, n / systematic_min_chunk_size);
+      if (nChunks < 2)
+        return false;
+
+      chunks.resize(nChunks);
+      for (size_t c = 0; c < nChunks; ++c)
+      {
+        chunks[c].begin = n * c / nChunks;
+        chunks[c].end = n * (c + 1) / nChunks;
+      }
+
+      const long signedChunks = long(nChunks);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+      for (long c = 0; c < signedChunks; ++c)
+      {
+        systematic_chunk<WeightType>& chunk = chunks[c];
+        chunk.sum = chunk.compensation = 0;
+        for (size_t index = chunk.begin; index < chunk.end; ++index)
+          compensated_add(chunk.sum, chunk.compensation, wac(first[index]));
+      }
+
+      const WeightType eps = std::numeric_limits<WeightType>::epsilon();
+      const WeightType step = populationWeight / sampleSize;
+      const WeightType start = uniform01 * step;
+
+      // Exclusive scan of the chunk weights. cumulative +
+      // compensation is the weight before chunk c, with an error
+      // below n eps^2 times the total weight.
+      WeightType cumulative = 0, compensation = 0;
+      for (size_t c = 0; c < nChunks; ++c)
+      {
+        const WeightType sum = chunks[c].sum;
+        const WeightType sumCompensation = chunks[c].compensation;
+        chunks[c].sum = cumulative;
+        chunks[c].compensation = compensation;
+        compensated_add(cumulative, compensation, sum);
+        compensated_add(cumulative, compensation, sumCompensation);
+      }
+      const WeightType scanError = 4 * n * eps * eps * (cumulative + compensation);
+
+      chunks[0].position = start;
+      chunks[0].positionError = 0;
+      for (size_t c = 1; c < nChunks; ++c)
+      {
+        // Arrow k is at start + k * step. The first arrow after the
+        // weight C before chunk c is the k-th, k = ceil((C - start) /
+        // step), and the position is start + k * step - C.
+        const WeightType before = chunks[c].sum;
+        const WeightType k =
+          std::max(WeightType(0), std::ceil((before - start) / step));
+        WeightType kStep, kStepError;
+        exact_product(k, step, kStep, kStepError);
+        // kStep and before are close, their difference is exact.
+        WeightType position = (kStep - before) +
+          (start + (kStepError - chunks[c].compensation));
+        // ceil() may be off by one.
+        if (position < 0)
+          position += step;
+        else if (position >= step)
+          position -= step;
+        chunks[c].position = position;
+        chunks[c].positionError = 2 * eps * step + scanError;
+      }
+      return true;
+    }
+
+    /**
+     * @brief Returns whether the chunks walked by systematic_walk()
+     * made exactly the same picks as a serial run would.
+     *
+     * When entering chunk c, a serial run is at most the sum of the
+     * drifts of the previous chunks away from the exact position, and
+     * the planned entry position is at most its positionError away
+     * from it. If the slack of the chunk exceeds both, no comparison
+     * of the serial run can have gone the other way. (The drifts are
+     * computed from this run's positions rather than from those of the
+     * serial run; the 1% margin covers the difference.)
+     */
+    template<typename WeightType>
+    bool check_systematic_chunks(std::vector< systematic_chunk<WeightType> > const& chunks)
+    {
+      WeightType serialDrift = chunks[0].drift;
+      for (size_t c = 1; c < chunks.size(); ++c)
+      {
+        if (! (chunks[c].slack > WeightType(1.01) *
+               (serialDrift + chunks[c].positionError)) )
+          return false;
+        serialDrift += chunks[c].drift;
+      }
+      return true;
+    }
+
+  }
+
+  /**
+   * @brief Multithreaded version of trsl::systematic_sample.
+   *
+   * The population is split into chunks. A first parallel pass
+   * computes the weight of each chunk, from which the position of the
+   * first arrow of each chunk follows (exclusive prefix sum). A
+   * second parallel pass counts the picks of each chunk, and a third
+   * one writes the indices of each chunk at their final offset.
+   *
+   * The picks are exactly those of trsl::systematic_sample for the
+   * same @p uniform01; in particular, at most @p sampleSize indices
+   * are written. Since floating-point addition is not
+   * associative, the chunk entry positions are not bitwise equal to
+   * those that a serial run reaches. The second pass thus also
+   * checks that no comparison between a position and a weight is
+   * closer to flipping than a bound on the rounding errors that
+   * separate the chunked run from a serial run. If one is, the sample
+   * is computed serially. This is rare (a few percent of the samples
+   * for ten million elements and ten million picks), and becomes
+   * rarer as populations and samples get smaller.
+   *
+   * Parallelism is provided by OpenMP. Without OpenMP, or with a
+   * single thread, or for small populations, this function calls
+   * trsl::systematic_sample. It also calls trsl::systematic_sample
+   * when TRSL_USE_SYSTEMATIC_INTUITIVE_ALGORITHM is defined.
+   *
+   * The weight accessor is called concurrently from several threads.
+   *
+   * @param first, last Population range. @p RandomAccessIterator
+   * should model <em>Random Access Iterator</em>.
+   *
+   * @param out Random access iterator to which indices are written, as
+   * <tt>size_t</tt>. It should have room for @p sampleSize
+   * indices.
+   *
+   * See systematic_sample() for the other parameters.
+   *
+   * @return The output iterator, past the last written index.
+   */
+  template<
+    class RandomAccessIterator,
+    typename WeightType,
+    class WeightAccessor,
+    class RandomAccessOutputIterator
+  >
+  RandomAccessOutputIterator
+  parallel_systematic_sample(RandomAccessIterator first,
+                             RandomAccessIterator last,
+                             size_t sampleSize,
+                             WeightType populationWeight,
+                             WeightType uniform01,
+                             WeightAccessor wac,
+                             RandomAccessOutputIterator out)
+  {
+    BOOST_STATIC_ASSERT((std::numeric_limits<WeightType>::is_integer == false));
+#ifndef TRSL_USE_SYSTEMATIC_INTUITIVE_ALGORITHM
+    typedef detail::systematic_chunk<WeightType> chunk_type;
+    std::vector<chunk_type> chunks;
+    if (detail::plan_systematic_chunks(first, last - first,
+                                       sampleSize, populationWeight,
+                                       uniform01, wac, chunks))
+    {
+      const WeightType step = populationWeight / sampleSize;
+      const long nChunks = long(chunks.size());
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+      for (long c = 0; c < nChunks; ++c)
+      {
+        detail::systematic_pick_counter counter;
+        detail::systematic_walk(first, chunks[c], step, wac, counter);
+        chunks[c].picks = counter.picks;
+      }
+
+      std::vector<size_t> offsets(chunks.size() + 1, 0);
+      for (size_t c = 0; c < chunks.size(); ++c)
+        offsets[c+1] = offsets[c] + chunks[c].picks;
+
+      // A walk that picks too many elements is left to
+      // systematic_sample, which drops the extra picks.
+      if (offsets.back() <= sampleSize &&
+          detail::check_systematic_chunks(chunks))
+      {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (long c = 0; c < nChunks; ++c)
+        {
+          detail::systematic_index_writer<RandomAccessOutputIterator>
+            writer(out + offsets[c]);
+          detail::systematic_walk(first, chunks[c], step, wac, writer);
+        }
+        return out + offsets.back();
+      }
+    }
+#endif
+    return systematic_sample(first, last,
+                             sampleSize, populationWeight,
+                             uniform01, wac, out);
+  }
+
+  /**
+   * @brief Multithreaded version of trsl::systematic_sample, with
+   * system-provided random number.
+   *
+   * Identical to the function above, except that the random number
+   * is generated by trsl::rand_gen::uniform_01. See @ref random.
+   */
+  template<
+    class RandomAccessIterator,
+    typename WeightType,
+    class WeightAccessor,
+    class RandomAccessOutputIterator
+  >
+  RandomAccessOutputIterator
+  parallel_systematic_sample(RandomAccessIterator first,
+                             RandomAccessIterator last,
+                             size_t sampleSize,
+                             WeightType populationWeight,
+                             WeightAccessor wac,
+                             RandomAccessOutputIterator out)
+  {
+    return parallel_systematic_sample(first, last,
+                                      sampleSize, populationWeight,
+                                      rand_gen::uniform_01<WeightType>(),
+                                      wac, out);
+  }
+
+  /**
+   * @brief Multithreaded version of trsl::systematic_offspring.
+   *
+   * Same method and guarantees as trsl::parallel_systematic_sample,
+   * with two parallel passes instead of three: pick counts are
+   * written by the pass that checks them.
+   *
+   * @param out Random access iterator to which counts are written, as
+   * <tt>size_t</tt>. It should have room for <tt>last - first</tt>
+   * counts.
+   *
+   * See systematic_sample() for the other parameters.
+   *
+   * @return The output iterator, past the last written count.
+   */
+  template<
+    class RandomAccessIterator,
+    typename WeightType,
+    class WeightAccessor,
+    class RandomAccessOutputIterator
+  >
+  RandomAccessOutputIterator
+  parallel_systematic_offspring(RandomAccessIterator first,
+                                RandomAccessIterator last,
+                                size_t sampleSize,
+                                WeightType populationWeight,
+                                WeightType uniform01,
+                                WeightAccessor wac,
+                                RandomAccessOutputIterator out)
+  {
+    BOOST_STATIC_ASSERT((std::numeric_limits<WeightType>::is_integer == false));
+#ifndef TRSL_USE_SYSTEMATIC_INTUITIVE_ALGORITHM
+    typedef detail::systematic_chunk<WeightType> chunk_type;
+    std::vector<chunk_type> chunks;
+    if (detail::plan_systematic_chunks(first, last - first,
+                                       sampleSize, populationWeight,
+                                       uniform01, wac, chunks))
+    {
+      const WeightType step = populationWeight / sampleSize;
+      const long nChunks = long(chunks.size());
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+      for (long c = 0; c < nChunks; ++c)
+      {
+        detail::systematic_count_writer<RandomAccessOutputIterator> writer(out);
+        detail::systematic_walk(first, chunks[c], step, wac, writer);
+        chunks[c].picks = writer.picks;
+      }
+
+      size_t picks = 0;
+      for (size_t c = 0; c < chunks.size(); ++c)
+        picks += chunks[c].picks;
+
+      // As in parallel_systematic_sample, a walk that picks too many
+      // elements is left to systematic_offspring, which caps the
+      // counts.
+      if (picks <= sampleSize &&
+          detail::check_systematic_chunks(chunks))
+        return out + (last - first);
+    }
+#endif
+    return systematic_offspring(first, last,
+                                sampleSize, populationWeight,
+                                uniform01, wac, out);
+  }
+
+  /**
+   * @brief Multithreaded version of trsl::systematic_offspring, with
+   * system-provided random number.
+   *
+   * Identical to the function above, except that the random number
+   * is generated by trsl::rand_gen::uniform_01. See @ref random.
+   */
+  template<
+    class RandomAccessIterator,
+    typename WeightType,
+    class WeightAccessor,
+    class RandomAccessOutputIterator
+  >
+  RandomAccessOutputIterator
+  parallel_systematic_offspring(RandomAccessIterator first,
+                                RandomAccessIterator last,
+                                size_t sampleSize,
+                                WeightType populationWeight,
+                                WeightAccessor wac,
+                                RandomAccessOutputIterator out)
+  {
+    return parallel_systematic_offspring(first, last,
+                                         sampleSize, populationWeight,
+                                         rand_gen::uniform_01<WeightType>(),
+                                         wac, out);
+  }
+
+}
+
+#endif // include guard
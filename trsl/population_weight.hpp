@@ -0,0 +1,334 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+/** @file */
+
+#ifndef TRSL_POPULATION_WEIGHT_HPP
+#define TRSL_POPULATION_WEIGHT_HPP
+
+#include <trsl/common.hpp>
+#include <trsl/is_picked_systematic.hpp>
+
+#include <cstddef>
+#include <vector>
+#include <iterator>
+#include <boost/detail/iterator.hpp>
+#include <boost/mpl/identity.hpp> // non-deduced uniform01
+#include <boost/utility/enable_if.hpp>
+#include <boost/type_traits/is_arithmetic.hpp>
+#include <boost/static_assert.hpp>
+
+namespace trsl {
+
+  namespace detail {
+
+    // Number of independent accumulators. Consecutive weights go to
+    // different accumulators, which breaks the dependency chain of a
+    // single sum and lets the compiler vectorize the additions
+    // without reordering them.
+    static const size_t population_weight_lanes = 4;
+
+    // Number of weights added to the accumulators before the
+    // accumulators are added to the compensated sum.
+    static const size_t population_weight_block_size = 64;
+
+    // Number of elements summed by each task of the parallel
+    // reduction. The size is fixed, so that the result does not
+    // depend on the number of threads.
+    static const size_t population_weight_chunk_size = 16384;
+
+    /**
+     * Sums weights by blocks. Within a block, weights are added to
+     * plain accumulators, in a loop the compiler can vectorize. The
+     * sums of the accumulators are then added with compensated_add(),
+     * whose branch would prevent vectorization if it were called for
+     * each weight.
+     */
+    template<typename WeightType>
+    class blocked_sum
+    {
+    public:
+      blocked_sum() : n_(0), sum_(0), compensation_(0) {}
+
+      void add(WeightType w)
+        {
+          block_[n_++] = w;
+          if (n_ == population_weight_block_size)
+            flush();
+        }
+
+      WeightType total()
+        {
+          flush();
+          return sum_ + compensation_;
+        }
+
+    private:
+      void flush()
+        {
+          const size_t L = population_weight_lanes;
+          // Zero weights add nothing to the sums.
+          for (; n_ % L != 0; ++n_)
+            block_[n_] = 0;
+          WeightType lanes[L];
+          for (size_t l = 0; l < L; ++l)
+            lanes[l] = 0;
+          for (size_t i = 0; i < n_; i += L)
+            for (size_t l = 0; l < L; ++l)
+              lanes[l] += block_[i + l];
+          for (size_t l = 0; l < L; ++l)
+            compensated_add(sum_, compensation_, lanes[l]);
+          n_ = 0;
+        }
+
+      BOOST_STATIC_ASSERT((population_weight_block_size %
+                           population_weight_lanes == 0));
+
+      WeightType block_[population_weight_block_size];
+      size_t n_;
+      WeightType sum_;
+      WeightType compensation_;
+    };
+
+    /**
+     * Sums the weights of [first, first + n), last element first.
+     */
+    template<typename WeightType, class RandomAccessIterator, class WeightAccessor>
+    WeightType population_weight_backward(RandomAccessIterator first,
+                                          size_t n,
+                                          WeightAccessor const& wac)
+    {
+      blocked_sum<WeightType> sum;
+      for (size_t i = n; i > 0; --i)
+        sum.add(WeightType(wac(first[i - 1])));
+      return sum.total();
+    }
+
+    template<typename WeightType, class InputIterator, class WeightAccessor>
+    WeightType population_weight(InputIterator first,
+                                 InputIterator last,
+                                 WeightAccessor const& wac,
+                                 std::input_iterator_tag)
+    {
+      blocked_sum<WeightType> sum;
+      for (; first != last; ++first)
+        sum.add(WeightType(wac(*first)));
+      return sum.total();
+    }
+
+    template<typename WeightType, class BidirectionalIterator, class WeightAccessor>
+    WeightType population_weight(BidirectionalIterator first,
+                                 BidirectionalIterator last,
+                                 WeightAccessor const& wac,
+                                 std::bidirectional_iterator_tag)
+    {
+      blocked_sum<WeightType> sum;
+      while (last != first)
+      {
+        --last;
+        sum.add(WeightType(wac(*last)));
+      }
+      return sum.total();
+    }
+
+    template<typename WeightType, class RandomAccessIterator, class WeightAccessor>
+    WeightType population_weight(RandomAccessIterator first,
+                                 RandomAccessIterator last,
+                                 WeightAccessor const& wac,
+                                 std::random_access_iterator_tag)
+    {
+      const size_t n = last - first;
+      const size_t chunkSize = population_weight_chunk_size;
+      const long nChunks = long((n + chunkSize - 1) / chunkSize);
+      if (nChunks < 2)
+        return population_weight_backward<WeightType>(first, n, wac);
+
+      std::vector<WeightType> sums(nChunks);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+      for (long c = 0; c < nChunks; ++c)
+      {
+        const size_t begin = size_t(c) * chunkSize;
+        const size_t size = std::min(chunkSize, n - begin);
+        sums[c] = population_weight_backward<WeightType>(first + begin,
+                                                         size, wac);
+      }
+      WeightType s = 0, comp = 0;
+      for (long c = nChunks - 1; c >= 0; --c)
+        compensated_add(s, comp, sums[c]);
+      return s + comp;
+    }
+
+  }
+
+  /**
+   * @brief Returns the total weight of [@p first, @p last).
+   *
+   * The weights are summed by blocks. Within a block, they are
+   * spread over several independent accumulators, which the
+   * compiler can vectorize. The sums of the accumulators are added
+   * with a compensated (Neumaier) summation. This is both more
+   * accurate and faster than <tt>std::accumulate</tt>. The result
+   * does not depend on the number of threads.
+   *
+   * - For <em>Random Access Iterators</em>, the range is split into
+   * chunks of fixed size, summed in parallel by OpenMP threads when
+   * OpenMP is available.
+   * - For <em>Bidirectional Iterators</em>, the range is read from the
+   * end to the beginning, so that the first elements of the range
+   * are the most likely to still be in cache when the sampling pass
+   * starts. Random access ranges are also read backwards within each
+   * chunk.
+   * - <em>Input Iterators</em> are read once, from the beginning.
+   *
+   * The weight accessor is called once per element, concurrently
+   * from several threads for random access ranges.
+   *
+   * @param wac Weight accessor, see @ref accessor. Note that a bare
+   * method pointer is not an accessor; wrap it in a
+   * trsl::mp_weight_accessor.
+   */
+  template<typename WeightType, class ElementIterator, class WeightAccessor>
+  WeightType population_weight(ElementIterator first,
+                               ElementIterator last,
+                               WeightAccessor const& wac)
+  {
+    return detail::population_weight<WeightType>(
+      first, last, wac,
+      typename std::iterator_traits<ElementIterator>::iterator_category());
+  }
+
+  namespace detail {
+
+    // Predicate type returned by make_is_picked_systematic. Evaluated
+    // lazily, so that an explicit arithmetic template argument
+    // (e.g. make_is_picked_systematic<float>) never instantiates
+    // iterator_traits of a non-iterator, which is a hard error with
+    // C++98 standard libraries.
+    template<class ElementIterator, typename WeightType, class WeightAccessor>
+    struct systematic_predicate_of
+    {
+      typedef is_picked_systematic<
+        typename boost::detail::iterator_traits<ElementIterator>::value_type,
+        WeightType, WeightAccessor> type;
+    };
+
+  }
+
+  /**
+   * @brief Returns a systematic sampling predicate of weight type @p
+   * WeightType for [@p first, @p last), computing the population
+   * weight with population_weight().
+   *
+   * @p WeightType is given explicitly, e.g.
+   * <tt>make_is_picked_systematic<float>(first, last, sampleSize,
+   * wac)</tt>. The population weight is computed in @p WeightType
+   * precision.
+   *
+   * @param first, last Population range.
+   *
+   * @param sampleSize Number of elements in the sample, within
+   * <tt>[0, infinity[</tt>.
+   *
+   * @param wac Weight accessor, see @ref accessor.
+   */
+  template<typename WeightType, class ElementIterator, class WeightAccessor>
+  is_picked_systematic<
+    typename boost::detail::iterator_traits<ElementIterator>::value_type,
+    WeightType, WeightAccessor>
+  make_is_picked_systematic(ElementIterator first,
+                            ElementIterator last,
+                            size_t sampleSize,
+                            WeightAccessor const& wac)
+  {
+    typedef is_picked_systematic<
+      typename boost::detail::iterator_traits<ElementIterator>::value_type,
+      WeightType, WeightAccessor> is_picked;
+    return is_picked(sampleSize,
+                     population_weight<WeightType>(first, last, wac),
+                     wac);
+  }
+
+  /**
+   * @brief Returns a systematic sampling predicate of weight type @p
+   * WeightType for [@p first, @p last), computing the population
+   * weight with population_weight(), with user-provided random
+   * number.
+   *
+   * @param uniform01 Random number in <tt>[0,1[</tt>, see
+   * is_picked_systematic.
+   */
+  template<typename WeightType, class ElementIterator, class WeightAccessor>
+  is_picked_systematic<
+    typename boost::detail::iterator_traits<ElementIterator>::value_type,
+    WeightType, WeightAccessor>
+  make_is_picked_systematic(ElementIterator first,
+                            ElementIterator last,
+                            size_t sampleSize,
+                            typename boost::mpl::identity<WeightType>::type uniform01,
+                            WeightAccessor const& wac)
+  {
+    typedef is_picked_systematic<
+      typename boost::detail::iterator_traits<ElementIterator>::value_type,
+      WeightType, WeightAccessor> is_picked;
+    return is_picked(sampleSize,
+                     population_weight<WeightType>(first, last, wac),
+                     uniform01, wac);
+  }
+
+  /**
+   * @brief Returns a systematic sampling predicate for [@p first, @p
+   * last), computing the population weight with population_weight().
+   *
+   * The predicate and the population weight use <tt>double</tt>
+   * precision. See above for other weight types.
+   *
+   * @param first, last Population range.
+   *
+   * @param sampleSize Number of elements in the sample, within
+   * <tt>[0, infinity[</tt>.
+   *
+   * @param wac Weight accessor, see @ref accessor.
+   */
+  template<class ElementIterator, class WeightAccessor>
+  typename boost::lazy_disable_if<
+    boost::is_arithmetic<ElementIterator>,
+    detail::systematic_predicate_of<ElementIterator, double, WeightAccessor>
+  >::type
+  make_is_picked_systematic(ElementIterator first,
+                            ElementIterator last,
+                            size_t sampleSize,
+                            WeightAccessor const& wac)
+  {
+    return make_is_picked_systematic<double>(first, last, sampleSize, wac);
+  }
+
+  /**
+   * @brief Returns a systematic sampling predicate for [@p first, @p
+   * last), computing the population weight with population_weight(),
+   * with user-provided random number.
+   *
+   * @param uniform01 Random number in <tt>[0,1[</tt>, see
+   * is_picked_systematic.
+   */
+  template<class ElementIterator, class WeightAccessor>
+  typename boost::lazy_disable_if<
+    boost::is_arithmetic<ElementIterator>,
+    detail::systematic_predicate_of<ElementIterator, double, WeightAccessor>
+  >::type
+  make_is_picked_systematic(ElementIterator first,
+                            ElementIterator last,
+                            size_t sampleSize,
+                            double uniform01,
+                            WeightAccessor const& wac)
+  {
+    return make_is_picked_systematic<double>(first, last, sampleSize,
+                                             uniform01, wac);
+  }
+
+}
+
+#endif // include guard
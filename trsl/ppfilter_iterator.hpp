@@ -17,24 +17,54 @@
 
 namespace trsl
 {
-  template<class Predicate, class ElementIterator>
+  template<
+    class Predicate,
+    class ElementIterator,
+    class UpstreamIterator = reorder_iterator<ElementIterator>
+  >
   class ppfilter_iterator;
   
   namespace detail
   {
+    /**
+     * @brief Used internally. Constructs the random permutation
+     * iterator upstream of a ppfilter_iterator. Specialized for other
+     * permutation iterators, e.g. feistel_reorder_iterator.
+     */
+    template<class UpstreamIterator>
+    struct ppfilter_upstream
+    {
+      typedef UpstreamIterator type;
+      typedef typename UpstreamIterator::element_iterator element_iterator;
+
+      static type make(element_iterator first, element_iterator last)
+        {
+          return trsl::random_permutation_iterator<
+            typename UpstreamIterator::index_t>(first, last);
+        }
+
+      template<class UniformRandomNumberGenerator>
+      static type make(element_iterator first, element_iterator last,
+                       UniformRandomNumberGenerator& g)
+        {
+          return trsl::random_permutation_iterator<
+            typename UpstreamIterator::index_t>(first, last, g);
+        }
+    };
+
     /** @brief Used internally. */
-    template<class Predicate, class ElementIterator>
+    template<class Predicate, class ElementIterator, class UpstreamIterator>
     struct ppfilter_iterator_base
     {
       typedef Predicate predicate_t;
       typedef ElementIterator element_iterator;
     
-      typedef reorder_iterator<ElementIterator> upstream_iterator;
+      typedef UpstreamIterator upstream_iterator;
       typedef persistent_filter_iterator<
         Predicate, upstream_iterator> downstream_iterator;
     
       typedef boost::iterator_adaptor< 
-        ppfilter_iterator<Predicate, ElementIterator>,
+        ppfilter_iterator<Predicate, ElementIterator, UpstreamIterator>,
         downstream_iterator,
         typename boost::detail::iterator_traits<ElementIterator>::value_type,
         boost::forward_traversal_tag,
@@ -53,12 +83,19 @@ namespace trsl
    * permutation achieves <em>probability sampling</em>.
    *
    * @p ElementIterator should model <em>Random Access Iterator</em>.
+   *
+   * @param UpstreamIterator Type of the random permutation
+   * iterator. Defaults to reorder_iterator, constructed with
+   * random_permutation_iterator(). See feistel_ppfilter_iterator for
+   * a permutation that does not allocate an index array.
    */
-  template<class Predicate, class ElementIterator>
+  template<class Predicate, class ElementIterator, class UpstreamIterator>
   class ppfilter_iterator
-    : public detail::ppfilter_iterator_base<Predicate, ElementIterator>::type
+    : public detail::ppfilter_iterator_base<
+        Predicate, ElementIterator, UpstreamIterator>::type
   {
-    typedef detail::ppfilter_iterator_base<Predicate, ElementIterator> base_t;
+    typedef detail::ppfilter_iterator_base<
+      Predicate, ElementIterator, UpstreamIterator> base_t;
     typedef typename base_t::type super_t;
 
     friend class boost::iterator_core_access;
@@ -81,7 +118,26 @@ namespace trsl
                                ElementIterator first, ElementIterator last)
       : super_t(), predicate_(f)
       {
-        upstream_iterator ui = random_permutation_iterator(first, last);
+        upstream_iterator ui =
+          detail::ppfilter_upstream<upstream_iterator>::make(first, last);
+        this->base_reference() = downstream_iterator(f, ui.begin(), ui.end());
+      }
+
+    /**
+     * @brief Constructor, the random permutation of which is drawn
+     * from @p g.
+     *
+     * @p g should model <em>Uniform Random Number Generator</em>. See
+     * @ref random.
+     */
+    template<class UniformRandomNumberGenerator>
+    ppfilter_iterator(Predicate f,
+                      ElementIterator first, ElementIterator last,
+                      UniformRandomNumberGenerator& g)
+      : super_t(), predicate_(f)
+      {
+        upstream_iterator ui =
+          detail::ppfilter_upstream<upstream_iterator>::make(first, last, g);
         this->base_reference() = downstream_iterator(f, ui.begin(), ui.end());
       }
     
@@ -94,10 +150,10 @@ namespace trsl
      * ElementIterator is const, e.g.
      * <tt>std::vector<Particle>::const_iterator</tt>.
      */
-    template<class OtherElementIterator>
+    template<class OtherElementIterator, class OtherUpstreamIterator>
     ppfilter_iterator
-    (ppfilter_iterator<Predicate, OtherElementIterator> const& r,
-     typename boost::enable_if_convertible<OtherElementIterator, ElementIterator>::type* = 0) :
+    (ppfilter_iterator<Predicate, OtherElementIterator, OtherUpstreamIterator> const& r,
+     typename boost::enable_if_convertible<OtherUpstreamIterator, UpstreamIterator>::type* = 0) :
       super_t(r.base()), predicate_(r.predicate_)
       {}
 
@@ -105,9 +161,9 @@ namespace trsl
      * @brief Returns a ppfilter_iterator pointing to the begining of
      * the range.
      */
-    ppfilter_iterator<Predicate, ElementIterator> begin() const
+    ppfilter_iterator begin() const
       {
-        ppfilter_iterator<Predicate, ElementIterator> i(*this);
+        ppfilter_iterator i(*this);
         i.base_reference() =
           downstream_iterator(predicate_,
                               this->base_reference().base().begin(),
@@ -119,9 +175,9 @@ namespace trsl
      * @brief Returns a ppfilter_iterator pointing to
      * the end of the range.
      */
-    ppfilter_iterator<Predicate, ElementIterator> end() const
+    ppfilter_iterator end() const
       {
-        ppfilter_iterator<Predicate, ElementIterator> i(*this);
+        ppfilter_iterator i(*this);
         i.base_reference() = downstream_iterator(predicate_,
                                                  this->base_reference().base().end(),
                                                  this->base_reference().base().end());
@@ -143,7 +199,7 @@ namespace trsl
   private:
     
 #ifndef BOOST_NO_MEMBER_TEMPLATE_FRIENDS
-    template <class, class> friend class ppfilter_iterator;
+    template <class, class, class> friend class ppfilter_iterator;
 #else
   public:
 #endif
@@ -0,0 +1,137 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+/** @file */
+
+#ifndef TRSL_PREFETCH_FOR_EACH_HPP
+#define TRSL_PREFETCH_FOR_EACH_HPP
+
+#include <trsl/common.hpp>
+
+#include <cstddef>
+#include <iterator>
+#include <boost/detail/iterator.hpp>
+#include <boost/type_traits/is_reference.hpp>
+#include <boost/type_traits/is_const.hpp>
+#include <boost/type_traits/remove_reference.hpp>
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <xmmintrin.h>
+#endif
+
+namespace trsl {
+
+  namespace detail {
+
+    /**
+     * @brief Used internally. Hints the processor to load the cache
+     * line at @p p, for reading or, if @p ForWrite is true, for
+     * writing. Does nothing on compilers without a prefetch
+     * intrinsic.
+     */
+    template<bool ForWrite>
+    inline void prefetch(const void* p)
+    {
+#if defined(__GNUC__)
+      __builtin_prefetch(p, ForWrite ? 1 : 0, 3);
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+      _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#else
+      (void)p;
+#endif
+    }
+
+    /**
+     * @brief Used internally. Prefetches the element @p i points to,
+     * if the reference type of @p Iterator is a true reference.
+     */
+    template<class Iterator, bool IsReference>
+    struct element_prefetcher
+    {
+      static void prefetch(const Iterator&) {}
+    };
+
+    template<class Iterator>
+    struct element_prefetcher<Iterator, true>
+    {
+      typedef typename boost::detail::iterator_traits<Iterator>::reference
+        reference;
+      typedef typename boost::remove_reference<reference>::type value_type;
+
+      static void prefetch(const Iterator& i)
+        {
+          reference r = *i;
+          detail::prefetch<!boost::is_const<value_type>::value>(&r);
+        }
+    };
+
+  } // namespace detail
+
+  /**
+   * @brief Applies @p f to the elements of <tt>[first, last[</tt>, in
+   * order, prefetching the element @p distance positions ahead.
+   *
+   * A reorder_iterator reads its index array sequentially, but the
+   * elements it points to are scattered across the population. When
+   * the population does not fit in the processor caches, each element
+   * access is a cache miss, and a plain loop waits for the misses one
+   * at a time. prefetch_for_each() requests the element @p distance
+   * positions ahead of the one passed to @p f, so that up to @p
+   * distance misses are outstanding at once. Computing the address of
+   * an element ahead does not read it: for a reorder_iterator, it
+   * costs one read of the index array.
+   *
+   * The best distance depends on the memory latency and on the time
+   * @p f spends on an element; the default of 16 covers a few hundred
+   * nanoseconds of latency for light functions. A distance of 0
+   * disables prefetching. On a population that fits in the caches,
+   * prefetching only adds the cost of computing addresses twice.
+   *
+   * Elements are prefetched for writing if the reference type of @p
+   * RandomIterator is non-const, and for reading otherwise. If the
+   * reference type is not a true reference, e.g. a proxy, or if the
+   * compiler provides no prefetch intrinsic, no element is
+   * prefetched.
+   *
+   * @p RandomIterator should model <em>Random Access Iterator</em>,
+   * e.g. reorder_iterator. Iterators that compute each index, such as
+   * feistel_reorder_iterator, would compute every index twice.
+   *
+   * @return @p f, as <tt>std::for_each</tt>.
+   */
+  template<class RandomIterator, class UnaryFunction>
+  UnaryFunction prefetch_for_each(RandomIterator first,
+                                  RandomIterator last,
+                                  UnaryFunction f,
+                                  size_t distance = 16)
+  {
+    typedef detail::element_prefetcher<
+      RandomIterator,
+      boost::is_reference<
+        typename boost::detail::iterator_traits<RandomIterator>::reference
+      >::value
+    > prefetcher;
+
+    typename boost::detail::iterator_traits<RandomIterator>::difference_type
+      size = std::distance(first, last);
+    if (size_t(size) < distance)
+      distance = size;
+
+    RandomIterator ahead = first;
+    for (size_t i = 0; i < distance; ++i, ++ahead)
+      prefetcher::prefetch(ahead);
+    for (; ahead != last; ++first, ++ahead)
+    {
+      prefetcher::prefetch(ahead);
+      f(*first);
+    }
+    for (; first != last; ++first)
+      f(*first);
+    return f;
+  }
+
+} // namespace trsl
+
+#endif // include guard
@@ -9,12 +9,86 @@
 #define TRSL_RANDOM_PERMUTATION_ITERATOR_HPP
 
 #include <trsl/reorder_iterator.hpp>
+#include <trsl/index_workspace.hpp>
 #include <trsl/common.hpp>
 #include <trsl/error_handling.hpp>
 
+#include <algorithm>
+#include <boost/utility/enable_if.hpp>
+#include <boost/type_traits/is_arithmetic.hpp>
+
 namespace trsl
 {
 
+  namespace detail
+  {
+    /**
+     * @brief Used internally. @p rng is called as
+     * <tt>rng(n)</tt> and returns an integer in <tt>[0,n[</tt>. The
+     * permutation is written into @p index_collection.
+     */
+    template<class IndexType, class ElementIterator, class RandomNumberGenerator>
+    reorder_iterator<ElementIterator, IndexType>
+    random_permutation_iterator(ElementIterator first,
+                                ElementIterator last,
+                                size_t permutationSize,
+                                RandomNumberGenerator& rng,
+                                const typename reorder_iterator<
+                                  ElementIterator, IndexType
+                                >::index_container_ptr& index_collection)
+    {
+      ptrdiff_t size = std::distance(first, last);
+      if (size < 0)
+        throw bad_parameter_value(
+          "random_permutation_iterator: "
+          "bad input range.");
+      if (permutationSize > size_t(size))
+        throw bad_parameter_value(
+          "random_permutation_iterator: "
+          "parameter permutationSize out of range.");
+      check_index_range<IndexType>(size, "random_permutation_iterator");
+
+      typedef
+        typename reorder_iterator<ElementIterator, IndexType>::index_t
+        index_t;
+
+      index_collection->resize(size);
+      for (size_t i = 0; i < size_t(size); ++i)
+        (*index_collection)[i] = index_t(i);
+      // A full permutation is a partial shuffle that stops one
+      // element before the end.
+      detail::partial_random_shuffle(index_collection->begin(),
+                                     index_collection->begin() +
+                                     std::min(permutationSize, size_t(size-1)),
+                                     index_collection->end(),
+                                     rng);
+      index_collection->resize(permutationSize);
+
+      return reorder_iterator<ElementIterator, IndexType>(first,
+                                                          index_collection);
+    }
+
+    /** @brief Used internally. Allocates a new index array. */
+    template<class IndexType, class ElementIterator, class RandomNumberGenerator>
+    reorder_iterator<ElementIterator, IndexType>
+    random_permutation_iterator(ElementIterator first,
+                                ElementIterator last,
+                                size_t permutationSize,
+                                RandomNumberGenerator& rng)
+    {
+      typedef
+        typename reorder_iterator<ElementIterator, IndexType>::index_container
+        index_container;
+      typedef
+        typename reorder_iterator<ElementIterator, IndexType>::index_container_ptr
+        index_container_ptr;
+
+      return random_permutation_iterator<IndexType>(
+        first, last, permutationSize, rng,
+        index_container_ptr(new index_container));
+    }
+  }
+
   /**
    * @brief Constructs a reorder_iterator that will iterate through a
    * random subset of size @p permutationSize of a random permutation
@@ -26,7 +100,15 @@ namespace trsl
    *
    * Performing a random permutation requires a series of random
    * integers, these are provided by rand_gen::uniform_int; see @ref
-   * random for further details.
+   * random for further details. Integers are drawn without modulo
+   * bias, and populations larger than <tt>RAND_MAX</tt> are
+   * permuted uniformly.
+   *
+   * The permutation is stored as an array of <tt>size_t</tt>
+   * indices, shuffled at construction. feistel_permutation_iterator()
+   * computes indices instead of storing them, at a higher cost per
+   * element and with a pseudorandom permutation; its documentation
+   * compares the two.
    *
    * @p ElementIterator should model <em>Random Access Iterator</em>.
    *
@@ -39,47 +121,34 @@ namespace trsl
   reorder_iterator<ElementIterator>
   random_permutation_iterator(ElementIterator first,
                               ElementIterator last,
-                              unsigned permutationSize)
+                              size_t permutationSize)
   {
-    ptrdiff_t size = std::distance(first, last);
-    if (size < 0)
-      throw bad_parameter_value(
-        "random_permutation_iterator: "
-        "bad input range.");
-    if (permutationSize > unsigned(size))
-      throw bad_parameter_value(
-        "random_permutation_iterator: "
-        "parameter permutationSize out of range.");
-        
-    typedef
-      typename reorder_iterator<ElementIterator>::index_container
-      index_container;
-    typedef
-      typename reorder_iterator<ElementIterator>::index_container_ptr
-      index_container_ptr;
-    typedef
-      typename reorder_iterator<ElementIterator>::index_t
-      index_t;
-  
-    index_container_ptr index_collection(new index_container);
-        
-    index_collection->resize(size);
-    for (index_t i = 0; i < index_t(size); ++i)
-      (*index_collection)[i] = i;
-    if (permutationSize == unsigned(size))
-      std::random_shuffle(index_collection->begin(),
-                          index_collection->end(),
-                          rand_gen::uniform_int);
-    else
-    {
-      detail::partial_random_shuffle(index_collection->begin(),
-                                     index_collection->begin()+permutationSize,
-                                     index_collection->end(),
-                                     rand_gen::uniform_int);
-      index_collection->resize(permutationSize);
-    }
-    
-    return reorder_iterator<ElementIterator>(first, index_collection);
+    detail::system_uniform_int_generator rng;
+    return detail::random_permutation_iterator<size_t>(first, last,
+                                                       permutationSize, rng);
+  }
+
+  /**
+   * @brief Constructs a reorder_iterator that will iterate through a
+   * random subset of size @p permutationSize of a random permutation
+   * of the population referenced by @p first and @p last, drawing
+   * random numbers from @p g.
+   *
+   * Identical to the function above, except that random numbers are
+   * drawn from @p g, which should model <em>Uniform Random Number
+   * Generator</em>, e.g. trsl::xoshiro256 or
+   * <tt>boost::mt19937</tt>. See @ref random.
+   */
+  template<class ElementIterator, class UniformRandomNumberGenerator>
+  reorder_iterator<ElementIterator>
+  random_permutation_iterator(ElementIterator first,
+                              ElementIterator last,
+                              size_t permutationSize,
+                              UniformRandomNumberGenerator& g)
+  {
+    rand_gen::uniform_int_adaptor<UniformRandomNumberGenerator> rng(g);
+    return detail::random_permutation_iterator<size_t>(first, last,
+                                                       permutationSize, rng);
   }
 
   /**
@@ -108,6 +177,187 @@ namespace trsl
                                        std::distance(first, last));
   }
 
+  /**
+   * @brief Constructs a reorder_iterator that will iterate through a
+   * random permutation of the population referenced by @p first and
+   * @p last, drawing random numbers from @p g.
+   *
+   * See above.
+   */
+  template<class ElementIterator, class UniformRandomNumberGenerator>
+  typename boost::disable_if<
+    boost::is_arithmetic<UniformRandomNumberGenerator>,
+    reorder_iterator<ElementIterator>
+  >::type
+  random_permutation_iterator(ElementIterator first,
+                              ElementIterator last,
+                              UniformRandomNumberGenerator& g)
+  {
+    return random_permutation_iterator(first,
+                                       last,
+                                       std::distance(first, last),
+                                       g);
+  }
+
+  /**
+   * @brief Constructs a reorder_iterator with indices of type @p
+   * IndexType, e.g. <tt>boost::uint32_t</tt>, that will iterate
+   * through a random subset of size @p permutationSize of a random
+   * permutation of the population referenced by @p first and @p last.
+   *
+   * @p IndexType is given explicitly, e.g.
+   * <tt>random_permutation_iterator<boost::uint32_t>(first, last,
+   * permutationSize)</tt>. If the population does not fit in @p
+   * IndexType, a bad_parameter_value is thrown. See reorder_iterator
+   * and the function above.
+   */
+  template<class IndexType, class ElementIterator>
+  reorder_iterator<ElementIterator, IndexType>
+  random_permutation_iterator(ElementIterator first,
+                              ElementIterator last,
+                              size_t permutationSize)
+  {
+    detail::system_uniform_int_generator rng;
+    return detail::random_permutation_iterator<IndexType>(first, last,
+                                                          permutationSize, rng);
+  }
+
+  /**
+   * @brief Constructs a reorder_iterator with indices of type @p
+   * IndexType, drawing random numbers from @p g. See above.
+   */
+  template<class IndexType, class ElementIterator, class UniformRandomNumberGenerator>
+  reorder_iterator<ElementIterator, IndexType>
+  random_permutation_iterator(ElementIterator first,
+                              ElementIterator last,
+                              size_t permutationSize,
+                              UniformRandomNumberGenerator& g)
+  {
+    rand_gen::uniform_int_adaptor<UniformRandomNumberGenerator> rng(g);
+    return detail::random_permutation_iterator<IndexType>(first, last,
+                                                          permutationSize, rng);
+  }
+
+  /**
+   * @brief Constructs a reorder_iterator with indices of type @p
+   * IndexType, that will iterate through a random permutation of the
+   * population referenced by @p first and @p last. See above.
+   */
+  template<class IndexType, class ElementIterator>
+  reorder_iterator<ElementIterator, IndexType>
+  random_permutation_iterator(ElementIterator first,
+                              ElementIterator last)
+  {
+    return random_permutation_iterator<IndexType>(first,
+                                                  last,
+                                                  std::distance(first, last));
+  }
+
+  /**
+   * @brief Constructs a reorder_iterator with indices of type @p
+   * IndexType, that will iterate through a random permutation of the
+   * population referenced by @p first and @p last, drawing random
+   * numbers from @p g. See above.
+   */
+  template<class IndexType, class ElementIterator, class UniformRandomNumberGenerator>
+  typename boost::disable_if<
+    boost::is_arithmetic<UniformRandomNumberGenerator>,
+    reorder_iterator<ElementIterator, IndexType>
+  >::type
+  random_permutation_iterator(ElementIterator first,
+                              ElementIterator last,
+                              UniformRandomNumberGenerator& g)
+  {
+    return random_permutation_iterator<IndexType>(first,
+                                                  last,
+                                                  std::distance(first, last),
+                                                  g);
+  }
+
+  /**
+   * @brief Constructs a reorder_iterator that will iterate through a
+   * random subset of size @p permutationSize of a random permutation
+   * of the population referenced by @p first and @p last, storing the
+   * permutation in an index array of @p workspace.
+   *
+   * Identical to the functions above, except that the index array is
+   * taken from @p workspace, which allocates memory only if all its
+   * arrays are still in use. See index_workspace. The index type of
+   * the returned iterator is that of @p workspace.
+   */
+  template<class ElementIterator, class IndexType>
+  reorder_iterator<ElementIterator, IndexType>
+  random_permutation_iterator(ElementIterator first,
+                              ElementIterator last,
+                              size_t permutationSize,
+                              index_workspace<IndexType>& workspace)
+  {
+    detail::system_uniform_int_generator rng;
+    return detail::random_permutation_iterator<IndexType>(
+      first, last, permutationSize, rng, workspace.acquire());
+  }
+
+  /**
+   * @brief Constructs a reorder_iterator that will iterate through a
+   * random subset of size @p permutationSize of a random permutation
+   * of the population referenced by @p first and @p last, drawing
+   * random numbers from @p g and storing the permutation in an index
+   * array of @p workspace. See above.
+   */
+  template<class ElementIterator, class UniformRandomNumberGenerator, class IndexType>
+  reorder_iterator<ElementIterator, IndexType>
+  random_permutation_iterator(ElementIterator first,
+                              ElementIterator last,
+                              size_t permutationSize,
+                              UniformRandomNumberGenerator& g,
+                              index_workspace<IndexType>& workspace)
+  {
+    rand_gen::uniform_int_adaptor<UniformRandomNumberGenerator> rng(g);
+    return detail::random_permutation_iterator<IndexType>(
+      first, last, permutationSize, rng, workspace.acquire());
+  }
+
+  /**
+   * @brief Constructs a reorder_iterator that will iterate through a
+   * random permutation of the population referenced by @p first and
+   * @p last, storing the permutation in an index array of @p
+   * workspace. See above.
+   */
+  template<class ElementIterator, class IndexType>
+  reorder_iterator<ElementIterator, IndexType>
+  random_permutation_iterator(ElementIterator first,
+                              ElementIterator last,
+                              index_workspace<IndexType>& workspace)
+  {
+    return random_permutation_iterator(first,
+                                       last,
+                                       std::distance(first, last),
+                                       workspace);
+  }
+
+  /**
+   * @brief Constructs a reorder_iterator that will iterate through a
+   * random permutation of the population referenced by @p first and
+   * @p last, drawing random numbers from @p g and storing the
+   * permutation in an index array of @p workspace. See above.
+   */
+  template<class ElementIterator, class UniformRandomNumberGenerator, class IndexType>
+  typename boost::disable_if<
+    boost::is_arithmetic<UniformRandomNumberGenerator>,
+    reorder_iterator<ElementIterator, IndexType>
+  >::type
+  random_permutation_iterator(ElementIterator first,
+                              ElementIterator last,
+                              UniformRandomNumberGenerator& g,
+                              index_workspace<IndexType>& workspace)
+  {
+    return random_permutation_iterator(first,
+                                       last,
+                                       std::distance(first, last),
+                                       g,
+                                       workspace);
+  }
+
 } // namespace trsl
 
 #endif // include guard
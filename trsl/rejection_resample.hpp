@@ -0,0 +1,160 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+/** @file */
+
+#ifndef TRSL_REJECTION_RESAMPLE_HPP
+#define TRSL_REJECTION_RESAMPLE_HPP
+
+#include <trsl/common.hpp>
+#include <trsl/error_handling.hpp>
+#include <trsl/weight_accessor.hpp>
+
+#include <cstddef>
+#include <limits>
+#include <boost/static_assert.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/random/linear_congruential.hpp>
+
+namespace trsl {
+
+  /**
+   * @brief Writes the indices of a sample of [@p first, @p last)
+   * drawn by rejection resampling to @p out.
+   *
+   * Rejection resampling [1] computes each element of the sample by
+   * rejection sampling against an upper bound @p maxWeight of the
+   * weights. Each slot draws an element uniformly from the
+   * population, and accepts it with probability <tt>w /
+   * maxWeight</tt>, where <tt>w</tt> is its weight; if it is
+   * rejected, the slot draws another element, until one is accepted.
+   *
+   * Each element of the sample is distributed according to the
+   * weights. As with trsl::metropolis_resample, there is no need for
+   * the total weight of the population nor for a cumulative sum of
+   * the weights, and slots are computed in parallel by OpenMP threads
+   * when OpenMP is available. The sample depends on @p seed, but not
+   * on the number of threads.
+   *
+   * The expected number of weight accesses per slot is
+   * <tt>maxWeight / E[w]</tt>: @p maxWeight should be as tight as
+   * possible. If a weight exceeds @p maxWeight, the sample is biased
+   * (heavy elements are picked less often than they should). At least
+   * one weight must be positive.
+   *
+   * The weight accessor is called concurrently from several threads.
+   *
+   * @param first, last Population range. @p RandomAccessIterator
+   * should model <em>Random Access Iterator</em>.
+   *
+   * @param sampleSize Number of elements in the sample, within
+   * <tt>[0, infinity[</tt>.
+   *
+   * @param maxWeight Upper bound on the weights, within <tt>]0,
+   * infinity[</tt>.
+   *
+   * @param seed Seed for the random generators.
+   *
+   * @param wac Weight accessor, see @ref accessor. Note that a bare
+   * method pointer is not an accessor; wrap it in a
+   * trsl::mp_weight_accessor.
+   *
+   * @param out Random access iterator to which indices are written,
+   * as <tt>size_t</tt>. It should have room for @p sampleSize
+   * indices.
+   *
+   * @return The output iterator, past the last written index.
+   *
+   * Throws a bad_parameter_value if the population is empty, if no
+   * weight is positive, or if @p maxWeight is not positive.
+   *
+   * <b>References:</b>
+   *
+   * - [1] L. M. Murray, A. Lee, and P. E. Jacob. Parallel resampling
+   * in the particle filter. Journal of Computational and Graphical
+   * Statistics, 25(3):789-805, 2016.
+   */
+  template<
+    class RandomAccessIterator,
+    typename WeightType,
+    class WeightAccessor,
+    class RandomAccessOutputIterator
+  >
+  RandomAccessOutputIterator
+  rejection_resample(RandomAccessIterator first,
+                     RandomAccessIterator last,
+                     size_t sampleSize,
+                     WeightType maxWeight,
+                     boost::uint32_t seed,
+                     WeightAccessor wac,
+                     RandomAccessOutputIterator out)
+  {
+    BOOST_STATIC_ASSERT((std::numeric_limits<WeightType>::is_integer == false));
+    const size_t n = last - first;
+    if (n == 0)
+      throw bad_parameter_value(
+        "rejection_resample: empty population.");
+    if (! (maxWeight > 0) )
+      throw bad_parameter_value(
+        "rejection_resample: maxWeight should be positive.");
+    if (sampleSize > 0)
+    {
+      // No element would ever be accepted. The scan usually stops at
+      // the first element.
+      size_t k = 0;
+      while (k < n && ! (wac(first[k]) > 0))
+        ++k;
+      if (k == n)
+        throw bad_parameter_value(
+          "rejection_resample: all weights are zero.");
+    }
+
+    const long signedSize = long(sampleSize);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (long i = 0; i < signedSize; ++i)
+    {
+      boost::rand48 rng(detail::stream_seed(seed, boost::uint32_t(i)));
+      rand_gen::uniform_int_adaptor<boost::rand48> index(rng);
+      size_t k;
+      do
+        k = size_t(index(std::ptrdiff_t(n)));
+      while (rand_gen::uniform_01<WeightType>(rng) * maxWeight >= wac(first[k]));
+      out[i] = k;
+    }
+    return out + sampleSize;
+  }
+
+  /**
+   * @brief Writes the indices of a sample of [@p first, @p last)
+   * drawn by rejection resampling to @p out, with system-provided
+   * seed.
+   *
+   * Identical to the function above, except that the seed is
+   * generated by trsl::rand_gen::uniform_int. See @ref random.
+   */
+  template<
+    class RandomAccessIterator,
+    typename WeightType,
+    class WeightAccessor,
+    class RandomAccessOutputIterator
+  >
+  RandomAccessOutputIterator
+  rejection_resample(RandomAccessIterator first,
+                     RandomAccessIterator last,
+                     size_t sampleSize,
+                     WeightType maxWeight,
+                     WeightAccessor wac,
+                     RandomAccessOutputIterator out)
+  {
+    return rejection_resample(first, last, sampleSize, maxWeight,
+                              boost::uint32_t(rand_gen::uniform_int(RAND_MAX)),
+                              wac, out);
+  }
+
+}
+
+#endif // include guard
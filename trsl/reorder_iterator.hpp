@@ -19,6 +19,8 @@
 #include <iterator>
 #include <vector>
 #include <algorithm>
+#include <limits>
+#include <string>
 #include <boost/iterator.hpp>
 #include <boost/detail/iterator.hpp>
 #include <boost/iterator/iterator_categories.hpp>
@@ -27,23 +29,23 @@
 
 namespace trsl
 {
-  template<class ElementIterator>
+  template<class ElementIterator, class IndexType = size_t>
   class reorder_iterator;
   
   namespace detail
   {
     /** @brief Used internally. */
-    template<class ElementIterator>
+    template<class ElementIterator, class IndexType>
     struct reorder_iterator_base
     {
       typedef ElementIterator element_iterator;
-      typedef size_t index_t;
+      typedef IndexType index_t;
       typedef std::vector<index_t> index_container;
       typedef boost::shared_ptr<index_container> index_container_ptr;
       typedef typename index_container::const_iterator index_iterator;
     
       typedef boost::iterator_adaptor< 
-        reorder_iterator<ElementIterator>,
+        reorder_iterator<ElementIterator, IndexType>,
         index_iterator,
         typename boost::detail::iterator_traits<ElementIterator>::value_type,
         boost::use_default,
@@ -90,12 +92,23 @@ namespace trsl
    * See the doc on <a
    * href="http://www.boost.org/libs/iterator/doc/permutation_iterator.html"
    * >boost::permutation_iterator</a> for further details.
+   *
+   * @param IndexType Type of the stored indices, an unsigned integer
+   * type. Defaults to <tt>size_t</tt>. Iterating through a
+   * reorder_iterator reads the index array sequentially; with
+   * <tt>boost::uint32_t</tt> indices, populations of up to
+   * <tt>2^32</tt> elements need half the memory and bandwidth of
+   * 64-bit indices. The functions that generate reorder iterators
+   * accept the index type as an explicit template argument, e.g.
+   * <tt>random_permutation_iterator<boost::uint32_t>(first,
+   * last)</tt>, and throw a bad_parameter_value if the population
+   * does not fit in it.
    */
-  template<class ElementIterator>
+  template<class ElementIterator, class IndexType>
   class reorder_iterator
-    : public detail::reorder_iterator_base<ElementIterator>::type
+    : public detail::reorder_iterator_base<ElementIterator, IndexType>::type
   {
-    typedef detail::reorder_iterator_base<ElementIterator> base_t;
+    typedef detail::reorder_iterator_base<ElementIterator, IndexType> base_t;
     typedef typename base_t::type super_t;
 
     friend class boost::iterator_core_access;
@@ -139,7 +152,7 @@ namespace trsl
      */
     template<class OtherElementIterator>
     reorder_iterator
-    (reorder_iterator<OtherElementIterator> const& r,
+    (reorder_iterator<OtherElementIterator, IndexType> const& r,
      typename boost::enable_if_convertible<OtherElementIterator, ElementIterator>::type* = 0) :
       super_t(r.base()), m_elt_iter(r.m_elt_iter),
       m_index_collection(r.m_index_collection)
@@ -149,9 +162,9 @@ namespace trsl
      * @brief Returns a reorder_iterator pointing to
      * the begining of the permutation.
      */
-    reorder_iterator<ElementIterator> begin() const
+    reorder_iterator begin() const
       {
-        reorder_iterator<ElementIterator> indexIterator(*this);
+        reorder_iterator indexIterator(*this);
         indexIterator.base_reference() =
           indexIterator.m_index_collection->begin();
         return indexIterator;
@@ -161,9 +174,9 @@ namespace trsl
      * @brief Returns a reorder_iterator pointing to
      * the end of the permutation.
      */
-    reorder_iterator<ElementIterator> end() const
+    reorder_iterator end() const
       {
-        reorder_iterator<ElementIterator> indexIterator(*this);
+        reorder_iterator indexIterator(*this);
         indexIterator.base_reference() =
           indexIterator.m_index_collection->end();
         return indexIterator;
@@ -184,7 +197,7 @@ namespace trsl
       { return *(m_elt_iter + *this->base()); }
     
 #ifndef BOOST_NO_MEMBER_TEMPLATE_FRIENDS
-    template <class> friend class reorder_iterator;
+    template <class, class> friend class reorder_iterator;
 #else
   public:
 #endif 
@@ -192,6 +205,25 @@ namespace trsl
   protected:
     index_container_ptr m_index_collection;
   };
+
+  namespace detail
+  {
+    /**
+     * @brief Used internally. Throws a bad_parameter_value if the
+     * indices of a population of @p size elements do not fit in @p
+     * IndexType.
+     */
+    template<class IndexType>
+    void check_index_range(std::ptrdiff_t size, const char* caller)
+    {
+      if (size > 0 &&
+          boost::uint64_t(size - 1) >
+          boost::uint64_t(std::numeric_limits<IndexType>::max()))
+        throw bad_parameter_value(
+          std::string(caller) +
+          ": population too large for the index type.");
+    }
+  }
   
 } // namespace trsl
 
@@ -0,0 +1,115 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+/** @file */
+
+#ifndef TRSL_RESAMPLE_IN_PLACE_HPP
+#define TRSL_RESAMPLE_IN_PLACE_HPP
+
+#include <trsl/common.hpp>
+
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+
+namespace trsl {
+
+  /**
+   * @brief Replaces the elements of @p population by a sample of
+   * them, without copying the population.
+   *
+   * The usual way to resample a population is to copy the sample into
+   * a new container, and swap it with the population. This doubles
+   * the peak memory, and copies every element of the sample, even
+   * those picked once. resample_in_place() instead works within the
+   * population container:
+   *
+   * - It first counts the number of times each element is picked, by
+   *   calling @p predicate the way persistent_filter_iterator does:
+   *   repeatedly on an element until it returns false.
+   * - Elements picked at least once stay where they are, and are
+   *   never copied.
+   * - Each extra copy of an element picked more than once is
+   *   copy-assigned over an element that is not picked.
+   * - If the sample is smaller than the population, the remaining
+   *   unpicked slots are removed by swapping the picked elements
+   *   towards the front, and erasing the tail. If it is larger, the
+   *   remaining extra copies are appended with <tt>push_back</tt>.
+   *
+   * When the sample size equals the population size (the common case
+   * in particle filters), the container is neither resized nor
+   * reallocated, and exactly one copy-assignment is performed per
+   * extra copy. Swaps use <tt>std::swap</tt> or a <tt>swap</tt> found
+   * by argument-dependent lookup, which may be specialized for
+   * elements that are expensive to copy.
+   *
+   * The order of the elements is not preserved: copies of an element
+   * are not adjacent to it. Weights are left untouched; the caller
+   * typically resets them to a uniform value.
+   *
+   * @param population Container of elements. It should provide
+   * random access through <tt>operator[]</tt>, <tt>size()</tt>,
+   * <tt>push_back()</tt> and <tt>erase()</tt>, e.g.
+   * <tt>std::vector</tt> or <tt>std::deque</tt>.
+   *
+   * @param predicate A freshly constructed sampling predicate, e.g.
+   * is_picked_systematic. It is passed by value; the caller's copy is
+   * not advanced.
+   *
+   * @return The size of the sample, i.e. the new size of @p
+   * population.
+   */
+  template<class Container, class Predicate>
+  size_t resample_in_place(Container& population, Predicate predicate)
+  {
+    const size_t populationSize = population.size();
+    std::vector<size_t> counts(populationSize, 0);
+    size_t sampleSize = 0;
+    for (size_t i = 0; i < populationSize; ++i)
+    {
+      while (predicate(population[i]))
+        counts[i]++;
+      sampleSize += counts[i];
+    }
+
+    // Overwrite unpicked elements with extra copies of the elements
+    // picked several times.
+    size_t dead = 0;
+    for (size_t i = 0; i < populationSize; ++i)
+    {
+      for (size_t c = 1; c < counts[i]; ++c)
+      {
+        while (dead < populationSize && counts[dead] != 0)
+          ++dead;
+        if (dead < populationSize)
+        {
+          population[dead] = population[i];
+          // Mark the slot as occupied by a copy.
+          counts[dead] = 1;
+        }
+        else
+          population.push_back(population[i]);
+      }
+    }
+
+    if (sampleSize < populationSize)
+    {
+      using std::swap;
+      size_t out = 0;
+      for (size_t i = 0; i < populationSize; ++i)
+      {
+        if (counts[i] == 0) continue;
+        if (out != i)
+          swap(population[out], population[i]);
+        ++out;
+      }
+      population.erase(population.begin() + sampleSize, population.end());
+    }
+    return sampleSize;
+  }
+
+}
+
+#endif // include guard
@@ -0,0 +1,255 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+/** @file */
+
+#ifndef TRSL_RUN_LENGTH_SAMPLE_ITERATOR_HPP
+#define TRSL_RUN_LENGTH_SAMPLE_ITERATOR_HPP
+
+#include <trsl/common.hpp>
+#include <trsl/weight_accessor.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <algorithm>
+#include <boost/static_assert.hpp>
+#include <boost/detail/iterator.hpp>
+#include <boost/iterator/iterator_facade.hpp>
+
+namespace trsl
+{
+
+  template<class ElementIterator, typename WeightType, class WeightAccessor>
+  class run_length_sample_iterator;
+
+  namespace detail
+  {
+    /** @brief Used internally. */
+    template<class ElementIterator, typename WeightType, class WeightAccessor>
+    struct run_length_sample_iterator_base
+    {
+      typedef boost::iterator_facade<
+        run_length_sample_iterator<ElementIterator, WeightType, WeightAccessor>,
+        typename boost::detail::iterator_traits<ElementIterator>::value_type,
+        boost::forward_traversal_tag,
+        typename boost::detail::iterator_traits<ElementIterator>::reference
+      > type;
+    };
+  }
+
+  /**
+   * @brief Systematic sample iterator that visits each picked element
+   * once, along with the number of times it is picked.
+   *
+   * With trsl::is_picked_systematic and
+   * trsl::persistent_filter_iterator, an element picked @p m times is
+   * visited @p m times in a row, and each visit costs an increment
+   * and, often, a copy and an is_first_pick() check downstream. This
+   * iterator instead stops once on each picked element; multiplicity()
+   * returns its pick count. The count is computed arithmetically,
+   * <tt>ceil((w - position) / step)</tt>, instead of advancing the
+   * position one step at a time. The cost of the iteration thus
+   * depends on the number of distinct picked elements, not on the
+   * sample size. Downstream code may then copy an element once and
+   * replicate it, or keep its multiplicity as a weight multiplier.
+   *
+   * The multiplicities sum to at most @p sampleSize, and to @p
+   * sampleSize up to rounding errors. Because the position is not
+   * advanced by repeated additions, a pick that falls within a
+   * rounding error of an element boundary may go to the neighbouring
+   * element with respect to trsl::is_picked_systematic for the same
+   * random number.
+   *
+   * @p ElementIterator should model <em>Forward Iterator</em>.
+   *
+   * @param WeightType Element weight type, should be a floating point type.
+   * Defaults to <tt>double</tt>.
+   *
+   * @param WeightAccessor Type of the accessor that will allow to
+   * extract weights from elements. Defaults to mp_weight_accessor,
+   * see @ref accessor for further details on accessors.
+   */
+  template<
+    class ElementIterator,
+    typename WeightType = double,
+    class WeightAccessor = mp_weight_accessor<
+      WeightType,
+      typename boost::detail::iterator_traits<ElementIterator>::value_type>
+  >
+  class run_length_sample_iterator
+    : public detail::run_length_sample_iterator_base<
+        ElementIterator, WeightType, WeightAccessor>::type
+  {
+    BOOST_STATIC_ASSERT((std::numeric_limits<WeightType>::is_integer == false));
+
+    typedef typename detail::run_length_sample_iterator_base<
+      ElementIterator, WeightType, WeightAccessor>::type super_t;
+
+    friend class boost::iterator_core_access;
+
+  public:
+    typedef ElementIterator element_iterator;
+    typedef WeightType weight_type;
+    typedef WeightAccessor weight_accessor_type;
+
+    run_length_sample_iterator() :
+      sampleSize_(0), populationWeight_(0), uniform01_(0),
+      remaining_(0), step_(0), position_(0), weight_(0), multiplicity_(0)
+      {}
+
+    /**
+     * @brief Construction with system-provided random number.
+     *
+     * See is_picked_systematic for the meaning of the parameters. The
+     * random number is generated by trsl::rand_gen::uniform_01.
+     */
+    run_length_sample_iterator(ElementIterator first,
+                               ElementIterator last,
+                               size_t sampleSize,
+                               WeightType populationWeight,
+                               WeightAccessor const& wac = WeightAccessor()) :
+      current_(first), first_(first), last_(last), wac_(wac)
+      {
+        initialize(sampleSize, populationWeight,
+                   rand_gen::uniform_01<WeightType>());
+      }
+
+    /**
+     * @brief Construction with user-provided random number.
+     *
+     * See is_picked_systematic for the meaning of the parameters.
+     */
+    run_length_sample_iterator(ElementIterator first,
+                               ElementIterator last,
+                               size_t sampleSize,
+                               WeightType populationWeight,
+                               WeightType uniform01,
+                               WeightAccessor const& wac = WeightAccessor()) :
+      current_(first), first_(first), last_(last), wac_(wac)
+      {
+        initialize(sampleSize, populationWeight, uniform01);
+      }
+
+    /**
+     * @brief Returns an iterator to the first picked element of the
+     * sample.
+     */
+    run_length_sample_iterator begin() const
+      {
+        run_length_sample_iterator i(*this);
+        i.current_ = first_;
+        i.initialize(sampleSize_, populationWeight_, uniform01_);
+        return i;
+      }
+
+    /**
+     * @brief Returns an iterator past the last picked element of the
+     * sample.
+     */
+    run_length_sample_iterator end() const
+      {
+        run_length_sample_iterator i(*this);
+        i.current_ = last_;
+        i.multiplicity_ = 0;
+        return i;
+      }
+
+    /**
+     * @brief Returns the number of times the current element is
+     * picked, at least 1. Should not be called on the end.
+     */
+    size_t multiplicity() const { return multiplicity_; }
+
+    /**
+     * @brief Returns the underlying population iterator.
+     */
+    ElementIterator base() const { return current_; }
+
+  private:
+    void initialize(size_t sampleSize,
+                    WeightType populationWeight,
+                    WeightType uniform01)
+      {
+        sampleSize_ = sampleSize;
+        populationWeight_ = populationWeight;
+        uniform01_ = uniform01;
+        remaining_ = sampleSize;
+        step_ = (sampleSize != 0) ? populationWeight / sampleSize : 0;
+        position_ = uniform01 * step_;
+        multiplicity_ = 0;
+        satisfy();
+      }
+
+    /**
+     * Moves current_ to the next picked element, and computes its
+     * multiplicity.
+     */
+    void satisfy()
+      {
+        for (; current_ != last_; ++current_)
+        {
+          if (remaining_ == 0)
+          {
+            current_ = last_;
+            break;
+          }
+          const WeightType w = wac_(*current_);
+          if (position_ < w)
+          {
+            // Number of arrows position_ + k * step_ within [0, w[.
+            WeightType m = std::ceil((w - position_) / step_);
+            weight_ = w;
+            multiplicity_ = std::min(remaining_, size_t(std::max(m, WeightType(1))));
+            return;
+          }
+          position_ -= w;
+        }
+        multiplicity_ = 0;
+      }
+
+    void increment()
+      {
+        position_ = position_ + multiplicity_ * step_ - weight_;
+        if (position_ < 0)
+          position_ = 0;
+        remaining_ -= multiplicity_;
+        ++current_;
+        satisfy();
+      }
+
+    bool equal(run_length_sample_iterator const& i) const
+      {
+        return current_ == i.current_;
+      }
+
+    typename super_t::reference dereference() const
+      {
+        return *current_;
+      }
+
+    ElementIterator current_;
+    ElementIterator first_;
+    ElementIterator last_;
+    WeightAccessor wac_;
+
+    // Parameters, kept to implement begin().
+    size_t sampleSize_;
+    WeightType populationWeight_;
+    WeightType uniform01_;
+
+    size_t remaining_;
+    WeightType step_;
+    // Distance from the beginning of the current element to the next
+    // arrow, as in is_picked_systematic.
+    WeightType position_;
+    // Weight and pick count of the current element.
+    WeightType weight_;
+    size_t multiplicity_;
+  };
+
+} // namespace trsl
+
+#endif // include guard
@@ -0,0 +1,214 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+/** @file */
+
+#ifndef TRSL_SOA_POPULATION_HPP
+#define TRSL_SOA_POPULATION_HPP
+
+#include <trsl/common.hpp>
+#include <trsl/weight_accessor.hpp>
+#include <trsl/is_picked_systematic.hpp>
+#include <trsl/persistent_filter_iterator.hpp>
+
+#include <cstddef>
+#include <vector>
+#include <boost/iterator/transform_iterator.hpp>
+
+namespace trsl {
+
+  namespace detail {
+
+    /**
+     * @brief Used internally. Maps a reference to a weight of the
+     * weight column to the corresponding record.
+     */
+    template<class RecordType, typename WeightType>
+    struct soa_gather
+    {
+      typedef RecordType const& result_type;
+
+      soa_gather() : weights_(NULL), records_(NULL) {}
+      soa_gather(WeightType const* weights, RecordType const* records) :
+        weights_(weights), records_(records) {}
+
+      RecordType const& operator()(WeightType const& w) const
+        {
+          return records_[&w - weights_];
+        }
+    private:
+      WeightType const* weights_;
+      RecordType const* records_;
+    };
+
+  }
+
+  /**
+   * @brief Population stored as a structure of arrays: a contiguous
+   * column of weights, and a column of records.
+   *
+   * When elements are large, sampling a <tt>std::vector</tt> of
+   * elements through e.g. an mp_weight_accessor reads a whole cache
+   * line per element to use a single weight. soa_population keeps
+   * the weights in their own array, so that the sampling pass only
+   * reads the weight column; records are read only for picked
+   * elements.
+   *
+   * The weight column can be sampled directly: weight_begin() and
+   * weight_end() are iterators over <tt>WeightType</tt>, the elements
+   * of which are their own weight (see identity_weight_accessor), and
+   * is_picked is the corresponding predicate. They can be passed to
+   * a persistent_filter_iterator or a ppfilter_iterator; the position
+   * of a picked element is then <tt>i.base() - weight_begin()</tt> or
+   * <tt>i.index()</tt>, respectively. sample_begin() and sample_end()
+   * go through a systematic sample of the weight column with a
+   * persistent_filter_iterator (index_sample_iterator), and gather
+   * the picked records.
+   *
+   * @param RecordType Type of the records. Records do not need to
+   * hold their weight.
+   *
+   * @param WeightType Element weight type, should be a floating point type.
+   * Defaults to <tt>double</tt>.
+   */
+  template<class RecordType, typename WeightType = double>
+  class soa_population
+  {
+  public:
+    typedef RecordType record_type;
+    typedef WeightType weight_type;
+    typedef identity_weight_accessor<WeightType> weight_accessor_type;
+
+    typedef typename std::vector<WeightType>::const_iterator weight_iterator;
+    typedef typename std::vector<RecordType>::const_iterator record_iterator;
+
+    typedef is_picked_systematic<
+      WeightType, WeightType, weight_accessor_type> is_picked;
+
+    /** @brief Sample iterator over the weight column. */
+    typedef persistent_filter_iterator<
+      is_picked, weight_iterator> index_sample_iterator;
+
+    /** @brief Sample iterator over the records. */
+    typedef boost::transform_iterator<
+      detail::soa_gather<RecordType, WeightType>,
+      index_sample_iterator,
+      RecordType const&,
+      RecordType
+    > sample_iterator;
+
+    soa_population() : totalWeight_(0), totalWeightCompensation_(0) {}
+
+    /**
+     * @brief Reserves room for @p n elements in both columns.
+     */
+    void reserve(size_t n)
+      {
+        weights_.reserve(n);
+        records_.reserve(n);
+      }
+
+    /**
+     * @brief Appends a record and its weight.
+     */
+    void add(const RecordType& r, WeightType w)
+      {
+        detail::compensated_add(totalWeight_, totalWeightCompensation_, w);
+        weights_.push_back(w);
+        records_.push_back(r);
+      }
+
+    /**
+     * @brief Sets the weight of the element at @p i.
+     */
+    void set_weight(size_t i, WeightType w)
+      {
+        detail::compensated_add(totalWeight_, totalWeightCompensation_, w);
+        detail::compensated_add(totalWeight_, totalWeightCompensation_,
+                                -weights_[i]);
+        weights_[i] = w;
+      }
+
+    size_t size() const { return weights_.size(); }
+
+    /**
+     * @brief Returns the total weight, kept up to date by add() and
+     * set_weight() with a compensated summation.
+     */
+    WeightType total_weight() const
+      { return totalWeight_ + totalWeightCompensation_; }
+
+    WeightType weight(size_t i) const { return weights_[i]; }
+
+    const RecordType& record(size_t i) const { return records_[i]; }
+
+    RecordType& record(size_t i) { return records_[i]; }
+
+    weight_iterator weight_begin() const { return weights_.begin(); }
+    weight_iterator weight_end() const { return weights_.end(); }
+
+    record_iterator record_begin() const { return records_.begin(); }
+    record_iterator record_end() const { return records_.end(); }
+
+    /**
+     * @brief Returns an iterator to the beginning of a sample of size
+     * @p sampleSize of the weight column.
+     */
+    index_sample_iterator index_sample_begin(size_t sampleSize) const
+      {
+        is_picked predicate(sampleSize, total_weight());
+        return index_sample_iterator(predicate, weights_.begin(), weights_.end());
+      }
+
+    /**
+     * @brief Returns an iterator to the end of a sample of the weight
+     * column.
+     */
+    index_sample_iterator index_sample_end() const
+      {
+        // For an end of range filter_iterator, the predicate operator()
+        // will never be called. We can put anything for sampleSize and
+        // populationWeight.  A "random" number should be provided, to
+        // avoid a useless call to random().
+        is_picked predicate(1, 1, 0);
+        return index_sample_iterator(predicate, weights_.end(), weights_.end());
+      }
+
+    /**
+     * @brief Returns an iterator to the beginning of a sample of size
+     * @p sampleSize of the records.
+     */
+    sample_iterator sample_begin(size_t sampleSize) const
+      {
+        return sample_iterator(index_sample_begin(sampleSize), gather());
+      }
+
+    /**
+     * @brief Returns an iterator to the end of a sample of the
+     * records.
+     */
+    sample_iterator sample_end() const
+      {
+        return sample_iterator(index_sample_end(), gather());
+      }
+
+  private:
+    detail::soa_gather<RecordType, WeightType> gather() const
+      {
+        if (weights_.empty())
+          return detail::soa_gather<RecordType, WeightType>();
+        return detail::soa_gather<RecordType, WeightType>(&weights_[0],
+                                                         &records_[0]);
+      }
+
+    std::vector<WeightType> weights_;
+    std::vector<RecordType> records_;
+    WeightType totalWeight_;
+    WeightType totalWeightCompensation_;
+  };
+
+}
+
+#endif // include guard
@@ -9,6 +9,7 @@
 #define TRSL_SORT_ITERATOR_HPP
 
 #include <trsl/reorder_iterator.hpp>
+#include <trsl/index_workspace.hpp>
 #include <trsl/common.hpp>
 #include <trsl/error_handling.hpp>
 
@@ -21,7 +22,8 @@ namespace trsl
   
     template<
       class RandomIterator,
-      class Comparator
+      class Comparator,
+      class IndexType = size_t
       > class at_index_comp
       {
       public:
@@ -30,7 +32,7 @@ namespace trsl
           elements_(first), comp_(comp)
           {}
       
-        bool operator() (unsigned i, unsigned j)
+        bool operator() (IndexType i, IndexType j)
           {
             return comp_(*(elements_+i), *(elements_+j));
           }
@@ -38,6 +40,76 @@ namespace trsl
         RandomIterator elements_;
         Comparator comp_;
       };
+
+    /**
+     * @brief Used internally. The permutation is written into @p
+     * index_collection.
+     */
+    template<class IndexType, class ElementIterator, class ElementComparator>
+    reorder_iterator<ElementIterator, IndexType>
+    sort_iterator(ElementIterator first,
+                  ElementIterator last,
+                  ElementComparator comp,
+                  size_t permutationSize,
+                  const typename reorder_iterator<
+                    ElementIterator, IndexType
+                  >::index_container_ptr& index_collection)
+    {
+      ptrdiff_t size = std::distance(first, last);
+      if (size < 0)
+        throw bad_parameter_value(
+          "sort_iterator: "
+          "bad input range.");
+      if (permutationSize > size_t(size))
+        throw bad_parameter_value(
+          "sort_iterator: "
+          "parameter permutationSize out of range.");
+      check_index_range<IndexType>(size, "sort_iterator");
+
+      typedef
+        typename reorder_iterator<ElementIterator, IndexType>::index_t
+        index_t;
+
+      index_collection->resize(size);
+      for (size_t i = 0; i < size_t(size); ++i)
+        (*index_collection)[i] = index_t(i);
+  
+      if (permutationSize == size_t(size))
+        std::sort(index_collection->begin(),
+                  index_collection->end(),
+                  at_index_comp
+                  <ElementIterator, ElementComparator, IndexType>(first, comp));
+      else
+      {
+        std::partial_sort(index_collection->begin(),
+                          index_collection->begin()+permutationSize,
+                          index_collection->end(),
+                          at_index_comp
+                          <ElementIterator, ElementComparator, IndexType>(first, comp));
+        index_collection->resize(permutationSize);
+      }
+  
+      return reorder_iterator<ElementIterator, IndexType>(first, index_collection);
+    }
+
+    /** @brief Used internally. Allocates a new index array. */
+    template<class IndexType, class ElementIterator, class ElementComparator>
+    reorder_iterator<ElementIterator, IndexType>
+    sort_iterator(ElementIterator first,
+                  ElementIterator last,
+                  ElementComparator comp,
+                  size_t permutationSize)
+    {
+      typedef
+        typename reorder_iterator<ElementIterator, IndexType>::index_container
+        index_container;
+      typedef
+        typename reorder_iterator<ElementIterator, IndexType>::index_container_ptr
+        index_container_ptr;
+
+      return sort_iterator<IndexType>(first, last, comp, permutationSize,
+                                      index_container_ptr(new index_container));
+    }
   
   }
 
@@ -76,50 +148,9 @@ namespace trsl
   sort_iterator(ElementIterator first,
                 ElementIterator last,
                 ElementComparator comp,
-                unsigned permutationSize)
+                size_t permutationSize)
   {
-    ptrdiff_t size = std::distance(first, last);
-    if (size < 0)
-      throw bad_parameter_value(
-        "sort_iterator: "
-        "bad input range.");
-    if (permutationSize > unsigned(size))
-      throw bad_parameter_value(
-        "sort_iterator: "
-        "parameter permutationSize out of range.");
-        
-    typedef
-      typename reorder_iterator<ElementIterator>::index_container
-      index_container;
-    typedef
-      typename reorder_iterator<ElementIterator>::index_container_ptr
-      index_container_ptr;
-    typedef
-      typename reorder_iterator<ElementIterator>::index_t
-      index_t;
-  
-    index_container_ptr index_collection(new index_container);
-        
-    index_collection->resize(size);
-    for (index_t i = 0; i < index_t(size); ++i)
-      (*index_collection)[i] = i;
-    
-    if (permutationSize == unsigned(size))
-      std::sort(index_collection->begin(),
-                index_collection->end(),
-                detail::at_index_comp
-                <ElementIterator, ElementComparator>(first, comp));
-    else
-    {
-      std::partial_sort(index_collection->begin(),
-                        index_collection->begin()+permutationSize,
-                        index_collection->end(),
-                        detail::at_index_comp
-                        <ElementIterator, ElementComparator>(first, comp));
-      index_collection->resize(permutationSize);
-    }
-    
-    return reorder_iterator<ElementIterator>(first, index_collection);
+    return detail::sort_iterator<size_t>(first, last, comp, permutationSize);
   }
 
   /**
@@ -187,6 +218,121 @@ namespace trsl
                          <ElementIterator>::value_type>());
   }
 
+  /**
+   * @brief Constructs a reorder_iterator with indices of type @p
+   * IndexType, e.g. <tt>boost::uint32_t</tt>, that will iterate
+   * through the first @p permutationSize elements of a sorted
+   * permutation of the population referenced by @p first and @p
+   * last.
+   *
+   * @p IndexType is given explicitly, e.g.
+   * <tt>sort_iterator<boost::uint32_t>(first, last, comp,
+   * permutationSize)</tt>. If the population does not fit in @p
+   * IndexType, a bad_parameter_value is thrown. See reorder_iterator
+   * and the functions above.
+   */
+  template<class IndexType, class ElementIterator, class ElementComparator>
+  reorder_iterator<ElementIterator, IndexType>
+  sort_iterator(ElementIterator first,
+                ElementIterator last,
+                ElementComparator comp,
+                size_t permutationSize)
+  {
+    return detail::sort_iterator<IndexType>(first, last, comp, permutationSize);
+  }
+
+  /**
+   * @brief Constructs a reorder_iterator with indices of type @p
+   * IndexType, that will iterate through a sorted permutation of the
+   * population referenced by @p first and @p last. See above.
+   */
+  template<class IndexType, class ElementIterator, class ElementComparator>
+  reorder_iterator<ElementIterator, IndexType>
+  sort_iterator(ElementIterator first,
+                ElementIterator last,
+                ElementComparator comp)
+  {
+    return detail::sort_iterator<IndexType>(first, last, comp,
+                                            std::distance(first, last));
+  }
+
+  /**
+   * @brief Constructs a reorder_iterator with indices of type @p
+   * IndexType, that will iterate through a permutation of the
+   * population referenced by @p first and @p last, sorted in
+   * ascending order. See above.
+   */
+  template<class IndexType, class ElementIterator>
+  reorder_iterator<ElementIterator, IndexType>
+  sort_iterator(ElementIterator first,
+                ElementIterator last)
+  {
+    return detail::sort_iterator<IndexType>(
+      first, last,
+      std::less<typename std::iterator_traits<ElementIterator>::value_type>(),
+      std::distance(first, last));
+  }
+
+  /**
+   * @brief Constructs a reorder_iterator that will iterate through
+   * the first @p permutationSize elements of a sorted permutation of
+   * the population referenced by @p first and @p last, storing the
+   * permutation in an index array of @p workspace.
+   *
+   * Identical to the functions above, except that the index array is
+   * taken from @p workspace, which allocates memory only if all its
+   * arrays are still in use. See index_workspace. The index type of
+   * the returned iterator is that of @p workspace.
+   */
+  template<class ElementIterator, class ElementComparator, class IndexType>
+  reorder_iterator<ElementIterator, IndexType>
+  sort_iterator(ElementIterator first,
+                ElementIterator last,
+                ElementComparator comp,
+                size_t permutationSize,
+                index_workspace<IndexType>& workspace)
+  {
+    return detail::sort_iterator<IndexType>(first, last, comp, permutationSize,
+                                            workspace.acquire());
+  }
+
+  /**
+   * @brief Constructs a reorder_iterator that will iterate through a
+   * sorted permutation of the population referenced by @p first and
+   * @p last, storing the permutation in an index array of @p
+   * workspace. See above.
+   */
+  template<class ElementIterator, class ElementComparator, class IndexType>
+  reorder_iterator<ElementIterator, IndexType>
+  sort_iterator(ElementIterator first,
+                ElementIterator last,
+                ElementComparator comp,
+                index_workspace<IndexType>& workspace)
+  {
+    return detail::sort_iterator<IndexType>(first, last, comp,
+                                            std::distance(first, last),
+                                            workspace.acquire());
+  }
+
+  /**
+   * @brief Constructs a reorder_iterator that will iterate through a
+   * permutation of the population referenced by @p first and @p last,
+   * sorted in ascending order, storing the permutation in an index
+   * array of @p workspace. See above.
+   */
+  template<class ElementIterator, class IndexType>
+  reorder_iterator<ElementIterator, IndexType>
+  sort_iterator(ElementIterator first,
+                ElementIterator last,
+                index_workspace<IndexType>& workspace)
+  {
+    return detail::sort_iterator<IndexType>(
+      first, last,
+      std::less<typename std::iterator_traits<ElementIterator>::value_type>(),
+      std::distance(first, last),
+      workspace.acquire());
+  }
+
 } // namespace trsl
 
 #endif // include guard
@@ -0,0 +1,259 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+/** @file */
+
+#ifndef TRSL_SYSTEMATIC_SAMPLE_HPP
+#define TRSL_SYSTEMATIC_SAMPLE_HPP
+
+#include <trsl/common.hpp>
+#include <trsl/weight_accessor.hpp>
+
+#include <cstddef>
+#include <limits>
+#include <boost/static_assert.hpp>
+
+namespace trsl {
+
+  /**
+   * @brief Writes the indices of a systematic sample of
+   * [@p first, @p last) to @p out.
+   *
+   * This function is the batch counterpart of
+   * trsl::is_picked_systematic used with
+   * trsl::persistent_filter_iterator. It walks the population once,
+   * calls the weight accessor once per element, and writes the index
+   * (position relative to @p first) of every picked element to @p
+   * out. An element picked several times has its index written
+   * several times, consecutively.
+   *
+   * For a given @p uniform01, the picked indices are the first @p
+   * sampleSize of those of the elements visited by a
+   * persistent_filter_iterator driven by
+   * <tt>is_picked_systematic(sampleSize, populationWeight,
+   * uniform01, wac)</tt>: both implementations perform the same
+   * floating-point operations in the same order.
+   *
+   * Unlike the iterator, this function writes at most @p sampleSize
+   * indices, and stops walking the population once it has. The cap
+   * only applies when the walk picks more than @p sampleSize
+   * elements. Rounding errors can cause one extra pick. If @p
+   * populationWeight is less than the sum of the weights, the walk
+   * can make many extra picks, and the elements at the end of the
+   * population are then never picked. Conversely, if @p
+   * populationWeight exceeds the sum of the weights, fewer than @p
+   * sampleSize indices are written.
+   *
+   * @param first, last Population range. @p ElementIterator should
+   * model <em>Input Iterator</em>.
+   *
+   * @param sampleSize Number of elements in the sample, within
+   * <tt>[0, infinity[</tt>.
+   *
+   * @param populationWeight Total weight of the population, within
+   * <tt>]0, infinity[</tt>.
+   *
+   * @param uniform01 Random number in <tt>[0,1[</tt>.
+   *
+   * @param wac Weight accessor, see @ref accessor. Note that a bare
+   * method pointer is not an accessor; wrap it in a
+   * trsl::mp_weight_accessor.
+   *
+   * @param out Output iterator to which indices are written, as
+   * <tt>size_t</tt>. It should have room for @p sampleSize
+   * indices.
+   *
+   * @return The output iterator, past the last written index.
+   */
+  template<
+    class ElementIterator,
+    typename WeightType,
+    class WeightAccessor,
+    class OutputIterator
+  >
+  OutputIterator systematic_sample(ElementIterator first,
+                                   ElementIterator last,
+                                   size_t sampleSize,
+                                   WeightType populationWeight,
+                                   WeightType uniform01,
+                                   WeightAccessor wac,
+                                   OutputIterator out)
+  {
+    BOOST_STATIC_ASSERT((std::numeric_limits<WeightType>::is_integer == false));
+    if (sampleSize == 0) return out;
+
+    // See is_picked_systematic::operator() for the meaning of the
+    // two algorithms. The order of the floating-point operations
+    // below must remain identical to that of is_picked_systematic.
+    const WeightType step = populationWeight / sampleSize;
+#ifdef TRSL_USE_SYSTEMATIC_INTUITIVE_ALGORITHM
+    WeightType cumulative = -(uniform01 * step);
+    size_t k = 0;
+    for (size_t index = 0; first != last && k < sampleSize; ++first, ++index)
+    {
+      const WeightType w = wac(*first);
+      while (k < sampleSize && WeightType(k*step) < cumulative + w)
+      {
+        *out++ = index;
+        k++;
+      }
+      cumulative += w;
+    }
+#else
+    WeightType position = uniform01 * step;
+    size_t picks = 0;
+    for (size_t index = 0; first != last && picks < sampleSize; ++first, ++index)
+    {
+      const WeightType w = wac(*first);
+      while (picks < sampleSize && position < w)
+      {
+        *out++ = index;
+        picks++;
+        position += step;
+      }
+      position -= w;
+    }
+#endif
+    return out;
+  }
+
+  /**
+   * @brief Writes the indices of a systematic sample of
+   * [@p first, @p last) to @p out, with system-provided random
+   * number.
+   *
+   * Identical to the function above, except that the random number
+   * is generated by trsl::rand_gen::uniform_01. See @ref random.
+   */
+  template<
+    class ElementIterator,
+    typename WeightType,
+    class WeightAccessor,
+    class OutputIterator
+  >
+  OutputIterator systematic_sample(ElementIterator first,
+                                   ElementIterator last,
+                                   size_t sampleSize,
+                                   WeightType populationWeight,
+                                   WeightAccessor wac,
+                                   OutputIterator out)
+  {
+    return systematic_sample(first, last,
+                             sampleSize, populationWeight,
+                             rand_gen::uniform_01<WeightType>(),
+                             wac, out);
+  }
+
+  /**
+   * @brief Writes, for each element of [@p first, @p last), the
+   * number of times it is picked by systematic sampling.
+   *
+   * Exactly one count is written to @p out per population element,
+   * in population order. Counts are those that
+   * trsl::systematic_sample would produce for the same @p
+   * uniform01; in particular, they sum to at most @p sampleSize (see
+   * systematic_sample() for when this cap applies). Elements that
+   * are not picked get a count of 0.
+   *
+   * This form is convenient for resampling schemes that keep the
+   * population in place and replicate elements according to their
+   * offspring count.
+   *
+   * @param out Output iterator to which counts are written, as
+   * <tt>size_t</tt>. It should have room for
+   * <tt>std::distance(first, last)</tt> counts.
+   *
+   * See systematic_sample() for the other parameters.
+   *
+   * @return The output iterator, past the last written count.
+   */
+  template<
+    class ElementIterator,
+    typename WeightType,
+    class WeightAccessor,
+    class OutputIterator
+  >
+  OutputIterator systematic_offspring(ElementIterator first,
+                                      ElementIterator last,
+                                      size_t sampleSize,
+                                      WeightType populationWeight,
+                                      WeightType uniform01,
+                                      WeightAccessor wac,
+                                      OutputIterator out)
+  {
+    BOOST_STATIC_ASSERT((std::numeric_limits<WeightType>::is_integer == false));
+    if (sampleSize == 0)
+    {
+      for (; first != last; ++first)
+        *out++ = size_t(0);
+      return out;
+    }
+
+    const WeightType step = populationWeight / sampleSize;
+#ifdef TRSL_USE_SYSTEMATIC_INTUITIVE_ALGORITHM
+    WeightType cumulative = -(uniform01 * step);
+    size_t k = 0;
+    for (; first != last; ++first)
+    {
+      const WeightType w = wac(*first);
+      size_t count = 0;
+      while (k < sampleSize && WeightType(k*step) < cumulative + w)
+      {
+        count++;
+        k++;
+      }
+      cumulative += w;
+      *out++ = count;
+    }
+#else
+    WeightType position = uniform01 * step;
+    size_t picks = 0;
+    for (; first != last; ++first)
+    {
+      const WeightType w = wac(*first);
+      size_t count = 0;
+      while (picks < sampleSize && position < w)
+      {
+        count++;
+        picks++;
+        position += step;
+      }
+      position -= w;
+      *out++ = count;
+    }
+#endif
+    return out;
+  }
+
+  /**
+   * @brief Writes, for each element of [@p first, @p last), the
+   * number of times it is picked by systematic sampling, with
+   * system-provided random number.
+   *
+   * Identical to the function above, except that the random number
+   * is generated by trsl::rand_gen::uniform_01. See @ref random.
+   */
+  template<
+    class ElementIterator,
+    typename WeightType,
+    class WeightAccessor,
+    class OutputIterator
+  >
+  OutputIterator systematic_offspring(ElementIterator first,
+                                      ElementIterator last,
+                                      size_t sampleSize,
+                                      WeightType populationWeight,
+                                      WeightAccessor wac,
+                                      OutputIterator out)
+  {
+    return systematic_offspring(first, last,
+                                sampleSize, populationWeight,
+                                rand_gen::uniform_01<WeightType>(),
+                                wac, out);
+  }
+
+}
+
+#endif // include guard
@@ -95,6 +95,93 @@ namespace trsl {
     WeightAccessorMethodPointer wptr_;
   };
 
+  /**
+   * @brief Compile-time method pointer weight accessor.
+   *
+   * Same as mp_weight_accessor, except that the method pointer is a
+   * template argument instead of a constructor argument. The accessor
+   * holds no state and does not check the pointer; the call is
+   * resolved at compile time and can be inlined like a hand-written
+   * functor.
+   *
+   * @p ClassType is the class that declares the method. The accessor
+   * can be used for classes derived from @p ClassType.
+   *
+   * <dl>
+   * <dt>Accessor Type</dt>
+   * <dd><tt>trsl::const_method_weight_accessor<double, Particle,
+   * &Particle::getWeight></tt></dd>
+   * <dt>Accessor object, to pass to the object that needs access</dt>
+   * <dd>A default-constructed object.</dd>
+   * </dl>
+   *
+   * See @ref accessor for more details.
+   */
+  template<
+    typename WeightType,
+    typename ClassType,
+    WeightType (ClassType::*Method)() const
+  >
+  struct const_method_weight_accessor
+  {
+    WeightType operator()(ClassType const& e) const
+      {
+        return (e.*Method)();
+      }
+  };
+
+  /**
+   * @brief Compile-time data member pointer weight accessor.
+   *
+   * Reads the weight from a public data member, the pointer to which
+   * is a template argument. Like const_method_weight_accessor, it
+   * holds no state and can be inlined.
+   *
+   * <dl>
+   * <dt>Accessor Type</dt>
+   * <dd><tt>trsl::member_weight_accessor<double, Particle,
+   * &Particle::weight></tt></dd>
+   * <dt>Accessor object, to pass to the object that needs access</dt>
+   * <dd>A default-constructed object.</dd>
+   * </dl>
+   *
+   * See @ref accessor for more details.
+   */
+  template<
+    typename WeightType,
+    typename ClassType,
+    WeightType ClassType::*Member
+  >
+  struct member_weight_accessor
+  {
+    WeightType operator()(ClassType const& e) const
+      {
+        return e.*Member;
+      }
+  };
+
+  /**
+   * @brief Weight accessor for populations of bare weights.
+   *
+   * Returns the element itself. This accessor allows sampling a range
+   * of weights, e.g. the weight column of a soa_population, and
+   * recovering the picked positions from the iterators. See @ref
+   * accessor for more details.
+   */
+  template<typename WeightType>
+  struct identity_weight_accessor
+  {
+    /**
+     * @brief Functor implementation.
+     *
+     * @return @p w.
+     */
+    WeightType operator()(WeightType const& w) const
+      {
+        return w;
+      }
+  };
+
 }
 
 #endif // include guard
@@ -0,0 +1,168 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+/** @file */
+
+#ifndef TRSL_WEIGHT_STATISTICS_HPP
+#define TRSL_WEIGHT_STATISTICS_HPP
+
+#include <trsl/common.hpp>
+#include <trsl/population_weight.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+#include <limits>
+#include <boost/static_assert.hpp>
+
+namespace trsl {
+
+  namespace detail {
+
+    // Number of weights read before their statistics are accumulated.
+    static const size_t weight_statistics_block_size = 64;
+
+  }
+
+  /**
+   * @brief Summary of the weights of a population, see
+   * compute_weight_statistics().
+   *
+   * @param WeightType Element weight type, should be a floating point type.
+   */
+  template<typename WeightType = double>
+  struct weight_statistics
+  {
+    BOOST_STATIC_ASSERT((std::numeric_limits<WeightType>::is_integer == false));
+
+    weight_statistics() :
+      populationSize(0),
+      populationWeight(0),
+      effectiveSampleSize(0),
+      entropy(0)
+      {}
+
+    /** @brief Number of elements. */
+    size_t populationSize;
+
+    /** @brief Sum of the weights. */
+    WeightType populationWeight;
+
+    /**
+     * @brief Effective sample size, <tt>1 / sum(p_i^2)</tt>, where
+     * <tt>p_i</tt> are the normalized weights.
+     *
+     * Equal to the population size when weights are uniform, and to 1
+     * when a single element has a positive weight.
+     */
+    WeightType effectiveSampleSize;
+
+    /**
+     * @brief Entropy of the normalized weights, <tt>-sum(p_i
+     * log(p_i))</tt>, in nats.
+     *
+     * Equal to <tt>log(populationSize)</tt> when weights are uniform,
+     * and to 0 when a single element has a positive weight.
+     */
+    WeightType entropy;
+  };
+
+  /**
+   * @brief Computes the total weight, the effective sample size and
+   * the entropy of the weights of [@p first, @p last), in a single
+   * pass.
+   *
+   * The effective sample size and the entropy are derived from the
+   * sums of <tt>w</tt>, <tt>w^2</tt> and <tt>w log(w)</tt>, which do
+   * not require the weights to be normalized. Weights are read by
+   * blocks into a local buffer. Within a block, each sum is spread
+   * over independent accumulators, as in population_weight(), which
+   * lets the compiler vectorize the sums without reordering
+   * floating point operations. The sums of the blocks are then
+   * accumulated with a compensated summation.
+   *
+   * The <tt>w log(w)</tt> terms are computed in a separate loop
+   * without branches. That loop is only vectorized if the compiler
+   * has a vector <tt>log</tt> and is allowed to call it, e.g. GCC
+   * with glibc and <tt>-ffast-math</tt>. Otherwise, <tt>log</tt> is
+   * called once per element.
+   *
+   * The accessor is called once per element.
+   *
+   * If the population weight is null, the effective sample size and
+   * the entropy are 0.
+   *
+   * @p ElementIterator should model <em>Input Iterator</em>.
+   *
+   * @param wac Weight accessor, see @ref accessor. Note that a bare
+   * method pointer is not an accessor; wrap it in a
+   * trsl::mp_weight_accessor. Weights should be non-negative.
+   */
+  template<typename WeightType, class ElementIterator, class WeightAccessor>
+  weight_statistics<WeightType>
+  compute_weight_statistics(ElementIterator first,
+                            ElementIterator last,
+                            WeightAccessor const& wac)
+  {
+    const size_t L = detail::population_weight_lanes;
+    const size_t B = detail::weight_statistics_block_size;
+    BOOST_STATIC_ASSERT((detail::weight_statistics_block_size %
+                         detail::population_weight_lanes == 0));
+    // Smallest positive weight, w log(max(w, tiny)) is 0 for w = 0.
+    const WeightType tiny = std::numeric_limits<WeightType>::min();
+
+    WeightType block[B], wLogW[B];
+    weight_statistics<WeightType> stats;
+    WeightType sum = 0, sumOfSquares = 0, sumOfWLogW = 0;
+    WeightType sumC = 0, sumOfSquaresC = 0, sumOfWLogWC = 0;
+    while (first != last)
+    {
+      size_t n = 0;
+      for (; n < B && first != last; ++n, ++first)
+        block[n] = wac(*first);
+      stats.populationSize += n;
+      // Zero weights add nothing to the sums.
+      for (; n % L != 0; ++n)
+        block[n] = 0;
+
+      for (size_t i = 0; i < n; ++i)
+        wLogW[i] = block[i] * std::log(std::max(block[i], tiny));
+
+      WeightType s[L], s2[L], slog[L];
+      for (size_t l = 0; l < L; ++l)
+        s[l] = s2[l] = slog[l] = 0;
+      for (size_t i = 0; i < n; i += L)
+        for (size_t l = 0; l < L; ++l)
+        {
+          const WeightType w = block[i + l];
+          s[l] += w;
+          s2[l] += w * w;
+          slog[l] += wLogW[i + l];
+        }
+      for (size_t l = 0; l < L; ++l)
+      {
+        detail::compensated_add(sum, sumC, s[l]);
+        detail::compensated_add(sumOfSquares, sumOfSquaresC, s2[l]);
+        detail::compensated_add(sumOfWLogW, sumOfWLogWC, slog[l]);
+      }
+    }
+    sum += sumC;
+    sumOfSquares += sumOfSquaresC;
+    sumOfWLogW += sumOfWLogWC;
+
+    stats.populationWeight = sum;
+    if (sum > 0)
+    {
+      stats.effectiveSampleSize = sum * sum / sumOfSquares;
+      // -sum((w/W) log(w/W)) = log(W) - sum(w log(w)) / W
+      stats.entropy = std::max(WeightType(0),
+                               std::log(sum) - sumOfWLogW / sum);
+    }
+    return stats;
+  }
+
+}
+
+#endif // include guard
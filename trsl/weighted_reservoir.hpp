@@ -0,0 +1,334 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+/** @file */
+
+#ifndef TRSL_WEIGHTED_RESERVOIR_HPP
+#define TRSL_WEIGHTED_RESERVOIR_HPP
+
+#include <trsl/common.hpp>
+#include <trsl/weight_accessor.hpp>
+
+#include <cmath>
+#include <vector>
+#include <limits>
+#include <boost/static_assert.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/random/linear_congruential.hpp>
+
+namespace trsl {
+
+  /**
+   * @brief Weighted reservoir, for sampling a single-pass stream of
+   * unknown length and unknown total weight.
+   *
+   * trsl::is_picked_systematic and the other sampling predicates need
+   * the total weight of the population before the first element is
+   * considered. When the population comes from a stream that can only
+   * be read once, it would have to be buffered entirely. A weighted
+   * reservoir instead keeps a sample of at most @p sampleSize
+   * elements of the elements seen so far, and updates it as new
+   * elements are pushed. At any time, the reservoir contains a
+   * weighted sample <em>without replacement</em> of the elements
+   * pushed since construction or since the last call to clear(): the
+   * reservoir behaves as if elements were drawn one after the other,
+   * each one with a probability proportional to its weight among the
+   * elements not drawn yet.
+   *
+   * Each element gets a random key <tt>u^(1/w)</tt>, where @p u is
+   * uniform in <tt>]0,1[</tt> and @p w is the weight of the element,
+   * and the reservoir keeps the elements of largest keys (algorithm
+   * A-Res of [1]). Instead of drawing a key for each element, the
+   * reservoir draws the amount of weight to skip before the element
+   * that will replace the smallest key of the reservoir (algorithm
+   * A-ExpJ of [1]). Once the reservoir is full, elements are skipped
+   * at the cost of one weight access and one subtraction, and random
+   * numbers are only drawn when the reservoir changes, i.e. about
+   * <tt>sampleSize * log(n / sampleSize)</tt> times for @p n elements
+   * of similar weights. Keys are handled through their logarithm, to
+   * avoid underflows with small weights.
+   *
+   * Elements are copied into the reservoir. When elements are large,
+   * consider pushing pointers or indices, with an appropriate
+   * accessor. Elements of null weight are only kept while the
+   * reservoir has room for them, i.e. while fewer than @p sampleSize
+   * elements of positive weight have been pushed.
+   *
+   * Random numbers are generated by a small pseudo-random generator
+   * (<a href="http://www.boost.org/libs/random/index.html"
+   * >boost::rand48</a>) stored in the reservoir.
+   *
+   * @param ElementType Type of the elements in the population.
+   *
+   * @param WeightType Element weight type, should be a floating point type.
+   * Defaults to <tt>double</tt>.
+   *
+   * @param WeightAccessor Type of the accessor that will allow to
+   * extract weights from elements. Defaults to mp_weight_accessor,
+   * see @ref accessor for further details on accessors.
+   *
+   * <b>References:</b>
+   *
+   * - [1] P. S. Efraimidis and P. G. Spirakis. Weighted random
+   * sampling with a reservoir. Information Processing Letters,
+   * 97(5):181-185, 2006.
+   */
+  template<
+    typename ElementType,
+    typename WeightType = double,
+    typename WeightAccessor = mp_weight_accessor<WeightType, ElementType>
+  > class weighted_reservoir
+  {
+  private:
+    BOOST_STATIC_ASSERT((std::numeric_limits<WeightType>::is_integer == false));
+  public:
+    typedef ElementType element_type;
+    typedef WeightType weight_type;
+    typedef WeightAccessor weight_accessor_type;
+    /** @brief Type of the seed of the internal random generator. */
+    typedef boost::uint32_t seed_type;
+    /** @brief Iterator over the elements of the reservoir. */
+    typedef typename std::vector<ElementType>::const_iterator const_iterator;
+
+    /**
+     * @brief Construction with system-provided seed.
+     *
+     * The internal generator is seeded with
+     * trsl::rand_gen::uniform_int.  See @ref random for more details.
+     *
+     * @param sampleSize Maximum number of elements in the reservoir,
+     * within <tt>[0, infinity[</tt>.
+     *
+     * @param wac Weight accessor, see @ref accessor. Note that a bare
+     * method pointer is not an accessor; wrap it in a
+     * trsl::mp_weight_accessor.
+     */
+    explicit weighted_reservoir(size_t sampleSize,
+                                WeightAccessor const& wac = WeightAccessor()) :
+      wac_(wac), sampleSize_(sampleSize)
+      {
+        initialize( rand_gen::uniform_int(RAND_MAX) );
+      }
+
+    /**
+     * @brief Construction with user-provided seed.
+     *
+     * Two reservoirs constructed with the same parameters and the
+     * same @p seed keep the same elements of the same stream.
+     *
+     * @param sampleSize Maximum number of elements in the reservoir,
+     * within <tt>[0, infinity[</tt>.
+     *
+     * @param seed Seed for the internal random generator.
+     *
+     * @param wac Weight accessor, see @ref accessor.
+     */
+    weighted_reservoir(size_t sampleSize,
+                       seed_type seed,
+                       WeightAccessor const& wac = WeightAccessor()) :
+      wac_(wac), sampleSize_(sampleSize)
+      {
+        initialize(seed);
+      }
+
+    /**
+     * @brief Offers @p e to the reservoir.
+     */
+    void push(ElementType const& e)
+      {
+        if (sampleSize_ == 0)
+          return;
+        const WeightType w = wac_(e);
+        if (elements_.size() < sampleSize_)
+          fill(e, w);
+        else if (w > skip_)
+          replace(e, w);
+        else
+          skip_ -= w;
+      }
+
+    /**
+     * @brief Offers the elements of [@p first, @p last) to the
+     * reservoir, in order.
+     *
+     * Equivalent to calling push(ElementType const&) for each
+     * element. @p InputIterator should model <em>Input
+     * Iterator</em>: the range is read once.
+     */
+    template<class InputIterator>
+    void push(InputIterator first, InputIterator last)
+      {
+        if (sampleSize_ == 0)
+          return;
+        for (; first != last && elements_.size() < sampleSize_; ++first)
+        {
+          // Elements are dereferenced once, since InputIterators
+          // may return temporaries.
+          ElementType const& e = *first;
+          fill(e, wac_(e));
+        }
+        while (first != last)
+        {
+          ElementType const& e = *first;
+          const WeightType w = wac_(e);
+          if (w > skip_)
+            replace(e, w);
+          else
+            skip_ -= w;
+          ++first;
+        }
+      }
+
+    /**
+     * @brief Empties the reservoir, which then samples a new stream.
+     *
+     * The state of the random generator is kept.
+     */
+    void clear()
+      {
+        elements_.clear();
+        keys_.clear();
+        skip_ = 0;
+      }
+
+    /**
+     * @brief Number of elements in the reservoir.
+     *
+     * Equal to the number of elements pushed since construction or
+     * since the last call to clear(), within the limit of @p
+     * sampleSize.
+     */
+    size_t size() const { return elements_.size(); }
+
+    /**
+     * @brief Maximum number of elements in the reservoir.
+     */
+    size_t sample_size() const { return sampleSize_; }
+
+    /**
+     * @brief Iterator to the first element of the reservoir.
+     *
+     * The order of the elements in the reservoir is unspecified.
+     * Iterators are invalidated by push() and clear().
+     */
+    const_iterator begin() const { return elements_.begin(); }
+
+    /**
+     * @brief Iterator past the last element of the reservoir.
+     */
+    const_iterator end() const { return elements_.end(); }
+
+  private:
+    void initialize(seed_type seed)
+      {
+        rng_.seed(detail::mix_seed(seed));
+        elements_.reserve(sampleSize_);
+        keys_.reserve(sampleSize_);
+        skip_ = 0;
+      }
+
+    /**
+     * Returns a number in ]0,1[, so that its logarithm is finite and
+     * negative.
+     */
+    WeightType open_uniform_01()
+      {
+        WeightType u;
+        do u = rand_gen::uniform_01<WeightType>(rng_);
+        while (u == 0);
+        return u;
+      }
+
+    /**
+     * Returns the logarithm of the key u^(1/w) of an element of
+     * weight w.
+     */
+    WeightType log_key(WeightType logU, WeightType w) const
+      {
+        if (w > 0)
+          return logU / w;
+        return -std::numeric_limits<WeightType>::infinity();
+      }
+
+    void fill(ElementType const& e, WeightType w)
+      {
+        elements_.push_back(e);
+        keys_.push_back(log_key(std::log(open_uniform_01()), w));
+        if (elements_.size() == sampleSize_)
+        {
+          for (size_t i = sampleSize_ / 2; i > 0; --i)
+            sift_down(i - 1);
+          draw_skip();
+        }
+      }
+
+    /**
+     * Replaces the element of smallest key with e, whose key is
+     * drawn conditionally on being larger than the smallest key.
+     */
+    void replace(ElementType const& e, WeightType w)
+      {
+        // The key of e is u^(1/w) with u uniform in ]t, 1[, where
+        // t = minKey^w.
+        const WeightType t = std::exp(w * keys_[0]);
+        const WeightType u = t + (1 - t) * open_uniform_01();
+        elements_[0] = e;
+        keys_[0] = (u < 1) ? std::log(u) / w : 0;
+        sift_down(0);
+        draw_skip();
+      }
+
+    /**
+     * Draws the weight to skip before the next replacement, given
+     * the current smallest key.
+     */
+    void draw_skip()
+      {
+        // log(r) / log(minKey), with r uniform in ]0,1[. When the
+        // smallest key is that of a null-weight element, the next
+        // positive-weight element replaces it. A key of 1 (possible
+        // through rounding) cannot be replaced.
+        if (keys_[0] < 0)
+          skip_ = std::log(open_uniform_01()) / keys_[0];
+        else
+          skip_ = std::numeric_limits<WeightType>::infinity();
+      }
+
+    /**
+     * Restores the min-heap property of keys_ below i, moving
+     * elements_ along.
+     */
+    void sift_down(size_t i)
+      {
+        const size_t n = keys_.size();
+        for (;;)
+        {
+          size_t smallest = i;
+          const size_t left = 2 * i + 1, right = left + 1;
+          if (left < n && keys_[left] < keys_[smallest]) smallest = left;
+          if (right < n && keys_[right] < keys_[smallest]) smallest = right;
+          if (smallest == i) return;
+          std::swap(keys_[i], keys_[smallest]);
+          std::swap(elements_[i], elements_[smallest]);
+          i = smallest;
+        }
+      }
+
+  private:
+    WeightAccessor wac_;
+    size_t sampleSize_;
+
+    boost::rand48 rng_;
+    // Min-heap on the logarithm of the keys; elements_[i] has key
+    // keys_[i].
+    std::vector<ElementType> elements_;
+    std::vector<WeightType> keys_;
+    // Weight to skip before the next replacement.
+    WeightType skip_;
+  };
+
+}
+
+#endif // include guard
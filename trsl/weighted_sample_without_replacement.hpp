@@ -0,0 +1,182 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+/** @file */
+
+#ifndef TRSL_WEIGHTED_SAMPLE_WITHOUT_REPLACEMENT_HPP
+#define TRSL_WEIGHTED_SAMPLE_WITHOUT_REPLACEMENT_HPP
+
+#include <trsl/reorder_iterator.hpp>
+#include <trsl/common.hpp>
+#include <trsl/error_handling.hpp>
+
+#include <cmath>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <boost/cstdint.hpp>
+#include <boost/random/linear_congruential.hpp>
+
+namespace trsl
+{
+
+  namespace detail
+  {
+
+    // Number of consecutive keys drawn from the same random
+    // generator. The block size is fixed, so that keys do not depend
+    // on the number of threads.
+    static const size_t sampling_key_block_size = 4096;
+
+    template<typename WeightType>
+    struct sampling_key
+    {
+      WeightType key;
+      size_t index;
+
+      // Larger keys first; ties (null weights) by index, so that the
+      // sample does not depend on the implementation of nth_element.
+      bool operator<(const sampling_key& k) const
+        {
+          return key > k.key || (key == k.key && index < k.index);
+        }
+    };
+
+  }
+
+  /**
+   * @brief Constructs a reorder_iterator that will iterate through a
+   * weighted sample without replacement of size @p sampleSize of
+   * the population referenced by @p first and @p last.
+   *
+   * The sample contains @p sampleSize distinct elements. It is
+   * distributed as if elements were drawn one after the other, each
+   * one with a probability proportional to its weight among the
+   * elements not drawn yet; the reorder_iterator goes through the
+   * sample in that order. Elements of null weight are only picked
+   * once all elements of positive weight are, in the order of the
+   * population.
+   *
+   * Each element gets a random key <tt>log(u)/w</tt>, where @p u is
+   * uniform in <tt>]0,1[</tt> and @p w is the weight of the element,
+   * and the sample is made of the elements of largest keys [1]. (This
+   * is equivalent to perturbing <tt>log(w)</tt> with Gumbel noise and
+   * keeping the largest values.)  Keys are drawn in parallel by OpenMP
+   * threads when OpenMP is available, then the largest keys are
+   * selected with <tt>std::nth_element</tt> and sorted. The cost is
+   * <em>O(n + sampleSize log(sampleSize))</em> for a population of
+   * @p n elements, and <em>O(n)</em> memory.
+   *
+   * Keys are drawn from small pseudo-random generators (<a
+   * href="http://www.boost.org/libs/random/index.html"
+   * >boost::rand48</a>), one for each block of consecutive elements,
+   * seeded from @p seed and the block number: the sample depends on
+   * @p seed, but not on the number of threads. The weight accessor
+   * is called concurrently from several threads. Keys are computed
+   * in <tt>double</tt> precision.
+   *
+   * @p ElementIterator should model <em>Random Access Iterator</em>.
+   *
+   * @param sampleSize Number of elements in the sample, within
+   * <tt>[0, n]</tt>. If it is larger than the population, a
+   * bad_parameter_value is thrown.
+   *
+   * @param seed Seed for the random generators.
+   *
+   * @param wac Weight accessor, see @ref accessor. Note that a bare
+   * method pointer is not an accessor; wrap it in a
+   * trsl::mp_weight_accessor.
+   *
+   * <b>References:</b>
+   *
+   * - [1] P. S. Efraimidis and P. G. Spirakis. Weighted random
+   * sampling with a reservoir. Information Processing Letters,
+   * 97(5):181-185, 2006.
+   */
+  template<class ElementIterator, class WeightAccessor>
+  reorder_iterator<ElementIterator>
+  weighted_sample_without_replacement(ElementIterator first,
+                                      ElementIterator last,
+                                      size_t sampleSize,
+                                      boost::uint32_t seed,
+                                      WeightAccessor wac)
+  {
+    ptrdiff_t size = std::distance(first, last);
+    if (size < 0)
+      throw bad_parameter_value(
+        "weighted_sample_without_replacement: "
+        "bad input range.");
+    if (sampleSize > size_t(size))
+      throw bad_parameter_value(
+        "weighted_sample_without_replacement: "
+        "parameter sampleSize out of range.");
+
+    typedef double WeightType;
+    typedef detail::sampling_key<WeightType> key_t;
+    typedef
+      typename reorder_iterator<ElementIterator>::index_container
+      index_container;
+    typedef
+      typename reorder_iterator<ElementIterator>::index_container_ptr
+      index_container_ptr;
+
+    const size_t n = size;
+    const size_t blockSize = detail::sampling_key_block_size;
+    const long nBlocks = long((n + blockSize - 1) / blockSize);
+    std::vector<key_t> keys(n);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (nBlocks > 1)
+#endif
+    for (long b = 0; b < nBlocks; ++b)
+    {
+      boost::rand48 rng(detail::stream_seed(seed, boost::uint32_t(b)));
+      const size_t end = std::min(n, (size_t(b) + 1) * blockSize);
+      for (size_t i = size_t(b) * blockSize; i < end; ++i)
+      {
+        WeightType u;
+        do u = rand_gen::uniform_01<WeightType>(rng);
+        while (u == 0);
+        const WeightType w = wac(first[i]);
+        keys[i].key = (w > 0) ?
+          std::log(u) / w :
+          -std::numeric_limits<WeightType>::infinity();
+        keys[i].index = i;
+      }
+    }
+
+    if (sampleSize < n)
+      std::nth_element(keys.begin(), keys.begin() + sampleSize, keys.end());
+    std::sort(keys.begin(), keys.begin() + sampleSize);
+
+    index_container_ptr index_collection(new index_container(sampleSize));
+    for (size_t k = 0; k < sampleSize; ++k)
+      (*index_collection)[k] = keys[k].index;
+
+    return reorder_iterator<ElementIterator>(first, index_collection);
+  }
+
+  /**
+   * @brief Constructs a reorder_iterator that will iterate through a
+   * weighted sample without replacement of the population referenced
+   * by @p first and @p last, with system-provided seed.
+   *
+   * Identical to the function above, except that the seed is
+   * generated by trsl::rand_gen::uniform_int. See @ref random.
+   */
+  template<class ElementIterator, class WeightAccessor>
+  reorder_iterator<ElementIterator>
+  weighted_sample_without_replacement(ElementIterator first,
+                                      ElementIterator last,
+                                      size_t sampleSize,
+                                      WeightAccessor wac)
+  {
+    return weighted_sample_without_replacement(
+      first, last, sampleSize,
+      boost::uint32_t(rand_gen::uniform_int(RAND_MAX)), wac);
+  }
+
+} // namespace trsl
+
+#endif // include guard
@@ -0,0 +1,220 @@
+// (C) Copyright Renaud Detry   2007-2011.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+/** @file */
+
+#ifndef TRSL_XOSHIRO256_HPP
+#define TRSL_XOSHIRO256_HPP
+
+#include <trsl/common.hpp>
+
+#include <cmath>
+#include <limits>
+#include <boost/cstdint.hpp>
+#include <boost/config.hpp>
+
+namespace trsl {
+
+  /**
+   * @brief Fast 64-bit random number engine (xoshiro256** [1]).
+   *
+   * rand_gen::uniform_int and rand_gen::uniform_01 call
+   * <tt>std::rand</tt>, which has a global state: threads that use it
+   * concurrently contend for it, and its sequence depends on thread
+   * scheduling. xoshiro256 is a small engine (32 bytes of state) that
+   * each thread can own. It models <em>Uniform Random Number
+   * Generator</em>, and can be passed to the TRSL functions that
+   * accept one, e.g. random_permutation_iterator or
+   * is_picked_systematic (see @ref random).
+   *
+   * fill() and fill_01() write a whole buffer of random numbers in a
+   * loop that keeps the state in registers, which is faster than one
+   * call per number in hot loops. jump() advances the engine by
+   * 2^128 steps, which provides non-overlapping streams for parallel
+   * threads from a single seed.
+   *
+   * <b>References:</b>
+   *
+   * - [1] D. Blackman and S. Vigna. Scrambled linear pseudorandom
+   * number generators. ACM Transactions on Mathematical Software,
+   * 47(4):1-32, 2021.
+   */
+  class xoshiro256
+  {
+  public:
+    typedef boost::uint64_t result_type;
+    BOOST_STATIC_CONSTANT(bool, has_fixed_range = false);
+
+    /**
+     * @brief Constructs an engine seeded with @p seed.
+     */
+    explicit xoshiro256(boost::uint64_t seed = 0x853c49e6748fea9bULL)
+      {
+        this->seed(seed);
+      }
+
+    /**
+     * @brief Reseeds the engine. The state is expanded from @p seed
+     * with SplitMix64, as recommended in [1].
+     */
+    void seed(boost::uint64_t seed)
+      {
+        for (int i = 0; i < 4; ++i)
+        {
+          seed += 0x9e3779b97f4a7c15ULL;
+          boost::uint64_t z = seed;
+          z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+          z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+          s_[i] = z ^ (z >> 31);
+        }
+      }
+
+    result_type (min)() const { return 0; }
+    result_type (max)() const { return ~result_type(0); }
+
+    /**
+     * @brief Returns a random integer in <tt>[0, 2^64[</tt>.
+     */
+    result_type operator()()
+      {
+        return next(s_[0], s_[1], s_[2], s_[3]);
+      }
+
+    /**
+     * @brief Writes random integers in <tt>[0, 2^64[</tt> to
+     * [@p first, @p last).
+     */
+    void fill(result_type* first, result_type* last)
+      {
+        boost::uint64_t s0 = s_[0], s1 = s_[1], s2 = s_[2], s3 = s_[3];
+        for (; first != last; ++first)
+          *first = next(s0, s1, s2, s3);
+        s_[0] = s0; s_[1] = s1; s_[2] = s2; s_[3] = s3;
+      }
+
+    /**
+     * @brief Writes random reals in <tt>[0,1[</tt> to [@p first, @p
+     * last).
+     *
+     * Each real is built from the high bits of one integer, as many as
+     * the mantissa of @p Real holds.
+     */
+    template<typename Real>
+    void fill_01(Real* first, Real* last)
+      {
+        boost::uint64_t s0 = s_[0], s1 = s_[1], s2 = s_[2], s3 = s_[3];
+        for (; first != last; ++first)
+          *first = to_01<Real>(next(s0, s1, s2, s3));
+        s_[0] = s0; s_[1] = s1; s_[2] = s2; s_[3] = s3;
+      }
+
+    /**
+     * @brief Advances the engine by 2^128 steps.
+     *
+     * Calling jump() @p k times on copies of an engine provides @p k
+     * non-overlapping sequences of 2^128 numbers.
+     */
+    void jump()
+      {
+        static const boost::uint64_t JUMP[] = {
+          0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+          0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+        boost::uint64_t t0 = 0, t1 = 0, t2 = 0, t3 = 0;
+        for (int i = 0; i < 4; ++i)
+          for (int b = 0; b < 64; ++b)
+          {
+            if (JUMP[i] & (boost::uint64_t(1) << b))
+            {
+              t0 ^= s_[0]; t1 ^= s_[1]; t2 ^= s_[2]; t3 ^= s_[3];
+            }
+            (*this)();
+          }
+        s_[0] = t0; s_[1] = t1; s_[2] = t2; s_[3] = t3;
+      }
+
+    /**
+     * @brief Converts a random integer to a real in <tt>[0,1[</tt>.
+     * Used internally.
+     */
+    template<typename Real>
+    static Real to_01(boost::uint64_t x)
+      {
+        return detail::bits_to_01<Real>(x, 64);
+      }
+
+    bool operator==(xoshiro256 const& g) const
+      {
+        return s_[0] == g.s_[0] && s_[1] == g.s_[1] &&
+          s_[2] == g.s_[2] && s_[3] == g.s_[3];
+      }
+
+    bool operator!=(xoshiro256 const& g) const { return !(*this == g); }
+
+  private:
+    static boost::uint64_t rotl(boost::uint64_t x, int k)
+      {
+        return (x << k) | (x >> (64 - k));
+      }
+
+    static boost::uint64_t next(boost::uint64_t& s0, boost::uint64_t& s1,
+                                boost::uint64_t& s2, boost::uint64_t& s3)
+      {
+        const boost::uint64_t result = rotl(s1 * 5, 7) * 9;
+        const boost::uint64_t t = s1 << 17;
+        s2 ^= s0;
+        s3 ^= s1;
+        s1 ^= s2;
+        s0 ^= s3;
+        s2 ^= t;
+        s3 = rotl(s3, 45);
+        return result;
+      }
+
+    boost::uint64_t s_[4];
+  };
+
+  namespace rand_gen {
+
+    /**
+     * @brief Functor called as <tt>rng(n)</tt>, which returns an
+     * integer in <tt>[0,n[</tt> drawn from a xoshiro256 engine that it
+     * owns.
+     *
+     * Unlike uniform_int_adaptor, which refers to a generator owned
+     * by the caller, copies of this functor carry their own engine.
+     * It is used by iterators that draw random numbers after their
+     * construction, e.g. lazy_reorder_iterator.
+     */
+    class xoshiro256_uniform_int
+    {
+    public:
+      explicit xoshiro256_uniform_int(boost::uint64_t seed) : g_(seed) {}
+
+      /**
+       * @brief Constructs an engine seeded with 64 bits drawn from
+       * @p g, which should model <em>Uniform Random Number
+       * Generator</em>.
+       */
+      template<class UniformRandomNumberGenerator>
+      static xoshiro256_uniform_int from(UniformRandomNumberGenerator& g)
+        {
+          uniform_int_adaptor<UniformRandomNumberGenerator> rng(g);
+          return xoshiro256_uniform_int(detail::random_uint64(rng));
+        }
+
+      std::ptrdiff_t operator()(std::ptrdiff_t n)
+        {
+          return uniform_int_adaptor<xoshiro256>(g_)(n);
+        }
+
+    private:
+      xoshiro256 g_;
+    };
+
+  }
+
+}
+
+#endif // include guard